@@ -6,10 +6,23 @@
 #include "analog_sampler.h"
 #include "avr_timer1_pwm.h"
 #include "digital_input_monitor.h"
+#include "duty_ramp.h"
 #include "encoder_generator.h"
+#include "event_queue.h"
+#include "frame_codec.h"
+#include "idle_manager.h"
+#include "load_governor.h"
+#include "tx_buffer.h"
 
 class FirmwareCli {
  public:
+  /// Record types of the binary frames sent by `analog?`, `digital?`, `encoder?` and `all?`
+  /// after `format bin`.
+  static constexpr uint8_t RECORD_ANALOG = 1;
+  static constexpr uint8_t RECORD_DIGITAL = 2;
+  static constexpr uint8_t RECORD_ENCODER = 3;
+  static constexpr uint8_t RECORD_ALL = 4;
+
   struct Config {
     const uint8_t* analogPins = nullptr;
     uint8_t analogCount = 0;
@@ -31,30 +44,110 @@ class FirmwareCli {
               Timer1PWM& pwm, const uint8_t* analogPins, uint8_t analogCount,
               const uint8_t* digitalPins, uint8_t digitalCount);
 
+  /// Reads and runs commands, then hands the UART as much queued output as it accepts without
+  /// blocking. A command is only read once the previous reply is complete and the next one
+  /// fits in the output buffer; replies longer than the buffer (help, and text records with
+  /// per-pin digital fields) are queued in pieces over later passes as the UART drains.
   void processSerial();
+  /// Pushes one record for each subscribed source that has published new data, no more often
+  /// than its subscription interval. Call from `loop()` after the sources' loop-side updates.
+  void serviceStreams();
+
+  /// Enables the `load?` command; pass nullptr to disable it again.
+  void setLoadGovernor(const LoadGovernor* governor);
+  /// Enables the `idle?` command; pass nullptr to disable it again.
+  void setIdleManager(const IdleManager* idleManager);
+  /// Enables the `pwm-ramp` command and routes `pwm-duty` through @p ramp; pass nullptr to
+  /// drive Timer1PWM directly again.
+  void setDutyRamp(DutyRamp* ramp);
+  /// Returns true when the output buffer has room for an unsolicited report or stream record,
+  /// no reply is still being queued in pieces, and no command input is waiting. Callers
+  /// holding queued events can leave them queued until it does.
+  bool hasRoomForReport() const;
+  /// Emits one unsolicited `{"event":"load",...}` line for the governor's latest transition.
+  void reportLoadTransition();
+  /// Emits one unsolicited event line for overrun and direction events; other codes are silent.
+  void reportTickEvent(const TickEvent& event);
+  /// Emits `{"event":"dropped","count":N}` with the cumulative dropped-event count.
+  void reportDroppedEvents(uint16_t droppedCount);
 
  private:
+  enum StreamSource : uint8_t { STREAM_ANALOG, STREAM_DIGITAL, STREAM_ENCODER, STREAM_COUNT };
+  // Reply whose remaining pieces are queued by continueReply().
+  enum PendingReply : uint8_t { PENDING_NONE, PENDING_HELP, PENDING_DIGITAL, PENDING_ALL };
+
+  struct Subscription {
+    bool enabled = false;
+    // Send the current value on the next pass even if it has not changed.
+    bool pending = false;
+    uint16_t intervalMs = 0;
+    unsigned long lastSentMs = 0;
+    // Analog round, digital frame sequence, or encoder position of the last record sent.
+    uint32_t lastSequence = 0;
+    uint32_t dropped = 0;
+  };
+
   void appendAnalogFields(bool& firstField);
-  void appendDigitalFields(bool& firstField, const DigitalInputMonitor::Frame& frame);
+  void appendDigitalHeader(bool& firstField);
+  void appendDigitalPin(uint8_t index);
+  uint8_t replyPinCount() const;
   void appendEncoderFields(bool& firstField);
+  void putAnalogRecord(FrameEncoder& frame);
+  void putDigitalRecord(FrameEncoder& frame);
+  void putEncoderRecord(FrameEncoder& frame);
+  void sendFrame(FrameEncoder& frame);
+  void respondFormat(char* const* tokens, uint8_t tokenCount);
+  uint32_t streamSequence(uint8_t source);
+  void pushStreamRecord(uint8_t source);
+  void respondStream(char* const* tokens, uint8_t tokenCount);
+  void respondStreamStatus();
   void respondAnalog();
   void respondDigital();
   void respondEncoder();
   void respondAll();
+  void respondLoad();
+  void respondIdle();
   void resetBoard();
+  void startReply(uint8_t pending);
+  void continueReply();
+  bool readyForCommand() const;
   void handleCommand(char* cmd);
+  void runCommand(uint8_t id, char* const* tokens, uint8_t tokenCount);
   void dispatchCommand();
 
   AnalogSampler& _analog;
   DigitalInputMonitor& _digitalMonitor;
   EncoderGenerator& _encoder;
   Timer1PWM& _pwm;
+  const LoadGovernor* _loadGovernor = nullptr;
+  const IdleManager* _idleManager = nullptr;
+  DutyRamp* _dutyRamp = nullptr;
   const uint8_t* _analogPins;
   uint8_t _analogCount;
   const uint8_t* _digitalPins;
   uint8_t _digitalCount;
+  bool _binaryOutput = false;
+  uint8_t _frameSequence = 0;
+  Subscription _streams[STREAM_COUNT];
+
+  // Output ring. Nothing is queued until it fits, so the ring's blocking overflow path is never
+  // taken: a command is read with kReplyReserve free (the longest one-piece reply is stream?,
+  // about 220 bytes), a report or stream record needs kRecordReserve (an analog record or a
+  // binary frame), and help and the per-pin digital fields follow in pieces of kPieceReserve.
+  static constexpr uint16_t kTxBufferSize = 256;
+  static constexpr uint16_t kReplyReserve = 224;
+  static constexpr uint16_t kRecordReserve = 128;
+  static constexpr uint16_t kPieceReserve = 64;
+  TxBuffer<kTxBufferSize> _tx;
+  uint8_t _pendingReply = PENDING_NONE;
+  // Help: bytes already queued. Digital: next pin of _replyFrame.
+  uint16_t _pendingOffset = 0;
+  // Digital frame a reply or record is rendered from, held until its last piece is queued.
+  DigitalInputMonitor::Frame _replyFrame;
 
   static constexpr size_t kCmdBufferSize = 64;
+  // Command name plus the most arguments any command reads (pwm-sweep).
+  static constexpr uint8_t kMaxTokens = 7;
   static constexpr unsigned long kCmdIdleTimeoutMs = 75;
   char _cmdBuffer[kCmdBufferSize] = {0};
   size_t _cmdLength = 0;
@@ -10,10 +10,10 @@
 namespace {
 
 template <typename T>
-void printError(T message) {
-  Serial.print(F("{\"error\":\""));
-  Serial.print(message);
-  Serial.println(F("\"}"));
+void printError(Print& out, T message) {
+  out.print(F("{\"error\":\""));
+  out.print(message);
+  out.println(F("\"}"));
 }
 
 bool tryParseIntInRange(const char* token, int minValue, int maxValue, int& out) {
@@ -29,6 +29,19 @@ bool tryParseIntInRange(const char* token, int minValue, int maxValue, int& out)
   return true;
 }
 
+bool tryParseLongInRange(const char* token, long minValue, long maxValue, long& out) {
+  char* endp = nullptr;
+  long value = strtol(token, &endp, 10);
+  if (endp == token || *endp != '\0') {
+    return false;
+  }
+  if (value < minValue || value > maxValue) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
 bool tryParseFixed3(const char* token, bool allowSign, int32_t& out) {
   bool negative = false;
   if (*token == '+' || *token == '-') {
@@ -89,82 +102,524 @@ bool tryParseSignedFixed3(const char* token, int32_t& out) {
   return tryParseFixed3(token, true, out);
 }
 
-void printThreeDigits(uint16_t value) {
+void printThreeDigits(Print& out, uint16_t value) {
   char buffer[4];
   buffer[0] = static_cast<char>('0' + ((value / 100U) % 10U));
   buffer[1] = static_cast<char>('0' + ((value / 10U) % 10U));
   buffer[2] = static_cast<char>('0' + (value % 10U));
   buffer[3] = '\0';
-  Serial.print(buffer);
+  out.print(buffer);
 }
 
-void printMillivoltsAsVolts(uint16_t millivolts) {
-  Serial.print(millivolts / 1000U);
-  Serial.print('.');
-  printThreeDigits(static_cast<uint16_t>(millivolts % 1000U));
+void printMillivoltsAsVolts(Print& out, uint16_t millivolts) {
+  out.print(millivolts / 1000U);
+  out.print('.');
+  printThreeDigits(out, static_cast<uint16_t>(millivolts % 1000U));
 }
 
-void printDeciScaled(uint32_t deciValue) {
-  Serial.print(deciValue / 10U);
-  Serial.print('.');
-  Serial.print(deciValue % 10U);
+void printMilliScaled(Print& out, uint32_t milliValue) {
+  out.print(milliValue / 1000U);
+  out.print('.');
+  printThreeDigits(out, static_cast<uint16_t>(milliValue % 1000U));
 }
 
-void printStatusOk() {
-  Serial.println(F("{\"status\":\"ok\"}"));
+void printDeciScaled(Print& out, uint32_t deciValue) {
+  out.print(deciValue / 10U);
+  out.print('.');
+  out.print(deciValue % 10U);
 }
 
-void printCommaIfNeeded(bool& firstField) {
-  if (!firstField) Serial.print(F(","));
-  firstField = false;
+void printStatusOk(Print& out) {
+  out.println(F("{\"status\":\"ok\"}"));
 }
 
-void printHelp() {
-  Serial.println(
-      F("{\"help\":\"analog? digital? encoder? all? reset(immediate) pwm-freq <hz> pwm-duty <ch> "
-        "<pct>\"}"));
+void printCommaIfNeeded(Print& out, bool& firstField) {
+  if (!firstField) out.print(F(","));
+  firstField = false;
 }
 
-bool handlePwmFreq(Timer1PWM& pwm, char* const* tokens, uint8_t tokenCount) {
+// Longer than the output buffer, so continueReply() queues it in pieces.
+const char kHelpText[] PROGMEM =
+    "{\"help\":\"analog? digital? encoder? all? load? idle? reset(immediate) pwm-freq <hz> "
+    "pwm-duty <ch> <pct> pwm-ramp <ch> <pct> <pct/s> pwm-wave <hz> [pct]|off "
+    "pwm-comp <hz> <dead-counts>|off pwm-square <hz>|off "
+    "pwm-sweep <start-hz> <stop-hz> <steps> <steps/s> [lin|log] [once|repeat]|off "
+    "pwm-step <steps> <start-hz> <max-hz> <steps/s2> [fwd|rev]|stop "
+    "encoder-rate <steps/s> encoder-move <position> <steps/s> <steps/s2>|stop "
+    "format text|bin stream <analog|digital|encoder> [min-ms]|off stream off stream?\"}";
+constexpr uint16_t kHelpLength = sizeof(kHelpText) - 1;
+constexpr uint16_t kHelpPiece = 32;
+
+bool handlePwmFreq(Print& out, Timer1PWM& pwm, char* const* tokens, uint8_t tokenCount) {
   if (tokenCount < 2) {
-    printError(F("missing frequency"));
+    printError(out, F("missing frequency"));
     return true;
   }
   uint32_t freqMilliHz = 0;
   if (!tryParsePositiveFixed3(tokens[1], freqMilliHz)) {
-    printError(F("invalid frequency"));
+    printError(out, F("invalid frequency"));
     return true;
   }
-  float freq = static_cast<float>(freqMilliHz) / 1000.0f;
-  if (pwm.begin(Timer1PWM::Config{freq})) {
-    printStatusOk();
+  Timer1PWM::Timing timing = Timer1PWM::timingForMilliHz(freqMilliHz);
+  // A running output is retuned on a period boundary instead of restarting Timer1. Where that
+  // is not possible (square wave, waveform playback, or a current or new period too short to
+  // stage) Timer1 restarts as PWM; only complementary mode refuses.
+  bool applied = false;
+  if (!pwm.isComplementary()) {
+    applied = pwm.getTiming().isValid() && pwm.stageTiming(timing);
+    if (!applied) applied = pwm.beginMilliHz(freqMilliHz);
+  }
+  if (applied) {
+    // Report what Timer1 actually produces so hosts can calibrate against it.
+    out.print(F("{\"status\":\"ok\",\"frequency\":"));
+    printMilliScaled(out, timing.frequencyMilliHz());
+    out.print(F(",\"resolutionBits\":"));
+    out.print(timing.resolutionBits());
+    out.println(F("}"));
   } else {
-    printError(F("unable to set frequency"));
+    printError(out, F("unable to set frequency"));
   }
   return true;
 }
 
-bool handlePwmDuty(Timer1PWM& pwm, char* const* tokens, uint8_t tokenCount) {
+// Converts a duty in thousandths of a percent to permille, clamped to 0..1000.
+uint16_t milliPercentToPermille(int32_t milliPercent) {
+  if (milliPercent < 0) return 0;
+  if (milliPercent > 100000L) return 1000;
+  return static_cast<uint16_t>((milliPercent + 50) / 100);
+}
+
+bool handlePwmDuty(Print& out, Timer1PWM& pwm, DutyRamp* ramp, char* const* tokens,
+                   uint8_t tokenCount) {
   if (tokenCount < 3) {
-    printError(F("missing duty parameters"));
+    printError(out, F("missing duty parameters"));
     return true;
   }
   int channel = 0;
   if (!tryParseIntInRange(tokens[1], 0, 1, channel)) {
-    printError(F("invalid channel"));
+    printError(out, F("invalid channel"));
     return true;
   }
   int32_t dutyMilliPercent = 0;
   if (!tryParseSignedFixed3(tokens[2], dutyMilliPercent)) {
-    printError(F("invalid duty"));
+    printError(out, F("invalid duty"));
+    return true;
+  }
+  if (ramp != nullptr) {
+    // Through the ramp, so a running ramp stops and the next one starts from this duty.
+    (void)ramp->setDuty(static_cast<uint8_t>(channel), milliPercentToPermille(dutyMilliPercent));
+  } else {
+    float duty = static_cast<float>(dutyMilliPercent) / 1000.0f;
+    pwm.setDuty(static_cast<uint8_t>(channel), duty);
+  }
+  printStatusOk(out);
+  return true;
+}
+
+bool handlePwmWave(Print& out, Timer1PWM& pwm, char* const* tokens, uint8_t tokenCount) {
+  if (tokenCount < 2) {
+    printError(out, F("missing frequency"));
+    return true;
+  }
+  if (strcmp_P(tokens[1], PSTR("off")) == 0) {
+    pwm.stopWaveform();
+    printStatusOk(out);
+    return true;
+  }
+  uint32_t freqMilliHz = 0;
+  if (!tryParsePositiveFixed3(tokens[1], freqMilliHz)) {
+    printError(out, F("invalid frequency"));
+    return true;
+  }
+  int32_t amplitudeMilliPercent = 100000L;
+  if (tokenCount >= 3 && (!tryParseSignedFixed3(tokens[2], amplitudeMilliPercent) ||
+                          amplitudeMilliPercent < 0 || amplitudeMilliPercent > 100000L)) {
+    printError(out, F("invalid amplitude"));
+    return true;
+  }
+  // Sine on OC1A with OC1B a quarter period behind, ready for an I/Q pair of RC filters.
+  WaveformSynth::Config config(WaveformSynth::sineTable(), WaveformSynth::SINE_TABLE_BITS,
+                               freqMilliHz,
+                               static_cast<uint16_t>((amplitudeMilliPercent + 50) / 100),
+                               WaveformSynth::PHASE_QUARTER_TURN_LAG);
+  if (!pwm.startWaveform(config)) {
+    printError(out, F("unable to start waveform"));
+    return true;
+  }
+  out.print(F("{\"status\":\"ok\",\"frequency\":"));
+  printMilliScaled(out, pwm.getWaveformFrequencyMilliHz());
+  out.println(F("}"));
+  return true;
+}
+
+bool handlePwmComplementary(Print& out, Timer1PWM& pwm, char* const* tokens, uint8_t tokenCount) {
+  if (tokenCount >= 2 && strcmp_P(tokens[1], PSTR("off")) == 0) {
+    pwm.stop();
+    printStatusOk(out);
+    return true;
+  }
+  if (tokenCount < 3) {
+    printError(out, F("missing complementary parameters"));
+    return true;
+  }
+  uint32_t freqMilliHz = 0;
+  if (!tryParsePositiveFixed3(tokens[1], freqMilliHz)) {
+    printError(out, F("invalid frequency"));
+    return true;
+  }
+  int deadTimeCounts = 0;
+  if (!tryParseIntInRange(tokens[2], 0, 32767, deadTimeCounts)) {
+    printError(out, F("invalid dead time"));
+    return true;
+  }
+  Timer1PWM::Timing timing = Timer1PWM::complementaryTimingForMilliHz(freqMilliHz);
+  if (!pwm.beginComplementary(timing, static_cast<uint16_t>(deadTimeCounts))) {
+    printError(out, F("unable to set complementary pwm"));
+    return true;
+  }
+  uint64_t deadTimeNs = static_cast<uint64_t>(deadTimeCounts) *
+                        Timer1PWM::prescalerAt(timing.clockSelect - 1U) * 1000000000ULL /
+                        Timer1PWM::CLOCK_HZ;
+  out.print(F("{\"status\":\"ok\",\"frequency\":"));
+  printMilliScaled(out, Timer1PWM::complementaryFrequencyMilliHz(timing));
+  out.print(F(",\"deadTimeNs\":"));
+  out.print(static_cast<uint32_t>(deadTimeNs));
+  out.println(F("}"));
+  return true;
+}
+
+void printSquareWaveStatus(Print& out, const Timer1PWM& pwm) {
+  // The frequency Timer1 actually toggles at, so hosts can compare it with their measurement.
+  out.print(F("{\"status\":\"ok\",\"frequency\":"));
+  printMilliScaled(out, pwm.getSquareWaveFrequencyMilliHz());
+  out.println(F("}"));
+}
+
+bool handlePwmSquare(Print& out, Timer1PWM& pwm, char* const* tokens, uint8_t tokenCount) {
+  if (tokenCount < 2) {
+    printError(out, F("missing frequency"));
+    return true;
+  }
+  if (strcmp_P(tokens[1], PSTR("off")) == 0) {
+    pwm.stop();
+    printStatusOk(out);
+    return true;
+  }
+  uint32_t freqMilliHz = 0;
+  if (!tryParsePositiveFixed3(tokens[1], freqMilliHz)) {
+    printError(out, F("invalid frequency"));
+    return true;
+  }
+  if (!pwm.beginSquareWave(Timer1PWM::squareWaveTimingForMilliHz(freqMilliHz))) {
+    printError(out, F("unable to set square wave"));
+    return true;
+  }
+  printSquareWaveStatus(out, pwm);
+  return true;
+}
+
+bool handlePwmSweep(Print& out, Timer1PWM& pwm, char* const* tokens, uint8_t tokenCount) {
+  if (tokenCount >= 2 && strcmp_P(tokens[1], PSTR("off")) == 0) {
+    // Holds the step being played rather than stopping the output.
+    pwm.stopSweep();
+    printSquareWaveStatus(out, pwm);
+    return true;
+  }
+  if (tokenCount < 5) {
+    printError(out, F("missing sweep parameters"));
+    return true;
+  }
+  uint32_t startMilliHz = 0;
+  uint32_t stopMilliHz = 0;
+  if (!tryParsePositiveFixed3(tokens[1], startMilliHz) ||
+      !tryParsePositiveFixed3(tokens[2], stopMilliHz)) {
+    printError(out, F("invalid frequency"));
+    return true;
+  }
+  int steps = 0;
+  int stepHz = 0;
+  if (!tryParseIntInRange(tokens[3], 1, 32767, steps) ||
+      !tryParseIntInRange(tokens[4], 1, FrequencySweep::MAX_STEP_HZ, stepHz)) {
+    printError(out, F("invalid steps"));
+    return true;
+  }
+  FrequencySweep::Shape shape = FrequencySweep::LINEAR;
+  bool repeat = false;
+  for (uint8_t i = 5; i < tokenCount; ++i) {
+    if (strcmp_P(tokens[i], PSTR("log")) == 0) {
+      shape = FrequencySweep::LOGARITHMIC;
+    } else if (strcmp_P(tokens[i], PSTR("repeat")) == 0) {
+      repeat = true;
+    } else if (strcmp_P(tokens[i], PSTR("lin")) != 0 && strcmp_P(tokens[i], PSTR("once")) != 0) {
+      printError(out, F("invalid sweep option"));
+      return true;
+    }
+  }
+  FrequencySweep::Config config(startMilliHz, stopMilliHz, static_cast<uint16_t>(steps),
+                                static_cast<uint16_t>(stepHz), shape, repeat);
+  if (!pwm.startSweep(config)) {
+    printError(out, F("unable to start sweep"));
+    return true;
+  }
+  printSquareWaveStatus(out, pwm);
+  return true;
+}
+
+bool handlePwmStep(Print& out, Timer1PWM& pwm, char* const* tokens, uint8_t tokenCount) {
+  if (tokenCount == 2 && strcmp_P(tokens[1], PSTR("stop")) == 0) {
+    // Ends after at most one more pulse; the reply counts the pulses sent so far.
+    pwm.stopSteps();
+    out.print(F("{\"status\":\"ok\",\"done\":"));
+    out.print(pwm.getStepsDone());
+    out.println(F("}"));
+    return true;
+  }
+  if (tokenCount < 5) {
+    printError(out, F("missing step parameters"));
+    return true;
+  }
+  long steps = 0;
+  if (!tryParseLongInRange(tokens[1], 1, INT32_MAX, steps)) {
+    printError(out, F("invalid steps"));
+    return true;
+  }
+  long startHz = 0;
+  long maxHz = 0;
+  if (!tryParseLongInRange(tokens[2], 1, 65535, startHz) ||
+      !tryParseLongInRange(tokens[3], 1, 65535, maxHz)) {
+    printError(out, F("invalid step rate"));
+    return true;
+  }
+  long accel = 0;
+  if (!tryParseLongInRange(tokens[4], 0, INT32_MAX, accel)) {
+    printError(out, F("invalid acceleration"));
+    return true;
+  }
+  bool forward = true;
+  if (tokenCount >= 6) {
+    if (strcmp_P(tokens[5], PSTR("rev")) == 0) {
+      forward = false;
+    } else if (strcmp_P(tokens[5], PSTR("fwd")) != 0) {
+      printError(out, F("invalid direction"));
+      return true;
+    }
+  }
+  StepRamp::Config config(static_cast<uint32_t>(steps), static_cast<uint16_t>(startHz),
+                          static_cast<uint16_t>(maxHz), static_cast<uint32_t>(accel));
+  if (!pwm.startSteps(config, forward)) {
+    printError(out, F("unable to start steps"));
+    return true;
+  }
+  printStatusOk(out);
+  return true;
+}
+
+bool handlePwmRamp(Print& out, DutyRamp* ramp, char* const* tokens, uint8_t tokenCount) {
+  if (ramp == nullptr) {
+    printError(out, F("duty ramp unavailable"));
+    return true;
+  }
+  if (tokenCount < 4) {
+    printError(out, F("missing ramp parameters"));
+    return true;
+  }
+  int channel = 0;
+  if (!tryParseIntInRange(tokens[1], 0, 1, channel)) {
+    printError(out, F("invalid channel"));
+    return true;
+  }
+  int32_t dutyMilliPercent = 0;
+  if (!tryParseSignedFixed3(tokens[2], dutyMilliPercent)) {
+    printError(out, F("invalid duty"));
+    return true;
+  }
+  uint32_t rateMilliPercent = 0;
+  if (!tryParsePositiveFixed3(tokens[3], rateMilliPercent) || rateMilliPercent < 50U ||
+      rateMilliPercent > 6553500UL) {
+    printError(out, F("invalid rate"));
+    return true;
+  }
+  uint16_t slewPermillePerSec = static_cast<uint16_t>((rateMilliPercent + 50U) / 100U);
+  (void)ramp->rampTo(static_cast<uint8_t>(channel), milliPercentToPermille(dutyMilliPercent),
+                     slewPermillePerSec);
+  printStatusOk(out);
+  return true;
+}
+
+bool handleEncoderRate(Print& out, EncoderGenerator& encoder, char* const* tokens,
+                       uint8_t tokenCount) {
+  if (tokenCount < 2) {
+    printError(out, F("missing rate"));
+    return true;
+  }
+  int32_t rateMilliHz = 0;
+  if (!tryParseSignedFixed3(tokens[1], rateMilliHz) || rateMilliHz < 0) {
+    printError(out, F("invalid rate"));
+    return true;
+  }
+  if (!encoder.setStepRateMilliHz(static_cast<uint32_t>(rateMilliHz))) {
+    printError(out, F("unable to set rate"));
+    return true;
+  }
+  // The average rate the phase increment actually produces.
+  out.print(F("{\"status\":\"ok\",\"rate\":"));
+  printMilliScaled(out, encoder.getStepRateMilliHz());
+  out.println(F("}"));
+  return true;
+}
+
+bool handleEncoderMove(Print& out, EncoderGenerator& encoder, char* const* tokens,
+                       uint8_t tokenCount) {
+  if (tokenCount == 2 && strcmp_P(tokens[1], PSTR("stop")) == 0) {
+    encoder.stopMove();
+    out.print(F("{\"status\":\"ok\",\"target\":"));
+    out.print(encoder.getMoveTarget());
+    out.println(F("}"));
+    return true;
+  }
+  if (tokenCount < 4) {
+    printError(out, F("missing move parameters"));
+    return true;
+  }
+  long target = 0;
+  if (!tryParseLongInRange(tokens[1], INT32_MIN, INT32_MAX, target)) {
+    printError(out, F("invalid position"));
+    return true;
+  }
+  int velocity = 0;
+  if (!tryParseIntInRange(tokens[2], 1, 32767, velocity)) {
+    printError(out, F("invalid velocity"));
+    return true;
+  }
+  long accel = 0;
+  if (!tryParseLongInRange(tokens[3], 1, INT32_MAX, accel)) {
+    printError(out, F("invalid acceleration"));
+    return true;
+  }
+  if (!encoder.moveTo(static_cast<int32_t>(target), static_cast<uint16_t>(velocity),
+                      static_cast<uint32_t>(accel))) {
+    printError(out, F("unable to start move"));
     return true;
   }
-  float duty = static_cast<float>(dutyMilliPercent) / 1000.0f;
-  pwm.setDuty(static_cast<uint8_t>(channel), duty);
-  printStatusOk();
+  printStatusOk(out);
   return true;
 }
 
+enum CommandId : uint8_t {
+  CMD_ANALOG,
+  CMD_DIGITAL,
+  CMD_ENCODER,
+  CMD_ALL,
+  CMD_LOAD,
+  CMD_IDLE,
+  CMD_RESET,
+  CMD_PWM_FREQ,
+  CMD_PWM_DUTY,
+  CMD_PWM_WAVE,
+  CMD_PWM_COMP,
+  CMD_PWM_SQUARE,
+  CMD_PWM_SWEEP,
+  CMD_PWM_STEP,
+  CMD_PWM_RAMP,
+  CMD_ENCODER_RATE,
+  CMD_ENCODER_MOVE,
+  CMD_FORMAT,
+  CMD_STREAM,
+  CMD_STREAM_STATUS,
+  CMD_HELP,
+};
+
+constexpr uint8_t kCommandHashFactor = 31;
+
+// Same fold as the one handleCommand() applies while scanning a lowercased name.
+constexpr uint8_t commandHash(const char* name, uint8_t hash = 0) {
+  return *name == '\0' ? hash
+                       : commandHash(name + 1, static_cast<uint8_t>(hash * kCommandHashFactor +
+                                                                    static_cast<uint8_t>(*name)));
+}
+
+struct CommandEntry {
+  char name[13];
+  // Rows are ordered by hash, so a lookup binary-searches this byte and compares names only
+  // within the (usually single-row) run that matches.
+  uint8_t hash;
+  // Argument tokens the command reads; anything after them is not split and is ignored.
+  uint8_t maxArgs;
+  uint8_t id;
+};
+
+#define CLI_COMMAND(name, maxArgs, id) {name, commandHash(name), maxArgs, id}
+
+// Names and limits stay in flash. A new command is one row here, placed by its hash (the
+// static_assert below rejects a misplaced row), and one case in runCommand().
+constexpr CommandEntry kCommands[] PROGMEM = {
+    CLI_COMMAND("load?", 0, CMD_LOAD),
+    CLI_COMMAND("pwm-wave", 2, CMD_PWM_WAVE),
+    CLI_COMMAND("digital?", 0, CMD_DIGITAL),
+    CLI_COMMAND("pwm-comp", 2, CMD_PWM_COMP),
+    CLI_COMMAND("pwm-ramp", 3, CMD_PWM_RAMP),
+    CLI_COMMAND("help", 0, CMD_HELP),
+    CLI_COMMAND("analog?", 0, CMD_ANALOG),
+    CLI_COMMAND("reset", 0, CMD_RESET),
+    CLI_COMMAND("stream", 2, CMD_STREAM),
+    CLI_COMMAND("pwm-square", 1, CMD_PWM_SQUARE),
+    CLI_COMMAND("pwm-freq", 1, CMD_PWM_FREQ),
+    CLI_COMMAND("encoder?", 0, CMD_ENCODER),
+    CLI_COMMAND("pwm-sweep", 6, CMD_PWM_SWEEP),
+    CLI_COMMAND("all?", 0, CMD_ALL),
+    CLI_COMMAND("stream?", 0, CMD_STREAM_STATUS),
+    CLI_COMMAND("encoder-move", 3, CMD_ENCODER_MOVE),
+    CLI_COMMAND("idle?", 0, CMD_IDLE),
+    CLI_COMMAND("encoder-rate", 1, CMD_ENCODER_RATE),
+    CLI_COMMAND("pwm-step", 5, CMD_PWM_STEP),
+    CLI_COMMAND("format", 1, CMD_FORMAT),
+    CLI_COMMAND("pwm-duty", 2, CMD_PWM_DUTY),
+};
+
+#undef CLI_COMMAND
+
+constexpr uint8_t kCommandCount = sizeof(kCommands) / sizeof(kCommands[0]);
+
+constexpr bool commandsSortedFrom(uint8_t index) {
+  return index >= kCommandCount ||
+         (kCommands[index - 1].hash <= kCommands[index].hash && commandsSortedFrom(index + 1));
+}
+static_assert(commandsSortedFrom(1), "kCommands rows must be in ascending hash order");
+
+// O(log n) in the table size: about five flash byte reads for the current table, one more
+// each time it doubles.
+const CommandEntry* findCommand(const char* name, uint8_t hash) {
+  uint8_t low = 0;
+  uint8_t high = kCommandCount;
+  while (low < high) {
+    uint8_t mid = static_cast<uint8_t>((low + high) / 2U);
+    if (pgm_read_byte(&kCommands[mid].hash) < hash) {
+      low = static_cast<uint8_t>(mid + 1U);
+    } else {
+      high = mid;
+    }
+  }
+  for (; low < kCommandCount && pgm_read_byte(&kCommands[low].hash) == hash; ++low) {
+    if (strcmp_P(name, kCommands[low].name) == 0) return &kCommands[low];
+  }
+  return nullptr;
+}
+
+bool isTokenSeparator(char c) {
+  return c == ' ' || c == '\t';
+}
+
+// Terminates the token at cursor in place and returns it, leaving cursor past it; returns
+// nullptr at the end of the line.
+char* nextToken(char*& cursor) {
+  while (isTokenSeparator(*cursor)) ++cursor;
+  if (*cursor == '\0') return nullptr;
+  char* token = cursor;
+  while (*cursor != '\0' && !isTokenSeparator(*cursor)) ++cursor;
+  if (*cursor != '\0') *cursor++ = '\0';
+  return token;
+}
+
 }  // namespace
 
 FirmwareCli::FirmwareCli(AnalogSampler& analog, DigitalInputMonitor& digitalMonitor,
@@ -182,157 +637,496 @@ FirmwareCli::FirmwareCli(AnalogSampler& analog, DigitalInputMonitor& digitalMoni
       _analogPins(analogPins),
       _analogCount(analogCount),
       _digitalPins(digitalPins),
-      _digitalCount(digitalCount) {}
+      _digitalCount(digitalCount),
+      _tx(Serial) {}
 
 void FirmwareCli::appendAnalogFields(bool& firstField) {
   for (uint8_t i = 0; i < _analogCount; ++i) {
-    printCommaIfNeeded(firstField);
-    Serial.print(F("\"a"));
-    Serial.print(_analogPins[i]);
-    Serial.print(F("\":"));
-    printMillivoltsAsVolts(_analog.getMillivolts(i));
+    printCommaIfNeeded(_tx, firstField);
+    _tx.print(F("\"a"));
+    _tx.print(_analogPins[i]);
+    _tx.print(F("\":"));
+    printMillivoltsAsVolts(_tx, _analog.getMillivolts(i));
   }
 }
 
-void FirmwareCli::appendDigitalFields(bool& firstField, const DigitalInputMonitor::Frame& frame) {
-  uint8_t responsePinCount = _digitalCount;
-  if (responsePinCount > frame.pinCount) responsePinCount = frame.pinCount;
+uint8_t FirmwareCli::replyPinCount() const {
+  return _digitalCount < _replyFrame.pinCount ? _digitalCount : _replyFrame.pinCount;
+}
+
+void FirmwareCli::appendDigitalHeader(bool& firstField) {
+  const DigitalInputMonitor::Frame& frame = _replyFrame;
+  printCommaIfNeeded(_tx, firstField);
+  _tx.print(F("\"frameSeq\":"));
+  _tx.print(frame.frameSequence);
+
+  printCommaIfNeeded(_tx, firstField);
+  _tx.print(F("\"stale\":"));
+  _tx.print(frame.stale ? F("true") : F("false"));
+
+  printCommaIfNeeded(_tx, firstField);
+  _tx.print(F("\"overrunTicks\":"));
+  _tx.print(frame.overrunCount);
+}
+
+void FirmwareCli::appendDigitalPin(uint8_t index) {
+  _tx.print(F(",\"d"));
+  _tx.print(_digitalPins[index]);
+  _tx.print(F("\":{\"freq\":"));
+  printDeciScaled(_tx, (_replyFrame.frequencyMilliHz[index] + 50U) / 100U);
+  _tx.print(F(",\"duty\":"));
+  printDeciScaled(_tx, _replyFrame.dutyPermille[index]);
+  _tx.print(F("}"));
+}
 
-  printCommaIfNeeded(firstField);
-  Serial.print(F("\"frameSeq\":"));
-  Serial.print(frame.frameSequence);
+void FirmwareCli::appendEncoderFields(bool& firstField) {
+  printCommaIfNeeded(_tx, firstField);
+  _tx.print(F("\"encoder\":{\"direction\":\""));
+  _tx.print(_encoder.getDirection() ? F("UP") : F("DOWN"));
+  _tx.print(F("\",\"position\":"));
+  _tx.print(_encoder.getPosition());
+  _tx.print(F("}"));
+}
 
-  printCommaIfNeeded(firstField);
-  Serial.print(F("\"stale\":"));
-  Serial.print(frame.stale ? F("true") : F("false"));
+void FirmwareCli::putAnalogRecord(FrameEncoder& frame) {
+  frame.putU32(_analog.getRoundCount());
+  frame.putU8(_analogCount);
+  for (uint8_t i = 0; i < _analogCount; ++i) {
+    frame.putU16(_analog.getMillivolts(i));
+  }
+}
 
-  printCommaIfNeeded(firstField);
-  Serial.print(F("\"overrunTicks\":"));
-  Serial.print(frame.overrunCount);
+void FirmwareCli::putDigitalRecord(FrameEncoder& frame) {
+  const DigitalInputMonitor::Frame& digital = _replyFrame;
+  uint8_t responsePinCount = replyPinCount();
 
+  frame.putU8(responsePinCount);
+  frame.putU32(digital.frameSequence);
+  frame.putU8(digital.stale ? 1U : 0U);
+  frame.putU32(digital.overrunCount);
   for (uint8_t i = 0; i < responsePinCount; ++i) {
-    printCommaIfNeeded(firstField);
-    Serial.print(F("\"d"));
-    Serial.print(_digitalPins[i]);
-    Serial.print(F("\":{\"freq\":"));
-    printDeciScaled((frame.frequencyMilliHz[i] + 50U) / 100U);
-    Serial.print(F(",\"duty\":"));
-    printDeciScaled(frame.dutyPermille[i]);
-    Serial.print(F("}"));
+    frame.putU32(digital.frequencyMilliHz[i]);
+    frame.putU16(digital.dutyPermille[i]);
   }
 }
 
-void FirmwareCli::appendEncoderFields(bool& firstField) {
-  printCommaIfNeeded(firstField);
-  Serial.print(F("\"encoder\":{\"direction\":\""));
-  Serial.print(_encoder.getDirection() ? F("UP") : F("DOWN"));
-  Serial.print(F("\",\"position\":"));
-  Serial.print(_encoder.getPosition());
-  Serial.print(F("}"));
+void FirmwareCli::putEncoderRecord(FrameEncoder& frame) {
+  frame.putU8(_encoder.getDirection() ? 1U : 0U);
+  frame.putI32(_encoder.getPosition());
+}
+
+void FirmwareCli::sendFrame(FrameEncoder& frame) {
+  uint8_t encoded[FrameEncoder::MAX_ENCODED];
+  uint8_t length = frame.finish(encoded);
+  if (length == 0) {
+    printError(_tx, F("record too large"));
+    return;
+  }
+  _tx.write(encoded, length);
+  _frameSequence = static_cast<uint8_t>(_frameSequence + 1U);
+}
+
+void FirmwareCli::respondFormat(char* const* tokens, uint8_t tokenCount) {
+  if (tokenCount < 2) {
+    printError(_tx, F("missing format"));
+    return;
+  }
+  if (strcmp_P(tokens[1], PSTR("bin")) == 0) {
+    _binaryOutput = true;
+  } else if (strcmp_P(tokens[1], PSTR("text")) == 0) {
+    _binaryOutput = false;
+  } else {
+    printError(_tx, F("invalid format"));
+    return;
+  }
+  // Always a text line, so a host can switch formats without parsing frames.
+  _tx.print(F("{\"status\":\"ok\",\"format\":\""));
+  _tx.print(_binaryOutput ? F("bin") : F("text"));
+  _tx.println(F("\"}"));
+}
+
+uint32_t FirmwareCli::streamSequence(uint8_t source) {
+  if (source == STREAM_ANALOG) return _analog.getRoundCount();
+  if (source == STREAM_DIGITAL) return _digitalMonitor.getFrameSequence();
+  return static_cast<uint32_t>(_encoder.getPosition());
+}
+
+void FirmwareCli::pushStreamRecord(uint8_t source) {
+  if (source == STREAM_DIGITAL) _digitalMonitor.copyFrame(_replyFrame);
+  if (_binaryOutput) {
+    FrameEncoder frame;
+    if (source == STREAM_ANALOG) {
+      frame.begin(RECORD_ANALOG, _frameSequence);
+      putAnalogRecord(frame);
+    } else if (source == STREAM_DIGITAL) {
+      frame.begin(RECORD_DIGITAL, _frameSequence);
+      putDigitalRecord(frame);
+    } else {
+      frame.begin(RECORD_ENCODER, _frameSequence);
+      putEncoderRecord(frame);
+    }
+    sendFrame(frame);
+    return;
+  }
+
+  bool firstField = false;
+  if (source == STREAM_ANALOG) {
+    _tx.print(F("{\"stream\":\"analog\",\"round\":"));
+    _tx.print(_analog.getRoundCount());
+    appendAnalogFields(firstField);
+  } else if (source == STREAM_DIGITAL) {
+    _tx.print(F("{\"stream\":\"digital\""));
+    appendDigitalHeader(firstField);
+    startReply(PENDING_DIGITAL);
+    return;
+  } else {
+    _tx.print(F("{\"stream\":\"encoder\""));
+    appendEncoderFields(firstField);
+  }
+  _tx.println(F("}"));
+}
+
+void FirmwareCli::serviceStreams() {
+  unsigned long now = millis();
+  for (uint8_t source = 0; source < STREAM_COUNT; ++source) {
+    Subscription& stream = _streams[source];
+    if (!stream.enabled) continue;
+    uint32_t sequence = streamSequence(source);
+    if (sequence == stream.lastSequence && !stream.pending) continue;
+    if (now - stream.lastSentMs < stream.intervalMs) continue;
+    // With the link behind, data is skipped (and counted) rather than waited for.
+    if (!hasRoomForReport()) break;
+    // Rounds and frames published since the last record were never sent. The encoder
+    // position is a level, so only its latest value matters.
+    if (source != STREAM_ENCODER) stream.dropped += sequence - stream.lastSequence - 1U;
+    stream.lastSequence = sequence;
+    stream.lastSentMs = now;
+    stream.pending = false;
+    pushStreamRecord(source);
+  }
+  _tx.pump();
+}
+
+void FirmwareCli::respondStream(char* const* tokens, uint8_t tokenCount) {
+  if (tokenCount < 2) {
+    printError(_tx, F("missing stream source"));
+    return;
+  }
+  if (strcmp_P(tokens[1], PSTR("off")) == 0) {
+    for (uint8_t source = 0; source < STREAM_COUNT; ++source) _streams[source].enabled = false;
+    printStatusOk(_tx);
+    return;
+  }
+  uint8_t source = STREAM_COUNT;
+  if (strcmp_P(tokens[1], PSTR("analog")) == 0) {
+    source = STREAM_ANALOG;
+  } else if (strcmp_P(tokens[1], PSTR("digital")) == 0) {
+    source = STREAM_DIGITAL;
+  } else if (strcmp_P(tokens[1], PSTR("encoder")) == 0) {
+    source = STREAM_ENCODER;
+  } else {
+    printError(_tx, F("invalid stream source"));
+    return;
+  }
+  Subscription& stream = _streams[source];
+  if (tokenCount >= 3 && strcmp_P(tokens[2], PSTR("off")) == 0) {
+    stream.enabled = false;
+    printStatusOk(_tx);
+    return;
+  }
+  int intervalMs = 0;
+  if (tokenCount >= 3 && !tryParseIntInRange(tokens[2], 0, 32767, intervalMs)) {
+    printError(_tx, F("invalid interval"));
+    return;
+  }
+  // Only data published from now on is streamed, except the encoder, which starts with its
+  // current position.
+  stream.intervalMs = static_cast<uint16_t>(intervalMs);
+  stream.lastSentMs = millis() - stream.intervalMs;
+  stream.lastSequence = streamSequence(source);
+  stream.pending = (source == STREAM_ENCODER);
+  stream.dropped = 0;
+  stream.enabled = true;
+  printStatusOk(_tx);
+}
+
+void FirmwareCli::respondStreamStatus() {
+  _tx.print(F("{\"streams\":{"));
+  for (uint8_t source = 0; source < STREAM_COUNT; ++source) {
+    const Subscription& stream = _streams[source];
+    if (source == STREAM_ANALOG) {
+      _tx.print(F("\"analog\":{\"enabled\":"));
+    } else if (source == STREAM_DIGITAL) {
+      _tx.print(F(",\"digital\":{\"enabled\":"));
+    } else {
+      _tx.print(F(",\"encoder\":{\"enabled\":"));
+    }
+    _tx.print(stream.enabled ? F("true") : F("false"));
+    _tx.print(F(",\"intervalMs\":"));
+    _tx.print(stream.intervalMs);
+    _tx.print(F(",\"dropped\":"));
+    _tx.print(stream.dropped);
+    _tx.print(F("}"));
+  }
+  _tx.println(F("}}"));
 }
 
 void FirmwareCli::respondAnalog() {
+  if (_binaryOutput) {
+    FrameEncoder frame;
+    frame.begin(RECORD_ANALOG, _frameSequence);
+    putAnalogRecord(frame);
+    sendFrame(frame);
+    return;
+  }
   bool firstField = true;
-  Serial.print(F("{"));
+  _tx.print(F("{"));
   appendAnalogFields(firstField);
-  Serial.println(F("}"));
+  _tx.println(F("}"));
 }
 
 void FirmwareCli::respondDigital() {
-  DigitalInputMonitor::Frame frame;
-  _digitalMonitor.copyFrame(frame);
+  _digitalMonitor.copyFrame(_replyFrame);
+  if (_binaryOutput) {
+    FrameEncoder record;
+    record.begin(RECORD_DIGITAL, _frameSequence);
+    putDigitalRecord(record);
+    sendFrame(record);
+    return;
+  }
   bool firstField = true;
-  Serial.print(F("{"));
-  appendDigitalFields(firstField, frame);
-  Serial.println(F("}"));
+  _tx.print(F("{"));
+  appendDigitalHeader(firstField);
+  startReply(PENDING_DIGITAL);
 }
 
 void FirmwareCli::respondEncoder() {
+  if (_binaryOutput) {
+    FrameEncoder frame;
+    frame.begin(RECORD_ENCODER, _frameSequence);
+    putEncoderRecord(frame);
+    sendFrame(frame);
+    return;
+  }
   bool firstField = true;
-  Serial.print(F("{"));
+  _tx.print(F("{"));
   appendEncoderFields(firstField);
-  Serial.println(F("}"));
+  _tx.println(F("}"));
 }
 
 void FirmwareCli::respondAll() {
   bool firstField = true;
-  DigitalInputMonitor::Frame frame;
-  _digitalMonitor.copyFrame(frame);
+  _digitalMonitor.copyFrame(_replyFrame);
+  if (_binaryOutput) {
+    FrameEncoder record;
+    record.begin(RECORD_ALL, _frameSequence);
+    putAnalogRecord(record);
+    putDigitalRecord(record);
+    putEncoderRecord(record);
+    sendFrame(record);
+    return;
+  }
 
-  Serial.print(F("{"));
+  _tx.print(F("{"));
   appendAnalogFields(firstField);
-  appendDigitalFields(firstField, frame);
-  appendEncoderFields(firstField);
-  Serial.println(F("}"));
+  appendDigitalHeader(firstField);
+  // The encoder fields and closing brace follow the pins in continueReply().
+  startReply(PENDING_ALL);
 }
 
-void FirmwareCli::resetBoard() {
-  Serial.println(F("{\"status\":\"resetting\"}"));
-#if defined(__AVR__)
-  Serial.flush();
-  wdt_enable(WDTO_15MS);
-  while (true) {
-  }
-#endif
+bool FirmwareCli::hasRoomForReport() const {
+  // Unread input holds reports back so a busy stream cannot starve the command parser.
+  return _pendingReply == PENDING_NONE && Serial.available() == 0 &&
+         _tx.getFree() >= kRecordReserve;
 }
 
-void FirmwareCli::handleCommand(char* cmd) {
-  while (*cmd && isspace(static_cast<unsigned char>(*cmd))) ++cmd;
-  if (*cmd == '\0') return;
+void FirmwareCli::setLoadGovernor(const LoadGovernor* governor) {
+  _loadGovernor = governor;
+}
 
-  char* tokens[4];
-  uint8_t tokenCount = 0;
-  char* tok = strtok(cmd, " ");
-  while (tok && tokenCount < 4) {
-    tokens[tokenCount++] = tok;
-    tok = strtok(nullptr, " ");
-  }
+void FirmwareCli::setIdleManager(const IdleManager* idleManager) {
+  _idleManager = idleManager;
+}
 
-  for (char* p = tokens[0]; *p; ++p) {
-    *p = tolower(static_cast<unsigned char>(*p));
-  }
+void FirmwareCli::setDutyRamp(DutyRamp* ramp) {
+  _dutyRamp = ramp;
+}
 
-  if (strcmp(tokens[0], "analog?") == 0) {
-    respondAnalog();
-    return;
-  }
+void FirmwareCli::reportLoadTransition() {
+  if (_loadGovernor == nullptr) return;
+  _tx.print(F("{\"event\":\"load\",\"from\":"));
+  _tx.print(_loadGovernor->getPreviousLevel());
+  _tx.print(F(",\"level\":"));
+  _tx.print(_loadGovernor->getLevel());
+  _tx.print(F(",\"utilization\":"));
+  printDeciScaled(_tx, _loadGovernor->getUtilizationPermille());
+  _tx.println(F("}"));
+  _tx.pump();
+}
 
-  if (strcmp(tokens[0], "digital?") == 0) {
-    respondDigital();
+void FirmwareCli::reportTickEvent(const TickEvent& event) {
+  if (event.code == TICK_EVENT_WINDOW_OVERRUN) {
+    _tx.print(F("{\"event\":\"overrun\""));
+  } else if (event.code == TICK_EVENT_DIRECTION_CHANGED) {
+    _tx.print(F("{\"event\":\"direction\",\"direction\":\""));
+    _tx.print(event.value != 0 ? F("UP") : F("DOWN"));
+    _tx.print(F("\""));
+  } else {
     return;
   }
+  _tx.print(F(",\"source\":"));
+  _tx.print(event.source);
+  _tx.print(F(",\"tick\":"));
+  _tx.print(event.tick);
+  _tx.println(F("}"));
+  _tx.pump();
+}
 
-  if (strcmp(tokens[0], "encoder?") == 0) {
-    respondEncoder();
-    return;
-  }
+void FirmwareCli::reportDroppedEvents(uint16_t droppedCount) {
+  _tx.print(F("{\"event\":\"dropped\",\"count\":"));
+  _tx.print(droppedCount);
+  _tx.println(F("}"));
+  _tx.pump();
+}
 
-  if (strcmp(tokens[0], "all?") == 0) {
-    respondAll();
+void FirmwareCli::respondLoad() {
+  if (_loadGovernor == nullptr) {
+    printError(_tx, F("load governor unavailable"));
     return;
   }
+  _tx.print(F("{\"load\":{\"level\":"));
+  _tx.print(_loadGovernor->getLevel());
+  _tx.print(F(",\"utilization\":"));
+  printDeciScaled(_tx, _loadGovernor->getUtilizationPermille());
+  _tx.print(F(",\"transitions\":"));
+  _tx.print(_loadGovernor->getTransitionCount());
+  _tx.println(F("}}"));
+}
 
-  if (strcmp(tokens[0], "reset") == 0) {
-    resetBoard();
+void FirmwareCli::respondIdle() {
+  if (_idleManager == nullptr) {
+    printError(_tx, F("idle manager unavailable"));
     return;
   }
+  _tx.print(F("{\"idle\":{\"enabled\":"));
+  _tx.print(_idleManager->isSleepEnabled() ? F("true") : F("false"));
+  _tx.print(F(",\"percent\":"));
+  printDeciScaled(_tx, _idleManager->getIdlePermille());
+  _tx.print(F(",\"sleeps\":"));
+  _tx.print(_idleManager->getSleepCount());
+  _tx.println(F("}}"));
+}
 
-  if (strcmp(tokens[0], "pwm-freq") == 0) {
-    (void)handlePwmFreq(_pwm, tokens, tokenCount);
-    return;
+void FirmwareCli::resetBoard() {
+  _tx.println(F("{\"status\":\"resetting\"}"));
+#if defined(__AVR__)
+  _tx.drain();
+  Serial.flush();
+  wdt_enable(WDTO_15MS);
+  while (true) {
   }
+#endif
+}
 
-  if (strcmp(tokens[0], "pwm-duty") == 0) {
-    (void)handlePwmDuty(_pwm, tokens, tokenCount);
-    return;
+void FirmwareCli::handleCommand(char* cmd) {
+  // One pass over the line: the name is lowercased and hashed while it is scanned, then only
+  // the argument tokens the command reads are split off. The rest of the line is ignored.
+  while (isTokenSeparator(*cmd)) ++cmd;
+  if (*cmd == '\0') return;
+
+  char* tokens[kMaxTokens];
+  tokens[0] = cmd;
+  uint8_t hash = 0;
+  for (; *cmd != '\0' && !isTokenSeparator(*cmd); ++cmd) {
+    *cmd = static_cast<char>(tolower(static_cast<unsigned char>(*cmd)));
+    hash = static_cast<uint8_t>(hash * kCommandHashFactor + static_cast<uint8_t>(*cmd));
   }
+  if (*cmd != '\0') *cmd++ = '\0';
 
-  if (strcmp(tokens[0], "help") == 0) {
-    printHelp();
+  const CommandEntry* entry = findCommand(tokens[0], hash);
+  if (entry == nullptr) {
+    printError(_tx, F("unknown command"));
     return;
   }
+  uint8_t maxArgs = pgm_read_byte(&entry->maxArgs);
+  uint8_t tokenCount = 1;
+  while (tokenCount <= maxArgs && tokenCount < kMaxTokens) {
+    char* token = nextToken(cmd);
+    if (token == nullptr) break;
+    tokens[tokenCount++] = token;
+  }
+  runCommand(pgm_read_byte(&entry->id), tokens, tokenCount);
+}
 
-  printError(F("unknown command"));
+void FirmwareCli::runCommand(uint8_t id, char* const* tokens, uint8_t tokenCount) {
+  switch (id) {
+    case CMD_ANALOG:
+      respondAnalog();
+      break;
+    case CMD_DIGITAL:
+      respondDigital();
+      break;
+    case CMD_ENCODER:
+      respondEncoder();
+      break;
+    case CMD_ALL:
+      respondAll();
+      break;
+    case CMD_LOAD:
+      respondLoad();
+      break;
+    case CMD_IDLE:
+      respondIdle();
+      break;
+    case CMD_RESET:
+      resetBoard();
+      break;
+    case CMD_PWM_FREQ:
+      (void)handlePwmFreq(_tx, _pwm, tokens, tokenCount);
+      break;
+    case CMD_PWM_DUTY:
+      (void)handlePwmDuty(_tx, _pwm, _dutyRamp, tokens, tokenCount);
+      break;
+    case CMD_PWM_WAVE:
+      (void)handlePwmWave(_tx, _pwm, tokens, tokenCount);
+      break;
+    case CMD_PWM_COMP:
+      (void)handlePwmComplementary(_tx, _pwm, tokens, tokenCount);
+      break;
+    case CMD_PWM_SQUARE:
+      (void)handlePwmSquare(_tx, _pwm, tokens, tokenCount);
+      break;
+    case CMD_PWM_SWEEP:
+      (void)handlePwmSweep(_tx, _pwm, tokens, tokenCount);
+      break;
+    case CMD_PWM_STEP:
+      (void)handlePwmStep(_tx, _pwm, tokens, tokenCount);
+      break;
+    case CMD_PWM_RAMP:
+      (void)handlePwmRamp(_tx, _dutyRamp, tokens, tokenCount);
+      break;
+    case CMD_ENCODER_RATE:
+      (void)handleEncoderRate(_tx, _encoder, tokens, tokenCount);
+      break;
+    case CMD_ENCODER_MOVE:
+      (void)handleEncoderMove(_tx, _encoder, tokens, tokenCount);
+      break;
+    case CMD_FORMAT:
+      respondFormat(tokens, tokenCount);
+      break;
+    case CMD_STREAM:
+      respondStream(tokens, tokenCount);
+      break;
+    case CMD_STREAM_STATUS:
+      respondStreamStatus();
+      break;
+    case CMD_HELP:
+      startReply(PENDING_HELP);
+      break;
+    default:
+      printError(_tx, F("unknown command"));
+      break;
+  }
 }
 
 void FirmwareCli::dispatchCommand() {
@@ -343,8 +1137,50 @@ void FirmwareCli::dispatchCommand() {
   _cmdBuffer[0] = '\0';
 }
 
+void FirmwareCli::startReply(uint8_t pending) {
+  _pendingReply = pending;
+  _pendingOffset = 0;
+  continueReply();
+}
+
+void FirmwareCli::continueReply() {
+  while (_pendingReply != PENDING_NONE) {
+    // A piece is queued only when it fits; pump() first frees what the UART has taken.
+    if (_tx.getFree() < kPieceReserve) {
+      _tx.pump();
+      if (_tx.getFree() < kPieceReserve) return;
+    }
+    if (_pendingReply == PENDING_HELP) {
+      uint16_t run = kHelpLength - _pendingOffset;
+      if (run > kHelpPiece) run = kHelpPiece;
+      for (uint16_t i = 0; i < run; ++i) {
+        _tx.write(static_cast<uint8_t>(pgm_read_byte(&kHelpText[_pendingOffset + i])));
+      }
+      _pendingOffset = static_cast<uint16_t>(_pendingOffset + run);
+      if (_pendingOffset < kHelpLength) continue;
+      _tx.println();
+    } else if (_pendingOffset < replyPinCount()) {
+      appendDigitalPin(static_cast<uint8_t>(_pendingOffset++));
+      continue;
+    } else {
+      if (_pendingReply == PENDING_ALL) {
+        bool firstField = false;
+        appendEncoderFields(firstField);
+      }
+      _tx.println(F("}"));
+    }
+    _pendingReply = PENDING_NONE;
+  }
+}
+
+bool FirmwareCli::readyForCommand() const {
+  return _pendingReply == PENDING_NONE && _tx.getFree() >= kReplyReserve;
+}
+
 void FirmwareCli::processSerial() {
-  while (Serial.available() > 0) {
+  continueReply();
+  // Input waits in the UART's receive buffer while earlier replies are still queued.
+  while (readyForCommand() && Serial.available() > 0) {
     char c = static_cast<char>(Serial.read());
     if (c == '\r' || c == '\n') {
       dispatchCommand();
@@ -356,11 +1192,12 @@ void FirmwareCli::processSerial() {
       _lastByteTimeMs = millis();
     }
   }
-  if (_cmdLength > 0 && _lastByteTimeMs != 0) {
+  if (_cmdLength > 0 && _lastByteTimeMs != 0 && readyForCommand()) {
     unsigned long now = millis();
     if (now - _lastByteTimeMs >= kCmdIdleTimeoutMs) {
       dispatchCommand();
       _lastByteTimeMs = 0;
     }
   }
+  _tx.pump();
 }
\ No newline at end of file
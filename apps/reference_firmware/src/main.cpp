@@ -4,8 +4,12 @@
 #include "avr_timer1_pwm.h"
 #include "avr_timer2_driver.h"
 #include "digital_input_monitor.h"
+#include "duty_ramp.h"
 #include "encoder_generator.h"
+#include "event_queue.h"
 #include "firmware_cli.h"
+#include "idle_manager.h"
+#include "load_governor.h"
 #include "version_info.h"
 
 namespace {
@@ -14,17 +18,36 @@ constexpr uint16_t kAnalogRequestHz = 500;
 static_assert(kTimerTickHz % kAnalogRequestHz == 0,
               "Analog request rate must divide the scheduler tick rate.");
 constexpr uint8_t kAnalogTickDivider = kTimerTickHz / kAnalogRequestHz;
+constexpr unsigned long kLoadSampleMs = 100;
+constexpr uint16_t kIdleSampleMs = 1000;
+constexpr uint8_t kDigitalEventSource = 0;
+constexpr uint8_t kEncoderEventSource = 1;
+
+// Shed levels, in the order work is given up when the tick ISR runs hot. Digital input
+// monitoring is the must-have path and is never shed.
+constexpr uint8_t kShedAnalogHalfRate = 1;   // analog requests at half rate
+constexpr uint8_t kShedEncoderHalfRate = 2;  // encoder generator on alternate ticks
+constexpr uint8_t kShedAnalogSuspended = 3;  // no analog requests at all
 
 Timer2Driver timer2;
 AnalogSampler analogSampler;
 DigitalInputMonitor digitalInputMonitor;
 EncoderGenerator encoder;
 Timer1PWM pwm;
+DutyRamp dutyRamp;
+LoadGovernor loadGovernor;
+IdleManager idleManager;
+TickEventQueue tickEvents;
+uint16_t reportedDroppedEvents = 0;
 uint8_t analogTickDivider = 0;
+bool encoderSkipTick = false;
+unsigned long lastLoadSampleMs = 0;
+bool loadTransitionPending = false;
 
 volatile bool analogOk = false;
 volatile bool digitalMonitorOk = false;
 volatile bool encoderOk = false;
+volatile bool dutyRampOk = false;
 bool pwmOk = false;
 bool timerOk = false;
 
@@ -44,11 +67,16 @@ const DigitalInputMonitor::Config kDigitalMonitorConfig = {
 };
 
 const EncoderGenerator::Config kEncoderConfig = {
-    4, 5, 6, 7, true, false,
+    4, 5, 6, 7, true, false, kTimerTickHz,
 };
 
-const Timer1PWM::Config kPwmConfig(100.0f);
+// Resolved at compile time, so PWM bring-up does no prescaler search or float math.
+constexpr Timer1PWM::Timing kPwmTiming = Timer1PWM::timingForMilliHz(100000UL);
+static_assert(kPwmTiming.isValid(), "PWM frequency must be representable on Timer1.");
+const DutyRamp::Config kDutyRampConfig(&pwm, kTimerTickHz);
 const Timer2Driver::Config kTimerConfig(static_cast<float>(kTimerTickHz));
+const LoadGovernor::Config kLoadGovernorConfig(800, 500, 4, LoadGovernor::MAX_LEVEL);
+const IdleManager::Config kIdleConfig(true, kIdleSampleMs);
 const FirmwareCli::Config kCliConfig = {
     kAnalogPins,
     static_cast<uint8_t>(sizeof(kAnalogPins) / sizeof(kAnalogPins[0])),
@@ -59,19 +87,64 @@ const FirmwareCli::Config kCliConfig = {
 FirmwareCli firmwareCli(analogSampler, digitalInputMonitor, encoder, pwm, kCliConfig);
 
 void timerTickHandler() {
-  if (analogOk) {
-    if (++analogTickDivider >= kAnalogTickDivider) {
+  const PortSnapshot& ports = Timer2Driver::tickSnapshot();
+  uint8_t shedLevel = loadGovernor.getLevel();
+  if (analogOk && shedLevel < kShedAnalogSuspended) {
+    uint8_t divider = kAnalogTickDivider;
+    if (shedLevel >= kShedAnalogHalfRate) divider *= 2;
+    if (++analogTickDivider >= divider) {
       analogTickDivider = 0;
       analogSampler.onTick();
     }
   }
-  if (digitalMonitorOk) digitalInputMonitor.onTick();
-  if (encoderOk) encoder.onTick();
+  if (digitalMonitorOk) digitalInputMonitor.onTick(ports);
+  if (encoderOk) {
+    encoderSkipTick = (shedLevel >= kShedEncoderHalfRate) && !encoderSkipTick;
+    if (!encoderSkipTick) encoder.onTick(ports);
+  }
+  if (dutyRampOk) dutyRamp.onTick();
+}
+
+void drainTickEvents() {
+  TickEvent event;
+  // Events stay queued, and the dropped count and load transition unreported, while the CLI
+  // output buffer is backed up or a reply is still going out in pieces.
+  while (firmwareCli.hasRoomForReport() && tickEvents.pop(event)) {
+    firmwareCli.reportTickEvent(event);
+  }
+  if (loadTransitionPending && firmwareCli.hasRoomForReport()) {
+    loadTransitionPending = false;
+    firmwareCli.reportLoadTransition();
+  }
+  uint16_t dropped = tickEvents.getDroppedCount();
+  if (dropped != reportedDroppedEvents && firmwareCli.hasRoomForReport()) {
+    reportedDroppedEvents = dropped;
+    firmwareCli.reportDroppedEvents(dropped);
+  }
+}
+
+void updateLoadGovernor() {
+  unsigned long now = millis();
+  if (now - lastLoadSampleMs < kLoadSampleMs) return;
+  lastLoadSampleMs = now;
+  Timer2Driver::LoadSample sample;
+  if (!timer2.takeLoadSample(sample) || sample.ticks == 0) return;
+  if (loadGovernor.update(sample.utilizationPermille(), sample.overrunTicks)) {
+    loadTransitionPending = true;
+  }
 }
 
 void processSerial() {
   firmwareCli.processSerial();
 }
+
+// Runs with interrupts disabled right before idle sleep; reads only ISR-set flags.
+bool hasPendingWork() {
+  if (analogOk && analogSampler.isSampleDue()) return true;
+  if (digitalMonitorOk && digitalInputMonitor.isWindowReady()) return true;
+  if (!tickEvents.isEmpty()) return true;
+  return Serial.available() > 0;
+}
 }  // namespace
 
 void setup() {
@@ -88,16 +161,38 @@ void setup() {
 
   digitalMonitorOk = digitalInputMonitor.begin(kDigitalMonitorConfig);
   if (!digitalMonitorOk) Serial.println(F("{\"error\":\"digital init failed\"}"));
+  digitalInputMonitor.setEventQueue(&tickEvents, kDigitalEventSource);
 
   encoderOk = encoder.begin(kEncoderConfig);
   if (!encoderOk) Serial.println(F("{\"error\":\"encoder init failed\"}"));
+  encoder.setEventQueue(&tickEvents, kEncoderEventSource);
 
-  pwmOk = pwm.begin(kPwmConfig);
+  pwmOk = pwm.begin(kPwmTiming);
   if (!pwmOk) {
     Serial.println(F("{\"error\":\"pwm init failed\"}"));
   } else {
-    pwm.setDuty(0, 50.0f);
-    pwm.setDuty(1, 25.0f);
+    dutyRampOk = dutyRamp.begin(kDutyRampConfig);
+    if (dutyRampOk) {
+      firmwareCli.setDutyRamp(&dutyRamp);
+      (void)dutyRamp.setDuty(0, 500);
+      (void)dutyRamp.setDuty(1, 250);
+    } else {
+      Serial.println(F("{\"error\":\"duty ramp init failed\"}"));
+      pwm.setDutyPermille(0, 500);
+      pwm.setDutyPermille(1, 250);
+    }
+  }
+
+  if (loadGovernor.begin(kLoadGovernorConfig)) {
+    firmwareCli.setLoadGovernor(&loadGovernor);
+  } else {
+    Serial.println(F("{\"error\":\"load governor init failed\"}"));
+  }
+
+  if (idleManager.begin(kIdleConfig)) {
+    firmwareCli.setIdleManager(&idleManager);
+  } else {
+    Serial.println(F("{\"error\":\"idle manager init failed\"}"));
   }
 
   timerOk = timer2.begin(kTimerConfig) > 0;
@@ -115,5 +210,12 @@ void setup() {
 void loop() {
   if (analogOk) analogSampler.sampleIfDue();
   if (digitalMonitorOk) digitalInputMonitor.updateIfReady();
+  firmwareCli.serviceStreams();
+  if (timerOk) updateLoadGovernor();
+  drainTickEvents();
   processSerial();
+  (void)idleManager.update();
+  // Timer2 compare, USART RX and the millis() timer all wake the core, so no work waits
+  // longer than one tick.
+  (void)idleManager.idle(hasPendingWork);
 }
\ No newline at end of file
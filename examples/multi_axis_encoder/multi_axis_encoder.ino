@@ -0,0 +1,62 @@
+#include <Arduino.h>
+
+#include "avr_timer2_driver.h"
+#include "multi_axis_encoder.h"
+
+namespace {
+constexpr float kTickHz = 10000.0f;
+
+Timer2Driver timer2;
+MultiAxisEncoder axes;
+// All six A/B outputs sit on PORTD, so every tick costs a single port store.
+const MultiAxisEncoder::Axis kAxes[] = {
+    {2, 3, 8, 9},
+    {4, 5, 10, 11},
+    {6, 7, 12, 13},
+};
+const uint8_t kAxisCount = static_cast<uint8_t>(sizeof(kAxes) / sizeof(kAxes[0]));
+const MultiAxisEncoder::Config kAxesConfig(kAxes, kAxisCount, true, false,
+                                           static_cast<uint16_t>(kTickHz));
+const Timer2Driver::Config kTimerConfig(kTickHz);
+
+void onTick() {
+  axes.onTick();
+}
+}  // namespace
+
+void setup() {
+  Serial.begin(115200);
+  delay(100);
+
+  if (!axes.begin(kAxesConfig)) {
+    Serial.println(F("{\"error\":\"axes init failed\"}"));
+    return;
+  }
+  // Axis 0 steps every tick; the others emulate slower motors.
+  axes.setStepRateMilliHz(1, 2000000UL);
+  axes.setStepRateMilliHz(2, 500000UL);
+
+  if (timer2.begin(kTimerConfig) == 0) {
+    Serial.println(F("{\"error\":\"timer2 init failed\"}"));
+    return;
+  }
+
+  timer2.attachCallback(onTick);
+  Serial.println(F("multi_axis_encoder ready"));
+}
+
+void loop() {
+  static unsigned long lastPrintMs = 0;
+  unsigned long now = millis();
+  if (now - lastPrintMs < 500) return;
+  lastPrintMs = now;
+
+  int32_t positions[MultiAxisEncoder::MAX_AXES];
+  uint8_t count = axes.getPositions(positions, MultiAxisEncoder::MAX_AXES);
+  Serial.print(F("{\"positions\":["));
+  for (uint8_t i = 0; i < count; ++i) {
+    if (i != 0) Serial.print(F(","));
+    Serial.print(positions[i]);
+  }
+  Serial.println(F("]}"));
+}
@@ -0,0 +1,61 @@
+#include <Arduino.h>
+
+#include "avr_timer2_driver.h"
+#include "output_sequencer.h"
+
+namespace {
+constexpr float kTickHz = 10000.0f;  // 100 us per tick
+
+Timer2Driver timer2;
+OutputSequencer outputs;
+const uint8_t kPins[] = {2, 3, 4, 5};
+const OutputSequencer::Config kConfig(kPins, static_cast<uint8_t>(sizeof(kPins)));
+const Timer2Driver::Config kTimerConfig(kTickHz);
+
+// A 4-phase chase on D2..D4 that repeats every 40 ms; D5 is left for the trigger pulse.
+const OutputSequencer::Event kChase[] = {
+    {0, 0x07, 0x01},
+    {100, 0x07, 0x02},
+    {200, 0x07, 0x04},
+    {300, 0x07, 0x00},
+};
+constexpr uint16_t kChaseTicks = 400;
+constexpr uint8_t kTriggerChannel = 3;
+constexpr uint16_t kTriggerTicks = 25;  // exactly 2.5 ms
+
+void onTick() {
+  outputs.onTick();
+}
+}  // namespace
+
+void setup() {
+  Serial.begin(115200);
+  delay(100);
+
+  if (!outputs.begin(kConfig)) {
+    Serial.println(F("{\"error\":\"sequencer init failed\"}"));
+    return;
+  }
+
+  if (timer2.begin(kTimerConfig) == 0) {
+    Serial.println(F("{\"error\":\"timer2 init failed\"}"));
+    return;
+  }
+
+  timer2.attachCallback(onTick);
+  outputs.play(kChase, static_cast<uint8_t>(sizeof(kChase) / sizeof(kChase[0])), kChaseTicks,
+               true);
+  Serial.println(F("output_sequencer ready"));
+}
+
+void loop() {
+  static unsigned long lastTriggerMs = 0;
+  unsigned long now = millis();
+  if (now - lastTriggerMs < 1000) return;
+  lastTriggerMs = now;
+
+  outputs.pulse(kTriggerChannel, kTriggerTicks);
+  Serial.print(F("{\"loops\":"));
+  Serial.print(outputs.getLoopCount());
+  Serial.println(F("}"));
+}
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+
+#include "avr_timer2_driver.h"
+#include "soft_pwm.h"
+
+namespace {
+constexpr float kTickHz = 10000.0f;
+constexpr uint8_t kSteps = 100;  // 100 Hz PWM with 1 % steps
+
+Timer2Driver timer2;
+SoftPwm leds;
+const uint8_t kLedPins[] = {2, 3, 4, 5, 6, 7, 8, 11};
+const uint8_t kLedCount = static_cast<uint8_t>(sizeof(kLedPins) / sizeof(kLedPins[0]));
+const SoftPwm::Config kLedConfig(kLedPins, kLedCount, kSteps);
+const Timer2Driver::Config kTimerConfig(kTickHz);
+
+void onTick() {
+  leds.onTick();
+}
+}  // namespace
+
+void setup() {
+  Serial.begin(115200);
+  delay(100);
+
+  if (!leds.begin(kLedConfig)) {
+    Serial.println(F("{\"error\":\"soft pwm init failed\"}"));
+    return;
+  }
+
+  if (timer2.begin(kTimerConfig) == 0) {
+    Serial.println(F("{\"error\":\"timer2 init failed\"}"));
+    return;
+  }
+
+  timer2.attachCallback(onTick);
+  Serial.println(F("soft_pwm_leds ready"));
+}
+
+void loop() {
+  // Each LED follows the same triangle wave, shifted by one eighth of its cycle.
+  static unsigned long lastUpdateMs = 0;
+  static uint8_t phase = 0;
+  unsigned long now = millis();
+  if (now - lastUpdateMs < 20) return;
+  lastUpdateMs = now;
+  ++phase;
+
+  for (uint8_t i = 0; i < kLedCount; ++i) {
+    uint8_t t = static_cast<uint8_t>(phase + i * (256 / kLedCount));
+    uint8_t level = t < 128 ? t : static_cast<uint8_t>(255 - t);
+    leds.setLevel(i, static_cast<uint8_t>((level * kSteps) / 127));
+  }
+}
@@ -46,6 +46,12 @@ class AnalogSampler {
 
   /// @brief Performs pending ADC reads from loop context.
   void sampleIfDue();
+  /// @brief Returns true when a sampling round was requested and not yet performed.
+  /// Single-byte read, safe with interrupts disabled (e.g. from an idle pending-work check).
+  bool isSampleDue() const;
+  /// @brief Returns the number of sampling rounds performed since startup.
+  /// Loop-owned; a changed count tells loop-side consumers that new readings are available.
+  uint32_t getRoundCount() const;
 
   /// @brief Returns the number of configured analog channels.
   uint8_t getChannelCount() const;
@@ -72,6 +78,7 @@ class AnalogSampler {
   volatile bool _sampleRequested = false;
   int _lastValues[MAX_CHANNELS];
   uint16_t _vrefMillivolts = 5000;
+  uint32_t _roundCount = 0;
 };
 
 #endif  // IOFUSION_ANALOG_SAMPLER_H
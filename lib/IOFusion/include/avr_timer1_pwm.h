@@ -5,9 +5,65 @@
 
 #include <Arduino.h>
 
+#include "frequency_sweep.h"
+#include "step_ramp.h"
+#include "waveform_synth.h"
+
 /// @brief Controls the two hardware PWM outputs driven by AVR Timer1.
+///
+/// Immediate setters write the compare and TOP registers right away. The staged path
+/// (@ref stageUpdate(), @ref stageTiming()) instead commits a new frequency and both duties
+/// from the Timer1 overflow interrupt, so both outputs switch together on a period boundary.
+///
+/// Waveform playback (@ref startWaveform()) reloads both compare registers from the same
+/// overflow interrupt once per period, synthesizing a table waveform for an RC filter.
+///
+/// Complementary mode (@ref beginComplementary()) instead drives OC1A and an inverted OC1B
+/// from one duty in phase-correct PWM, with a programmable dead time between the two.
+///
+/// Square-wave mode (@ref beginSquareWave()) toggles OC1A in CTC mode for a 50 % output at
+/// up to 2 MHz, and @ref startSweep() steps its frequency from the compare interrupt.
+///
+/// Step mode (@ref startSteps()) turns the pair into a step/direction output for a stepper
+/// driver: OC1B emits one hardware-timed pulse per period and OC1A's pin carries direction.
+///
+/// The integer entry points (@ref beginMilliHz(), @ref begin(const Timing&),
+/// @ref setDutyPermille(), @ref setDutyCounts()) never touch floating point, so firmware that
+/// only uses them does not link the AVR soft-float routines. The `float` overloads remain for
+/// convenience.
 class Timer1PWM {
  public:
+  /// Timer1 input clock in hertz.
+  static constexpr uint32_t CLOCK_HZ =
+#if defined(F_CPU)
+      F_CPU;
+#else
+      16000000UL;
+#endif
+  /// Number of Timer1 clock prescalers (1, 8, 64, 256, 1024).
+  static constexpr uint8_t PRESCALER_COUNT = 5;
+  /// Shortest PWM period, in input-clock cycles, accepted by the staged-update path. The
+  /// commit must land early in the period, so periods shorter than a few ISR latencies are
+  /// rejected.
+  static constexpr uint16_t MIN_STAGED_PERIOD_CLOCKS = 256;
+  /// Shortest PWM period, in input-clock cycles, accepted by @ref startWaveform(). The
+  /// overflow ISR synthesizes one sample per period and must finish well inside it.
+  static constexpr uint16_t MIN_WAVEFORM_PERIOD_CLOCKS = 512;
+  /// Shortest half-period, in input-clock cycles, a sweep may reach. The compare ISR runs on
+  /// every output edge while a sweep plays.
+  static constexpr uint16_t MIN_SWEEP_HALF_PERIOD_CLOCKS = 512;
+  /// Shortest step period, in input-clock cycles, a step move may cruise at (40 kHz at
+  /// 16 MHz). The overflow ISR loads one period per step and must finish within the next one.
+  static constexpr uint16_t MIN_STEP_PERIOD_CLOCKS = 400;
+
+  /// @brief Tie-break used by @ref timingForMilliHz() when choosing a prescaler.
+  enum Preference : uint8_t {
+    /// Search every prescaler for the smallest frequency error; ties keep the finer resolution.
+    PREFER_ACCURACY = 0,
+    /// Use the fastest prescaler whose TOP fits, maximizing duty resolution.
+    PREFER_RESOLUTION = 1,
+  };
+
   /// @brief Startup configuration for Timer1PWM.
   struct Config {
     /// Requested PWM frequency in hertz.
@@ -17,6 +73,117 @@ class Timer1PWM {
     explicit Config(float frequencyHzIn) : frequencyHz(frequencyHzIn) {}
   };
 
+  /// @brief Resolved Timer1 TOP and prescaler for one PWM frequency.
+  /// Produce one with @ref timingForMilliHz(); for a literal frequency it is a compile-time
+  /// constant, so @ref begin(const Timing&) performs no search at runtime.
+  struct Timing {
+    /// ICR1 value; the PWM period is `top + 1` timer counts.
+    uint16_t top;
+    /// Timer1 clock-select bits (`CS12:0`); 0 marks an unrepresentable frequency.
+    uint8_t clockSelect;
+
+    constexpr Timing() : top(0), clockSelect(0) {}
+    constexpr Timing(uint16_t topIn, uint8_t clockSelectIn)
+        : top(topIn), clockSelect(clockSelectIn) {}
+
+    /// @brief Returns true when this timing can be programmed into Timer1.
+    constexpr bool isValid() const {
+      return clockSelect != 0 && clockSelect <= PRESCALER_COUNT && top != 0;
+    }
+    /// @brief Returns the input-clock cycles per PWM period, or 0 when invalid.
+    constexpr uint32_t periodClocks() const {
+      return isValid() ? static_cast<uint32_t>(prescalerAt(clockSelect - 1U)) * (top + 1UL) : 0;
+    }
+    /// @brief Returns the frequency this timing actually produces, rounded to millihertz.
+    constexpr uint32_t frequencyMilliHz() const {
+      return isValid() ? static_cast<uint32_t>((CLOCK_MILLIHZ + periodClocks() / 2U) /
+                                               periodClocks())
+                       : 0;
+    }
+    /// @brief Returns the duty resolution in whole bits, `floor(log2(top + 1))`.
+    constexpr uint8_t resolutionBits() const { return bitsFor(top + 1UL); }
+
+   private:
+    static constexpr uint8_t bitsFor(uint32_t steps) {
+      return steps < 2U ? 0 : static_cast<uint8_t>(1U + bitsFor(steps >> 1));
+    }
+  };
+
+  /// @brief Returns the clock divider for prescaler slot @p index (0..PRESCALER_COUNT-1).
+  static constexpr uint16_t prescalerAt(uint8_t index) {
+    return index == 0 ? 1 : index == 1 ? 8 : index == 2 ? 64 : index == 3 ? 256 : 1024;
+  }
+
+  /// @brief Resolves TOP and prescaler for @p freqMilliHz.
+  /// For each prescaler both neighbouring TOP values are scored by the frequency they
+  /// actually produce. Usable in constant expressions, e.g.
+  /// `constexpr Timer1PWM::Timing kPwm = Timer1PWM::timingForMilliHz(100000);`.
+  /// @return An invalid @ref Timing when no prescaler yields `1 <= TOP <= 65535`.
+  static constexpr Timing timingForMilliHz(uint32_t freqMilliHz,
+                                           Preference preference = PREFER_ACCURACY) {
+    return freqMilliHz == 0 ? Timing()
+           : preference == PREFER_RESOLUTION ? firstFitFrom(freqMilliHz, 0)
+                                             : bestFrom(freqMilliHz, 0, Timing());
+  }
+
+  /// @brief Resolves TOP and prescaler for complementary (phase-correct) PWM at
+  /// @p freqMilliHz. The counter runs up and down, so one period is `2 * top` timer counts.
+  /// @return An invalid @ref Timing when the frequency cannot be represented.
+  static constexpr Timing complementaryTimingForMilliHz(uint32_t freqMilliHz) {
+    return freqMilliHz == 0 || freqMilliHz > 0x7FFFFFFFUL
+               ? Timing()
+               : phaseCorrectFrom(timingForMilliHz(freqMilliHz * 2U));
+  }
+  /// @brief Returns the frequency @p timing produces in complementary mode, rounded to mHz.
+  static constexpr uint32_t complementaryFrequencyMilliHz(const Timing& timing) {
+    return timing.isValid() ? static_cast<uint32_t>((CLOCK_MILLIHZ + phaseCorrectClocks(timing) /
+                                                                         2U) /
+                                                    phaseCorrectClocks(timing))
+                            : 0;
+  }
+
+  /// @brief Compare values for one complementary duty and the order to store them in.
+  struct ComplementaryCompare {
+    /// OCR1A: the high side is on while the counter is below it.
+    uint16_t highSide;
+    /// OCR1B, dead-time counts above @ref highSide: the low side is on above it.
+    uint16_t lowSide;
+    /// Store OCR1B before OCR1A. TOP can load the buffers between the two stores, so the
+    /// register moving away from the other goes first and every pair that can go live keeps
+    /// at least the dead time between the edges.
+    bool lowSideFirst;
+  };
+  /// @brief Returns the compare pair for @p counts of high-side on-time at @p top, given the
+  /// high-side value currently in OCR1A. The high side is capped so the pair fits below TOP.
+  static constexpr ComplementaryCompare complementaryCompare(uint16_t counts, uint16_t top,
+                                                             uint16_t deadTimeCounts,
+                                                             uint16_t currentHighSide) {
+    return complementaryPair(counts > top - deadTimeCounts
+                                 ? static_cast<uint16_t>(top - deadTimeCounts)
+                                 : counts,
+                             deadTimeCounts, currentHighSide);
+  }
+
+  /// @brief Resolves TOP and prescaler for a square wave at @p freqMilliHz. Each half-period
+  /// is `top + 1` timer counts, so this is the PWM timing for twice the frequency.
+  /// @return An invalid @ref Timing when the frequency cannot be represented.
+  static constexpr Timing squareWaveTimingForMilliHz(uint32_t freqMilliHz) {
+    return freqMilliHz == 0 || freqMilliHz > 0x7FFFFFFFUL ? Timing()
+                                                          : timingForMilliHz(freqMilliHz * 2U);
+  }
+  /// @brief Returns the square-wave frequency @p timing produces, rounded to millihertz.
+  static constexpr uint32_t squareWaveFrequencyMilliHz(const Timing& timing) {
+    return timing.isValid() ? static_cast<uint32_t>((CLOCK_MILLIHZ + timing.periodClocks()) /
+                                                    (2U * timing.periodClocks()))
+                            : 0;
+  }
+
+  /// @brief Returns the Q16 fixed-point number of timer counts per permille of duty at
+  /// @p top. @ref setDutyPermille() multiplies by this instead of dividing.
+  static constexpr uint32_t countsPerPermilleQ16(uint16_t top) {
+    return (static_cast<uint32_t>(top) << 16) / 1000U;
+  }
+
   /// @brief Constructs a stopped PWM controller.
   Timer1PWM();
 
@@ -28,21 +195,266 @@ class Timer1PWM {
   /// @brief Convenience overload that forwards to @ref begin(const Config&).
   bool begin(float freqHz);
 
+  /// @brief Configures Timer1 for a frequency given in millihertz, using integer math only.
+  /// @param preference Prescaler choice passed to @ref timingForMilliHz().
+  /// @return `true` when the requested frequency can be represented on Timer1.
+  bool beginMilliHz(uint32_t freqMilliHz, Preference preference = PREFER_ACCURACY);
+
+  /// @brief Configures Timer1 from a pre-resolved TOP/prescaler pair.
+  /// @return `false` when @p timing is not valid.
+  bool begin(const Timing& timing);
+
+  /// @brief Configures OC1A/OC1B as a complementary pair for a half-bridge.
+  /// Timer1 runs phase-correct PWM with TOP = ICR1; OC1A is the high-side output and OC1B the
+  /// inverted low-side output. Channel 0's duty sets OC1A's on-time, and OC1B's compare value
+  /// trails it by @p deadTimeCounts, so both outputs are low for that many timer counts at
+  /// each transition and are never high together. Channel 1 setters are ignored in this
+  /// mode, as are staged updates and waveform playback.
+  /// @param timing Phase-correct timing, e.g. from @ref complementaryTimingForMilliHz().
+  /// @param deadTimeCounts Dead time per edge in timer counts (prescaled clock cycles).
+  /// @return `false` when @p timing is invalid or @p deadTimeCounts is not below its TOP.
+  bool beginComplementary(const Timing& timing, uint16_t deadTimeCounts);
+  /// @brief Returns true while complementary mode is active.
+  bool isComplementary() const;
+  /// @brief Returns the configured dead time in timer counts (0 outside complementary mode).
+  uint16_t getDeadTimeCounts() const;
+
+  /// @brief Outputs a 50 % square wave on OC1A by toggling it on every compare match.
+  /// Timer1 runs CTC with TOP = OCR1A and no interrupt, so the edges are exact to one
+  /// input clock. OC1B is held LOW. Duty setters, staged updates and waveform playback are
+  /// ignored or refused until the next `begin()`.
+  /// @param timing Half-period timing, e.g. from @ref squareWaveTimingForMilliHz().
+  /// @return `false` when @p timing is invalid.
+  bool beginSquareWave(const Timing& timing);
+  /// @brief Starts square-wave mode at the sweep's start frequency and steps through the
+  /// sweep from the Timer1 compare interrupt.
+  /// Each step is written at an output edge, right after the counter restarts, so every
+  /// half-period is complete; a prescaler change may shorten the first count after it by less
+  /// than one prescaled count. A step edge costs up to two 32-bit divisions in the ISR
+  /// (tens of microseconds), which is why the step rate is capped at
+  /// @ref FrequencySweep::MAX_STEP_HZ.
+  /// @return `false` when @ref FrequencySweep::begin() rejects @p config, including endpoints
+  /// shorter than @ref MIN_SWEEP_HALF_PERIOD_CLOCKS per half-period.
+  bool startSweep(const FrequencySweep::Config& config);
+  /// @brief Stops stepping and holds the current frequency.
+  void stopSweep();
+  /// @brief Returns true while a sweep is stepping.
+  bool isSweepActive() const;
+  /// @brief Returns true while square-wave mode is active.
+  bool isSquareWave() const;
+  /// @brief Returns the square-wave frequency Timer1 is producing now, in mHz, or 0 outside
+  /// square-wave mode. During a sweep this is the step being played.
+  uint32_t getSquareWaveFrequencyMilliHz() const;
+
+  /// @brief Plays a step move on OC1B (pin 10) with the direction level on pin 9.
+  /// Timer1 runs fast PWM with TOP = OCR1A and OC1B inverting, so each step period ends with a
+  /// pulse of @ref StepRamp::Config::pulseWidthUs whose edges are set by the hardware. The
+  /// overflow ISR counts the pulse that just ended and loads the period after next from the
+  /// precomputed @ref StepRamp table, so pulse timing does not depend on interrupt latency.
+  /// The direction pin is set before the first period starts; duty setters, staged updates and
+  /// waveform playback are ignored or refused until the next `begin()`, which like `stop()`
+  /// ends a move immediately.
+  /// @param forward Level driven on the direction pin: HIGH when true.
+  /// @return `false` when @ref StepRamp::begin() rejects @p config, including cruise periods
+  /// shorter than @ref MIN_STEP_PERIOD_CLOCKS. A running move is ended either way.
+  bool startSteps(const StepRamp::Config& config, bool forward);
+  /// @brief Ends the move without deceleration after at most one more complete pulse.
+  void stopSteps();
+  /// @brief Returns true while a step move is running.
+  bool isStepping() const;
+  /// @brief Returns the pulses completed by the current or last move.
+  uint32_t getStepsDone() const;
+
   /// @brief Updates the duty cycle for a hardware PWM channel.
   /// @param channel Hardware channel index: 0 for OC1A, 1 for OC1B.
   /// @param percent Duty cycle percentage. Values are clamped to 0..100.
   void setDuty(uint8_t channel, float percent);
 
+  /// @brief Updates the duty cycle in permille of the period (clamped to 0..1000).
+  /// One multiply and shift; no division or floating point.
+  void setDutyPermille(uint8_t channel, uint16_t permille);
+
+  /// @brief Updates the duty cycle as a raw compare value in timer counts (clamped to TOP).
+  /// Before the first successful `begin()`, counts are interpreted against a TOP of 65535.
+  void setDutyCounts(uint8_t channel, uint16_t counts);
+  /// @brief Updates the duty in permille from ISR context, leaving the interrupt flag alone.
+  /// Does not cancel a staged update; the write is refused instead while one is pending,
+  /// since the commit replaces both duties.
+  /// @return `false` when PWM is not configured, the channel is invalid, an update is staged,
+  /// or a waveform is playing.
+  bool writeDutyPermilleFromIsr(uint8_t channel, uint16_t permille);
+
+  /// @brief Stages a new timing and both channel duties for a glitch-free commit.
+  /// The overflow ISR first writes the double-buffered compare registers after BOTTOM, then
+  /// early in the next period writes TOP, the prescaler and the output modes, so the first
+  /// period that uses the new TOP also uses the new duties (see stepStagedCommit()). A commit
+  /// delayed past the new TOP or a whole period puts the old duties back and retries, so at
+  /// most that one late period plays the new duties on the old TOP. Restaging replaces a
+  /// pending update; any immediate setter or `begin()`/`stop()` cancels it.
+  /// @param dutyPermilleA Duty for OC1A in `0..1000` (clamped).
+  /// @param dutyPermilleB Duty for OC1B in `0..1000` (clamped).
+  /// @return `false` when PWM is not configured, a waveform is playing, @p timing is invalid,
+  /// or either the current or the staged period is shorter than
+  /// @ref MIN_STAGED_PERIOD_CLOCKS.
+  bool stageUpdate(const Timing& timing, uint16_t dutyPermilleA, uint16_t dutyPermilleB);
+  /// @brief Stages a new timing that keeps both channels' current duty ratios.
+  /// Same commit and rejection rules as @ref stageUpdate().
+  bool stageTiming(const Timing& timing);
+  /// @brief Returns true while a staged update has not been fully committed.
+  bool isUpdatePending() const;
+  /// @brief Plays a table waveform on both channels, one sample per PWM period.
+  /// The overflow ISR steps @p config's phase accumulator and loads OCR1A/OCR1B, which take
+  /// effect at the next period start, so sample timing is locked to the PWM clock. Duties set
+  /// before are restored by @ref stopWaveform(); any duty setter, `begin()` or `stop()` ends
+  /// playback, and staged updates are refused while it runs.
+  /// @return `false` when PWM is not configured, the period is shorter than
+  /// @ref MIN_WAVEFORM_PERIOD_CLOCKS, or @ref WaveformSynth::begin() rejects @p config for the
+  /// active TOP and frequency.
+  bool startWaveform(const WaveformSynth::Config& config);
+  /// @brief Ends waveform playback and restores the cached channel duties.
+  void stopWaveform();
+  /// @brief Returns true while waveform playback is running.
+  bool isWaveformActive() const;
+  /// @brief Returns the waveform frequency actually produced, in mHz, or 0 when stopped.
+  uint32_t getWaveformFrequencyMilliHz() const;
+  /// @brief ISR entry point used by the Timer1 overflow vector.
+  static void handleOverflow();
+  /// @brief ISR entry point used by the Timer1 compare A vector.
+  static void handleCompareA();
+
+  /// @brief Returns the active TOP, or 0 when PWM is not configured.
+  uint16_t getTop() const;
+  /// @brief Returns the active timing; use @ref Timing::frequencyMilliHz() and
+  /// @ref Timing::resolutionBits() to read back what the hardware produces. In square-wave
+  /// mode this is the half-period timing. Invalid when PWM is not configured.
+  Timing getTiming() const;
+
   /// @brief Stops PWM generation and releases the hardware pins.
+  /// Both outputs are forced LOW before the compare units are disconnected. In complementary
+  /// mode the pins then stay driven LOW instead of floating, so a gate driver sees both
+  /// switches off.
   void stop();
 
  private:
+  /// Duty reference TOP while no timing is configured.
+  static constexpr uint16_t UNCONFIGURED_TOP = 0xFFFF;
+
   uint16_t _top = 0;       // ICR1 top value
   uint16_t _presBits = 0;  // CS bits in TCCR1B
-  float _dutyPercent[2] = {0.0f, 0.0f};
   bool _configured = false;
-  uint16_t percentToCounts(float percent, uint16_t top) const;
-  void _applyDuty(uint8_t channel, float percent, uint16_t top);
+  // Duty per channel in counts of _dutyTop (the active TOP, or UNCONFIGURED_TOP while stopped).
+  uint16_t _dutyCounts[2] = {0, 0};
+  uint16_t _dutyTop = UNCONFIGURED_TOP;
+  uint32_t _countsPerPermilleQ16 = countsPerPermilleQ16(UNCONFIGURED_TOP);
+
+  static constexpr uint64_t CLOCK_MILLIHZ = static_cast<uint64_t>(CLOCK_HZ) * 1000U;
+
+  // Solver helpers. Candidate periods are compared in input-clock cycles, and frequency errors
+  // by cross-multiplication, so no division or rounding hides a difference.
+  static constexpr uint64_t errorScaled(uint32_t freqMilliHz, uint32_t periodClocks) {
+    return CLOCK_MILLIHZ >= static_cast<uint64_t>(freqMilliHz) * periodClocks
+               ? CLOCK_MILLIHZ - static_cast<uint64_t>(freqMilliHz) * periodClocks
+               : static_cast<uint64_t>(freqMilliHz) * periodClocks - CLOCK_MILLIHZ;
+  }
+  static constexpr bool moreAccurate(uint32_t freqMilliHz, const Timing& a, const Timing& b) {
+    return errorScaled(freqMilliHz, a.periodClocks()) * b.periodClocks() <
+           errorScaled(freqMilliHz, b.periodClocks()) * a.periodClocks();
+  }
+  static constexpr Timing timingFor(uint64_t period, uint8_t index) {
+    return period >= 2U && period <= 65536U
+               ? Timing(static_cast<uint16_t>(period - 1U), static_cast<uint8_t>(index + 1U))
+               : Timing();
+  }
+  static constexpr Timing closer(uint32_t freqMilliHz, const Timing& a, const Timing& b) {
+    return !a.isValid()                      ? b
+           : !b.isValid()                    ? a
+           : moreAccurate(freqMilliHz, b, a) ? b
+                                             : a;
+  }
+  static constexpr uint64_t floorPeriod(uint32_t freqMilliHz, uint8_t index) {
+    return CLOCK_MILLIHZ / (static_cast<uint64_t>(prescalerAt(index)) * freqMilliHz);
+  }
+  // Best of the two TOP values around the ideal period for one prescaler.
+  static constexpr Timing timingAt(uint32_t freqMilliHz, uint8_t index) {
+    return closer(freqMilliHz, timingFor(floorPeriod(freqMilliHz, index), index),
+                  timingFor(floorPeriod(freqMilliHz, index) + 1U, index));
+  }
+  static constexpr Timing firstFitFrom(uint32_t freqMilliHz, uint8_t index) {
+    return index >= PRESCALER_COUNT                 ? Timing()
+           : timingAt(freqMilliHz, index).isValid() ? timingAt(freqMilliHz, index)
+                                                    : firstFitFrom(freqMilliHz, index + 1U);
+  }
+  static constexpr Timing bestFrom(uint32_t freqMilliHz, uint8_t index, Timing best) {
+    return index >= PRESCALER_COUNT
+               ? best
+               : bestFrom(freqMilliHz, index + 1U,
+                          closer(freqMilliHz, best, timingAt(freqMilliHz, index)));
+  }
+
+  // Phase-correct PWM counts TOP steps up and TOP steps down; a fast-PWM period of
+  // `top + 1` counts at twice the frequency is therefore the same TOP plus one.
+  static constexpr uint64_t phaseCorrectClocks(const Timing& timing) {
+    return 2U * static_cast<uint64_t>(prescalerAt(timing.clockSelect - 1U)) * timing.top;
+  }
+  static constexpr ComplementaryCompare complementaryPair(uint16_t highSide,
+                                                          uint16_t deadTimeCounts,
+                                                          uint16_t currentHighSide) {
+    return ComplementaryCompare{highSide, static_cast<uint16_t>(highSide + deadTimeCounts),
+                                highSide > currentHighSide};
+  }
+  static constexpr Timing phaseCorrectFrom(const Timing& fast) {
+    return fast.isValid() && fast.top < 0xFFFFU
+               ? Timing(static_cast<uint16_t>(fast.top + 1U), fast.clockSelect)
+               : Timing();
+  }
+
+  static Timer1PWM* volatile _activeInstance;
+  // 0 = idle, 1 = compare buffers to be written, 2 = TOP/mode commit due early in the next
+  // period.
+  volatile uint8_t _stagePhase = 0;
+  uint16_t _stagedTop = 0;
+  uint8_t _stagedClockSelect = 0;
+  uint16_t _stagedCounts[2] = {0, 0};
+  // Compare values phase 1 replaced, written back when a commit runs late.
+  uint16_t _restoreCounts[2] = {0, 0};
+  uint32_t _stagedScaleQ16 = 0;
+
+  void setDutyTop(uint16_t top);
+  void _applyDuty(uint8_t channel, uint16_t counts, uint16_t top);
+  bool stageCounts(const Timing& timing, uint16_t countsA, uint16_t countsB);
+  void cancelStaged();
+  void commitStaged();
+
+  WaveformSynth _waveform;
+  volatile bool _waveformActive = false;
+
+  void stepWaveform();
+
+  bool _complementary = false;
+  uint16_t _deadTimeCounts = 0;
+
+  void applyComplementary(uint16_t counts, uint16_t top);
+
+  bool _squareWave = false;
+  FrequencySweep _sweep;
+  volatile bool _sweepActive = false;
+
+  void stepSweep();
+
+  bool _stepMode = false;
+  StepRamp _stepRamp;
+  volatile bool _stepping = false;
+  volatile bool _stepStopRequested = false;
+  volatile uint32_t _stepsDone = 0;
+  // ISR-owned: pulses the move ends after, lowered by a stop request.
+  uint32_t _stepLimit = 0;
+  uint16_t _stepPulseCounts = 0;
+  // ISR-owned: TOP of the period now playing and of the one waiting in the OCR1A buffer.
+  uint16_t _stepTopPlaying = 0;
+  uint16_t _stepTopQueued = 0;
+
+  void stepPulse();
+  void endSteps();
 };
 
 #endif  // IOFUSION_AVR_TIMER1_PWM_H
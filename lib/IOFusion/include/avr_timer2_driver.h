@@ -5,6 +5,8 @@
 
 #include <Arduino.h>
 
+#include "port_snapshot.h"
+
 typedef void (*Timer2Callback)();
 
 /// @brief Provides a periodic Timer2 interrupt source and callback dispatch table.
@@ -19,6 +21,34 @@ class Timer2Driver {
     explicit Config(float frequencyHzIn) : frequencyHz(frequencyHzIn) {}
   };
 
+  /// @brief ISR time accumulated since the previous @ref takeLoadSample() call.
+  ///
+  /// Busy time is measured in Timer2 counts: at the end of each dispatch the counter value
+  /// is the time spent since the compare match that started the tick.
+  struct LoadSample {
+    /// Sum of per-tick ISR busy time in Timer2 counts.
+    uint32_t busyCounts = 0;
+    /// Number of ticks that contributed to @ref busyCounts. Saturates at 65535.
+    uint16_t ticks = 0;
+    /// Timer2 counts in one tick period (`OCR2A + 1`).
+    uint16_t periodCounts = 0;
+    /// Ticks whose dispatch ran past the next compare match.
+    uint16_t overrunTicks = 0;
+
+    /// @brief Returns the ISR utilization of the sampled interval in permille, capped at 1000.
+    uint16_t utilizationPermille() const {
+      uint32_t capacity = static_cast<uint32_t>(ticks) * periodCounts;
+      uint32_t busy = busyCounts;
+      while (busy > 4294967UL) {
+        busy >>= 1;
+        capacity >>= 1;
+      }
+      if (capacity == 0) return busy == 0 ? 0 : 1000;
+      uint32_t permille = ((busy * 1000UL) + (capacity / 2U)) / capacity;
+      return permille > 1000U ? 1000U : static_cast<uint16_t>(permille);
+    }
+  };
+
   /// @brief Constructs an inactive Timer2 driver.
   Timer2Driver();
 
@@ -44,13 +74,30 @@ class Timer2Driver {
   /// @brief ISR entry point used by the Timer2 compare-match vector.
   static void handleInterrupt();
 
+  /// @brief Returns the port inputs captured at the start of the current tick.
+  /// Only meaningful from inside an attached callback; every callback of one tick sees the
+  /// same snapshot, so consumers sample their inputs at one coherent instant.
+  static const PortSnapshot& tickSnapshot();
+
+  /// @brief Copies and clears the ISR load accumulated since the previous call.
+  /// @param sample Receives busy time, tick count, and overrun count.
+  /// @return `false` when this driver is not the active Timer2 owner.
+  bool takeLoadSample(LoadSample& sample);
+
  private:
   static const uint8_t MAX_CALLBACKS = 4;
   volatile Timer2Callback _cbs[MAX_CALLBACKS];
   static Timer2Driver* volatile _activeDriver;
+  static PortSnapshot _tickSnapshot;
+  uint8_t _compareValue = 0;
+  volatile uint32_t _busyCounts = 0;
+  volatile uint16_t _loadTicks = 0;
+  volatile uint16_t _overrunTicks = 0;
 
   void resetCallbacks();
+  void resetLoad();
   void dispatchCallbacks();
+  void recordLoad();
 };
 
 #endif  // IOFUSION_AVR_TIMER2_DRIVER_H
@@ -5,6 +5,10 @@
 
 #include <Arduino.h>
 
+#include "event_queue.h"
+#include "port_snapshot.h"
+#include "seqlock.h"
+
 /// @brief Estimates frequency and duty cycle from sampled digital inputs.
 ///
 /// This component is intentionally a sampled estimator, not a hardware capture block.
@@ -50,8 +54,23 @@ class DigitalInputMonitor {
 
   /// @brief Samples the monitored inputs once from ISR context.
   void onTick();
+  /// @brief Samples the monitored inputs from a tick-wide port snapshot instead of reading
+  /// the input registers again.
+  /// @param ports Input levels captured once at the start of the tick.
+  void onTick(const PortSnapshot& ports);
+
+  /// @brief Routes window events to a loop-side queue, or stops posting when @p queue is null.
+  /// Events are posted from @ref onTick(const PortSnapshot&) and stamped with the snapshot
+  /// tick: @ref TICK_EVENT_WINDOW_READY when a window completes and
+  /// @ref TICK_EVENT_WINDOW_OVERRUN on the first tick dropped while it waits to be drained.
+  /// @param queue Queue owned by the caller; it must outlive the monitor.
+  /// @param source Id copied into every posted event.
+  void setEventQueue(TickEventQueue* queue, uint8_t source = 0);
   /// @brief Converts the most recent completed sampling window into frequency and duty estimates.
   void updateIfReady();
+  /// @brief Returns true when a completed window is waiting for @ref updateIfReady().
+  /// Single-byte read, safe with interrupts disabled (e.g. from an idle pending-work check).
+  bool isWindowReady() const;
 
   /// @brief Snapshot of one coherently copied published measurement frame.
   struct Frame {
@@ -65,8 +84,9 @@ class DigitalInputMonitor {
 
   /// @brief Returns the number of configured pins.
   uint8_t getPinCount() const;
-  /// @brief Copies the currently published frame and associated telemetry under one critical
-  /// section.
+  /// @brief Copies the currently published frame and associated telemetry.
+  /// Interrupts stay enabled; the ISR-owned overrun count is read under a sequence lock and
+  /// re-read if a tick updated it mid-copy. Call from loop context.
   void copyFrame(Frame& frame) const;
   /// @brief Returns the latest frequency estimate for a configured pin.
   float getFrequency(uint8_t idx) const;
@@ -104,6 +124,16 @@ class DigitalInputMonitor {
   uint32_t _frameSequence = 0;
   uint32_t _freqMilliHz[MAX_PINS];
   uint16_t _dutyPermille[MAX_PINS];
+  uint8_t _pinPort[MAX_PINS];
+  TickEventQueue* _eventQueue = nullptr;
+  uint8_t _eventSource = 0;
+
+  void recordOverrun();
+  void accumulateSample(uint8_t levels);
+  void postEvent(uint32_t tick, uint8_t code, uint16_t value);
+  uint32_t readOverrunCount() const;
+
+  SeqLock _overrunLock;
 };
 
 #endif  // IOFUSION_DIGITAL_INPUT_MONITOR_H
\ No newline at end of file
@@ -6,6 +6,9 @@
 #include <Arduino.h>
 #endif
 
+// Output pins with port registers and masks cached at begin(). Every write goes through one
+// masked read-modify-write per port inside a single critical section, so pins on the same
+// port change together and other pins on those ports are left alone.
 class DigitalOut {
  public:
   static constexpr uint8_t MAX_PINS = 8;
@@ -18,18 +21,35 @@ class DigitalOut {
 
   DigitalOut();
 
+  // Rejects a null or empty list, more than MAX_PINS pins, a repeated pin, or a pin without
+  // an output port.
   bool begin(const Config& config);
   bool begin(const uint8_t* pins, uint8_t count, bool initialHigh = false);
 
   bool write(uint8_t idx, bool high);
   bool toggle(uint8_t idx);
   bool setAll(bool high);
+  // Bit i of mask selects pin i; selected pins take the level of the same bit in values.
+  // Returns false when mask selects an unconfigured index.
+  bool writeMask(uint8_t mask, uint8_t values);
+  // Records a level without touching the pin; apply() then writes every staged level at once.
+  bool stage(uint8_t idx, bool high);
+  bool apply();
   bool getState(uint8_t idx, bool& out) const;
+  // Last written (or staged) level of every pin, bit i for pin i.
+  uint8_t getStates() const;
   uint8_t getPinCount() const;
 
  private:
   uint8_t _pins[MAX_PINS];
-  bool _state[MAX_PINS];
+  // Port slot and bit mask per pin; slots index _portOut.
+  uint8_t _slot[MAX_PINS];
+  uint8_t _mask[MAX_PINS];
+  volatile uint8_t* _portOut[MAX_PINS];
+  uint8_t _portCount;
+  uint8_t _state;
   uint8_t _pinCount;
   bool validIndex(uint8_t idx) const;
+  uint8_t allPins() const;
+  void writePorts(uint8_t mask, uint8_t values);
 };
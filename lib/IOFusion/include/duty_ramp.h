@@ -0,0 +1,116 @@
+/// @file duty_ramp.h
+/// @brief Tick-driven duty slewing and piecewise-linear profiles for Timer1PWM.
+#ifndef IOFUSION_DUTY_RAMP_H
+#define IOFUSION_DUTY_RAMP_H
+
+#include <Arduino.h>
+
+#include "avr_timer1_pwm.h"
+#include "seqlock.h"
+
+/// @brief Moves each Timer1 PWM channel toward a target duty from tick context.
+///
+/// A channel either slews toward one target at a fixed rate (@ref rampTo()) or plays a
+/// piecewise-linear profile (@ref playProfile()). All divisions happen in loop context when
+/// a ramp is started; @ref onTick() only adds a precomputed Q16 permille step per channel
+/// and writes the compare register when the rounded duty changes.
+///
+/// While a channel is active the ramp owns its duty: use @ref setDuty() rather than the
+/// Timer1PWM setters. A Timer1 retune staged mid-ramp commits the duties captured when it was
+/// staged; the ramp resumes writing on its next change of duty.
+class DutyRamp {
+ public:
+  /// Number of Timer1 PWM channels (OC1A, OC1B).
+  static const uint8_t CHANNELS = 2;
+  /// Most segments one profile may hold.
+  static const uint8_t MAX_SEGMENTS = 8;
+
+  /// @brief One profile segment: a linear move from the previous duty to @ref dutyPermille.
+  struct Segment {
+    /// Duty reached at the end of the segment, in permille (clamped to 1000).
+    uint16_t dutyPermille;
+    /// Segment length in milliseconds; 0 jumps on the next tick.
+    uint16_t durationMs;
+  };
+
+  /// @brief Startup configuration for DutyRamp.
+  struct Config {
+    /// PWM driver the duties are written to; it must outlive the ramp.
+    Timer1PWM* pwm = nullptr;
+    /// Rate at which @ref onTick() is called, in hertz (1..65535).
+    uint16_t tickHz = 1000;
+
+    Config() = default;
+    Config(Timer1PWM* pwmIn, uint16_t tickHzIn) : pwm(pwmIn), tickHz(tickHzIn) {}
+  };
+
+  /// @brief Constructs an idle ramp with no PWM attached.
+  DutyRamp();
+
+  /// @brief Attaches the PWM driver and stops every channel at 0 permille.
+  /// @return `false` when `pwm` is null or `tickHz` is 0.
+  bool begin(const Config& config);
+
+  /// @brief Stops any ramp on @p channel and sets its duty immediately.
+  /// @return `false` before @ref begin() or for an invalid channel.
+  bool setDuty(uint8_t channel, uint16_t permille);
+
+  /// @brief Slews @p channel from its current duty to @p targetPermille.
+  /// The move takes `ceil(|delta| * tickHz / slewPermillePerSec)` ticks and ends exactly on
+  /// the target.
+  /// @param slewPermillePerSec Duty change per second in permille; must be non-zero.
+  /// @return `false` before @ref begin() or for an invalid channel or zero slew rate.
+  bool rampTo(uint8_t channel, uint16_t targetPermille, uint16_t slewPermillePerSec);
+
+  /// @brief Plays @p segments on @p channel, starting from its current duty.
+  /// The segments are copied, so the caller's array may be temporary.
+  /// @param repeat When true, the profile restarts from its last duty after the last segment.
+  /// @return `false` before @ref begin(), for an invalid channel, or when @p count is 0 or
+  /// larger than @ref MAX_SEGMENTS.
+  bool playProfile(uint8_t channel, const Segment* segments, uint8_t count, bool repeat = false);
+
+  /// @brief Stops any ramp on @p channel, holding its current duty.
+  void stop(uint8_t channel);
+
+  /// @brief Advances every active channel by one tick. Call from the tick ISR only.
+  void onTick();
+
+  /// @brief Returns the duty last written for @p channel, in permille (0 when invalid).
+  /// Read without masking interrupts; the copy is retried if a tick updates it mid-read.
+  uint16_t getDutyPermille(uint8_t channel) const;
+  /// @brief Returns true while @p channel is ramping or playing a profile.
+  bool isActive(uint8_t channel) const;
+
+ private:
+  struct Channel {
+    // Ramp position in Q16 permille.
+    uint32_t dutyQ16 = 0;
+    // Signed per-tick change in Q16 permille and ticks left in the running segment.
+    int32_t stepQ16 = 0;
+    uint32_t remainingTicks = 0;
+    // Duty last accepted by the PWM; updated by onTick() under _dutyLock.
+    uint16_t writtenPermille = 0;
+    volatile bool active = false;
+    bool repeat = false;
+    uint8_t segmentCount = 0;
+    uint8_t segmentIndex = 0;
+    // Precomputed segments; a plain slew is a one-segment profile.
+    uint16_t segmentTarget[MAX_SEGMENTS] = {0};
+    int32_t segmentStepQ16[MAX_SEGMENTS] = {0};
+    uint32_t segmentTicks[MAX_SEGMENTS] = {0};
+    // Step of segment 0 when a repeating profile wraps from its last duty.
+    int32_t wrapStepQ16 = 0;
+  };
+
+  Timer1PWM* _pwm = nullptr;
+  uint16_t _tickHz = 0;
+  Channel _channels[CHANNELS];
+  SeqLock _dutyLock;
+
+  uint32_t ticksForMs(uint16_t durationMs) const;
+  void halt(Channel& channel);
+  void start(Channel& channel);
+  bool advance(Channel& channel);
+};
+
+#endif  // IOFUSION_DUTY_RAMP_H
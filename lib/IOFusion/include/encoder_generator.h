@@ -5,7 +5,27 @@
 
 #include <Arduino.h>
 
+#include "event_queue.h"
+#include "port_snapshot.h"
+#include "seqlock.h"
+
 /// @brief Generates quadrature A/B output transitions from up/down control signals.
+///
+/// By default one quadrature step is emitted per tick while a direction input is asserted.
+/// With @ref Config::tickHz set, @ref setStepRateMilliHz() selects any lower rate: each
+/// asserted tick adds a fixed increment to a 32-bit phase accumulator and steps on carry, so
+/// steps stay on tick boundaries and the long-run average rate is exact to `tickHz / 2^32`.
+///
+/// @ref moveTo() runs a trapezoidal motion profile through the same accumulator: the tick
+/// adds a fixed-point acceleration to the phase increment until the cruise velocity, and
+/// decelerates once the steps left equal the steps it took to accelerate, so the ramp down
+/// mirrors the ramp up and ends on the target. The direction inputs are ignored while a move
+/// runs.
+///
+/// An optional index (Z) output pulses once per revolution of
+/// @ref IndexConfig::countsPerRevolution counts. A, B and Z are written together from the
+/// step's output state, one store per port, so pins sharing a port change in the same
+/// instruction.
 class EncoderGenerator {
  public:
   /// @brief Startup configuration for EncoderGenerator.
@@ -22,16 +42,40 @@ class EncoderGenerator {
     bool usePullup = false;
     /// Interprets asserted direction inputs as HIGH when true, LOW when false.
     bool activeHigh = true;
+    /// Rate at which the tick calls @ref onTick(), in hertz; 0 disables
+    /// @ref setStepRateMilliHz() and keeps one step per tick.
+    uint16_t tickHz = 0;
 
     Config() = default;
     Config(uint8_t pinAIn, uint8_t pinBIn, uint8_t upPinIn, uint8_t downPinIn, bool usePullupIn,
-           bool activeHighIn)
+           bool activeHighIn, uint16_t tickHzIn = 0)
         : pinA(pinAIn),
           pinB(pinBIn),
           upPin(upPinIn),
           downPin(downPinIn),
           usePullup(usePullupIn),
-          activeHigh(activeHighIn) {}
+          activeHigh(activeHighIn),
+          tickHz(tickHzIn) {}
+  };
+
+  /// @brief Index (Z) output settings.
+  struct IndexConfig {
+    /// Index output pin.
+    uint8_t pin = 255;
+    /// Quadrature counts (four per A/B cycle) per revolution; 0 disables the index.
+    uint16_t countsPerRevolution = 0;
+    /// Count within the revolution at which the pulse starts (`0..countsPerRevolution-1`).
+    uint16_t offset = 0;
+    /// Pulse width in counts (`1..countsPerRevolution-1`); 4 spans one full A/B cycle.
+    uint16_t width = 1;
+
+    IndexConfig() = default;
+    IndexConfig(uint8_t pinIn, uint16_t countsPerRevolutionIn, uint16_t offsetIn = 0,
+                uint16_t widthIn = 1)
+        : pin(pinIn),
+          countsPerRevolution(countsPerRevolutionIn),
+          offset(offsetIn),
+          width(widthIn) {}
   };
 
   /// @brief Configures output and control pins from a typed configuration object.
@@ -39,17 +83,66 @@ class EncoderGenerator {
   /// @return `true` when the configuration is valid for the current target.
   bool begin(const Config& config);
 
-  /// @brief Convenience overload that forwards to @ref begin(const Config&).
+  /// @brief Convenience overload for a generator without rate control (one step per tick).
   bool begin(uint8_t pinA, uint8_t pinB, uint8_t up, uint8_t down, bool usePullup = false,
              bool activeHigh = true);
 
+  /// @brief Adds an index output; call after @ref begin(), which disables it.
+  /// The revolution count restarts from the current position, so revolution 0 holds
+  /// positions `0..countsPerRevolution-1`.
+  /// @return `false` for a pin without an output port or shared with A/B, or an offset or
+  /// width out of range. `countsPerRevolution` 0 disables the index and always succeeds.
+  bool beginIndex(const IndexConfig& config);
+
+  /// @brief Sets the step rate emitted while a direction input is asserted.
+  /// The phase increment is computed here, so the tick only adds and tests the carry. A rate
+  /// equal to the tick rate steps on every tick; 0 holds position while still tracking the
+  /// commanded direction.
+  /// @param stepMilliHz Quadrature steps (edges) per second, in millihertz.
+  /// @return `false` when @ref Config::tickHz was 0 or the rate exceeds the tick rate.
+  bool setStepRateMilliHz(uint32_t stepMilliHz);
+  /// @brief Returns the average step rate the current increment produces, rounded to mHz, or
+  /// 0 without rate control.
+  uint32_t getStepRateMilliHz() const;
+
+  /// @brief Starts a trapezoidal move from rest to @p target; progress shows in
+  /// @ref getPosition().
+  /// All divisions happen here; each tick costs two additions and a few compares.
+  /// @param maxStepsPerSecond Cruise velocity, below @ref Config::tickHz.
+  /// @param accelStepsPerSecond2 Acceleration and deceleration, at most `tickHz^2 / 2`.
+  /// @return `false` without a @ref Config::tickHz, while a move is running, or for a zero or
+  /// out-of-range velocity or acceleration. A move to the current position succeeds at once.
+  bool moveTo(int32_t target, uint16_t maxStepsPerSecond, uint32_t accelStepsPerSecond2);
+  /// @brief Decelerates a running move to rest at its acceleration, ending early when the
+  /// target is closer than the stopping distance.
+  void stopMove();
+  /// @brief Returns true while a move is running.
+  bool isMoving() const;
+  /// @brief Returns the position the running or last move ends on.
+  int32_t getMoveTarget() const;
+
   /// @brief Advances the generated waveform by one step from ISR context.
   void onTick();
+  /// @brief Advances the generated waveform using direction inputs from a tick-wide snapshot.
+  /// @param ports Input levels captured once at the start of the tick.
+  void onTick(const PortSnapshot& ports);
+
+  /// @brief Posts @ref TICK_EVENT_DIRECTION_CHANGED to @p queue whenever
+  /// @ref onTick(const PortSnapshot&) reverses direction; pass null to stop posting.
+  /// @param queue Queue owned by the caller; it must outlive the generator.
+  /// @param source Id copied into every posted event.
+  void setEventQueue(TickEventQueue* queue, uint8_t source = 0);
 
   /// @brief Returns the absolute generated position count.
   /// The count is relative to startup or the most recent @ref reset() call.
-  /// It saturates at the `int32_t` limits instead of wrapping.
+  /// It saturates at the `int32_t` limits instead of wrapping. Read without masking
+  /// interrupts; the copy is retried if a tick steps the position mid-read.
   int32_t getPosition();
+  /// @brief Returns the position together with its revolution, read as one consistent pair.
+  /// @param revolutions Set to `floor(position / countsPerRevolution)`, or 0 without an index.
+  int32_t getPosition(int32_t& revolutions);
+  /// @brief Returns the revolution the position is in, or 0 without an index.
+  int32_t getRevolutions();
   /// @brief Returns the last generated direction.
   bool getDirection();
   /// @brief Resets waveform state and absolute position to the idle state.
@@ -74,6 +167,66 @@ class EncoderGenerator {
   bool _activeHigh = true;
   volatile int32_t _position = 0;
   volatile bool _directionUp = true;
+  uint8_t _upPort = 0;
+  uint8_t _downPort = 0;
+  TickEventQueue* _eventQueue = nullptr;
+  uint8_t _eventSource = 0;
+
+  SeqLock _positionLock;
+
+  void step(bool upHigh, bool downHigh);
+
+  uint16_t _tickHz = 0;
+  // Every tick steps when set; otherwise a step is due on each carry out of _phase.
+  bool _fullRate = true;
+  uint32_t _stepIncrement = 0;
+  uint32_t _phase = 0;
+
+  bool stepDue();
+
+  enum MoveState : uint8_t { MOVE_IDLE = 0, MOVE_ACCEL, MOVE_CRUISE, MOVE_DECEL };
+
+  // Move profile. The velocity is a phase increment (Q32 steps per tick) with a 16-bit
+  // fraction below it, so slow ramps still accelerate; the acceleration is split the same way.
+  volatile MoveState _moveState = MOVE_IDLE;
+  bool _moveUp = true;
+  int32_t _moveTarget = 0;
+  uint32_t _moveRemaining = 0;
+  // Steps taken while accelerating; deceleration starts when no more steps than this remain.
+  uint32_t _rampSteps = 0;
+  uint32_t _velocity = 0;
+  uint16_t _velocityFraction = 0;
+  uint32_t _maxVelocity = 0;
+  // Velocity at the first step, kept as a floor so the ramp down cannot stall short.
+  uint32_t _minVelocity = 0;
+  uint32_t _accel = 0;
+  uint16_t _accelFraction = 0;
+
+  void runMove();
+  void emitStep(bool up);
+
+  // A/B/Z outputs grouped by port so each step writes each port once.
+  static const uint8_t OUTPUT_SLOTS = 3;
+  uint8_t _outSlotCount = 0;
+  volatile uint8_t* _outPort[OUTPUT_SLOTS] = {nullptr};
+  uint8_t _outMask[OUTPUT_SLOTS] = {0};
+  uint8_t _outMaskA[OUTPUT_SLOTS] = {0};
+  uint8_t _outMaskB[OUTPUT_SLOTS] = {0};
+  uint8_t _outMaskZ[OUTPUT_SLOTS] = {0};
+
+  // Index: 0 counts per revolution means no Z output. Count and revolution are published
+  // under _positionLock together with the position.
+  uint8_t _pinZ = 255;
+  volatile uint8_t* _portZOut = nullptr;
+  uint8_t _maskZ = 0;
+  uint16_t _countsPerRevolution = 0;
+  uint16_t _indexOffset = 0;
+  uint16_t _indexWidth = 0;
+  uint16_t _revolutionCount = 0;
+  int32_t _revolutions = 0;
+
+  void groupOutputs();
+  void writeOutputs();
 };
 
 // No global instance here — create an instance in your `main.cpp` as needed.
@@ -0,0 +1,104 @@
+/// @file event_queue.h
+/// @brief Fixed-capacity single-producer/single-consumer queue for ISR-to-loop events.
+#ifndef IOFUSION_EVENT_QUEUE_H
+#define IOFUSION_EVENT_QUEUE_H
+
+#include <Arduino.h>
+
+/// @brief Lock-free ring buffer with one ISR producer and one loop-side consumer.
+///
+/// Indices are free-running bytes: the producer only writes the head, the consumer only
+/// writes the tail, and both are single-byte stores on AVR, so neither side disables
+/// interrupts. Items pushed while the queue is full are dropped and counted.
+/// @tparam T Trivially copyable item type.
+/// @tparam CAPACITY Number of slots; a power of two in the range 2..128.
+template <typename T, uint8_t CAPACITY>
+class EventQueue {
+  static_assert(CAPACITY >= 2 && CAPACITY <= 128 && (CAPACITY & (CAPACITY - 1)) == 0,
+                "EventQueue capacity must be a power of two between 2 and 128.");
+
+ public:
+  /// @brief Appends one item. Call from the single producer context only.
+  /// @return `false` when the queue was full and the item was dropped.
+  bool push(const T& item) {
+    uint8_t head = _head;
+    if (static_cast<uint8_t>(head - _tail) >= CAPACITY) {
+      if (_dropped != 0xFFFFU) ++_dropped;
+      return false;
+    }
+    _items[head & (CAPACITY - 1)] = item;
+    // The slot must be fully written before the consumer can observe the new head.
+    __asm__ __volatile__("" ::: "memory");
+    _head = static_cast<uint8_t>(head + 1U);
+    return true;
+  }
+
+  /// @brief Removes the oldest item. Call from the single consumer context only.
+  /// @return `false` when the queue is empty.
+  bool pop(T& item) {
+    uint8_t tail = _tail;
+    if (tail == _head) return false;
+    item = _items[tail & (CAPACITY - 1)];
+    // Release the slot only after it has been copied out.
+    __asm__ __volatile__("" ::: "memory");
+    _tail = static_cast<uint8_t>(tail + 1U);
+    return true;
+  }
+
+  /// @brief Returns the number of queued items.
+  uint8_t size() const { return static_cast<uint8_t>(_head - _tail); }
+  /// @brief Returns true when no items are queued.
+  bool isEmpty() const { return _head == _tail; }
+  /// @brief Returns the slot count fixed at compile time.
+  static constexpr uint8_t capacity() { return CAPACITY; }
+
+  /// @brief Returns the number of items dropped because the queue was full.
+  /// The count saturates at 65535. The two-byte value is re-read until stable instead of
+  /// disabling interrupts.
+  uint16_t getDroppedCount() const {
+    uint16_t v = _dropped;
+    uint16_t check = _dropped;
+    while (v != check) {
+      v = check;
+      check = _dropped;
+    }
+    return v;
+  }
+
+ private:
+  T _items[CAPACITY];
+  volatile uint8_t _head = 0;
+  volatile uint8_t _tail = 0;
+  volatile uint16_t _dropped = 0;
+};
+
+/// @brief Event codes posted by IOFusion components.
+enum TickEventCode : uint8_t {
+  /// A DigitalInputMonitor window completed; `value` is the number of samples in it.
+  TICK_EVENT_WINDOW_READY = 1,
+  /// A DigitalInputMonitor tick was dropped because the completed window was not drained yet.
+  /// Posted once per window, on the first dropped tick.
+  TICK_EVENT_WINDOW_OVERRUN = 2,
+  /// EncoderGenerator changed direction; `value` is 1 for UP and 0 for DOWN.
+  TICK_EVENT_DIRECTION_CHANGED = 3,
+};
+
+/// @brief Timestamped event record posted from tick context.
+struct TickEvent {
+  /// Timer2 tick index (@ref PortSnapshot::tick) at which the event occurred.
+  uint32_t tick = 0;
+  /// Caller-assigned source id, set when the queue is attached to a component.
+  uint8_t source = 0;
+  /// One of @ref TickEventCode.
+  uint8_t code = 0;
+  /// Code-specific payload.
+  uint16_t value = 0;
+};
+
+/// Slot count of the shared tick-event queue used by IOFusion components.
+static const uint8_t TICK_EVENT_QUEUE_CAPACITY = 8;
+
+/// Queue type accepted by component `setEventQueue()` methods.
+typedef EventQueue<TickEvent, TICK_EVENT_QUEUE_CAPACITY> TickEventQueue;
+
+#endif  // IOFUSION_EVENT_QUEUE_H
@@ -0,0 +1,55 @@
+/// @file frame_codec.h
+/// @brief Builds COBS-framed binary records with a sequence number and CRC-16.
+#ifndef IOFUSION_FRAME_CODEC_H
+#define IOFUSION_FRAME_CODEC_H
+
+#include <Arduino.h>
+
+/// @brief Assembles one binary record and encodes it for a byte stream.
+///
+/// A record is a type byte, a sequence byte and a little-endian payload, followed by a CRC-16
+/// of those bytes (CRC-16/MCRF4XX: reflected polynomial 0x8408, initial value 0xFFFF, no final
+/// XOR; the same CRC as avr-libc's `_crc_ccitt_update()`), low byte first. @ref finish() COBS
+/// encodes the record and brackets it with zero bytes, so a receiver can resynchronise on any
+/// zero and never sees one inside a frame. Text lines on the same link never contain a zero
+/// byte, so they stay separable from frames.
+///
+/// The payload is staged in a fixed buffer; put calls that would overflow it are dropped and
+/// make @ref finish() fail, so a record is either complete or not sent.
+class FrameEncoder {
+ public:
+  /// Maximum payload bytes per record.
+  static const uint8_t MAX_PAYLOAD = 96;
+  /// Maximum bytes @ref finish() writes: record, CRC, one COBS overhead byte and two zeros.
+  static const uint8_t MAX_ENCODED = MAX_PAYLOAD + 2 + 2 + 1 + 2;
+
+  /// @brief Starts a record, discarding any payload staged so far.
+  void begin(uint8_t type, uint8_t sequence);
+  /// @brief Appends payload bytes in little-endian order.
+  /// @return `false` when the payload would exceed @ref MAX_PAYLOAD.
+  bool putU8(uint8_t value);
+  bool putU16(uint16_t value);
+  bool putU32(uint32_t value);
+  bool putI32(int32_t value);
+  /// @brief Returns the number of payload bytes staged.
+  uint8_t getPayloadLength() const;
+
+  /// @brief Writes the encoded frame into @p out, which must hold @ref MAX_ENCODED bytes.
+  /// @return Encoded length including both zero delimiters, or 0 when a put overflowed.
+  uint8_t finish(uint8_t* out);
+
+  /// @brief Folds @p length bytes into @p crc (start from 0xFFFF).
+  static uint16_t crc16(uint16_t crc, const uint8_t* data, uint8_t length);
+  /// @brief COBS-encodes @p length bytes of @p in into @p out without delimiters.
+  /// @p length must be at most 253; @p out must hold `length + 1` bytes.
+  /// @return Encoded length.
+  static uint8_t cobsEncode(const uint8_t* in, uint8_t length, uint8_t* out);
+
+ private:
+  // Type, sequence, payload, then room for the CRC when finishing.
+  uint8_t _record[2 + MAX_PAYLOAD + 2] = {0};
+  uint8_t _length = 0;
+  bool _overflow = false;
+};
+
+#endif  // IOFUSION_FRAME_CODEC_H
@@ -0,0 +1,127 @@
+/// @file frequency_sweep.h
+/// @brief Step planner for linear and logarithmic square-wave frequency sweeps on Timer1.
+#ifndef IOFUSION_FREQUENCY_SWEEP_H
+#define IOFUSION_FREQUENCY_SWEEP_H
+
+#include <Arduino.h>
+
+/// @brief Walks a frequency sweep one step at a time and resolves each step to a Timer1
+/// CTC half-period (compare TOP and prescaler).
+///
+/// The sweep visits `steps + 1` frequencies from start to stop, each held for `1 / stepHz`
+/// seconds. Frequencies are tracked in Q16 hertz: a linear sweep adds a fixed increment per
+/// step and a logarithmic sweep multiplies by a fixed ratio, and the last step lands exactly
+/// on the stop frequency. Step timing is measured in input clocks from the half-periods
+/// actually played (@ref onHalfPeriod()), so the average step rate is exact and steps change
+/// only on output edges.
+///
+/// All divisions except one per step happen in @ref begin(). @ref advance() resolves the
+/// following step with one or two 32-bit divisions, so it is safe to call from an ISR right
+/// after the prepared step has been written to the timer.
+class FrequencySweep {
+ public:
+  /// Highest sweep endpoint, in millihertz (the Q16 hertz range).
+  static const uint32_t MAX_FREQUENCY_MILLIHZ = 65535000UL;
+  /// Highest step rate, in steps per second.
+  static const uint16_t MAX_STEP_HZ = 1000;
+
+  /// @brief How the frequency moves between steps.
+  enum Shape : uint8_t {
+    /// Equal frequency increments per step.
+    LINEAR = 0,
+    /// Equal frequency ratios per step (constant steps per octave).
+    LOGARITHMIC = 1,
+  };
+
+  /// @brief Timer1 CTC setting for one sweep step.
+  struct Step {
+    /// Compare TOP; each half-period of the output is `top + 1` timer counts.
+    uint16_t top;
+    /// Timer1 clock-select bits (`CS12:0`, 1..5).
+    uint8_t clockSelect;
+    /// Input-clock cycles per half-period.
+    uint32_t halfPeriodClocks;
+  };
+
+  /// @brief Startup configuration for FrequencySweep.
+  struct Config {
+    /// First frequency, in millihertz (1..MAX_FREQUENCY_MILLIHZ).
+    uint32_t startMilliHz = 0;
+    /// Last frequency, in millihertz; may be below @ref startMilliHz for a downward sweep.
+    uint32_t stopMilliHz = 0;
+    /// Frequency changes from start to stop (at least 1).
+    uint16_t steps = 100;
+    /// Steps per second (1..MAX_STEP_HZ).
+    uint16_t stepHz = 100;
+    /// Linear or logarithmic spacing.
+    Shape shape = LINEAR;
+    /// When true, the sweep jumps back to the start after holding the stop frequency.
+    bool repeat = false;
+
+    Config() = default;
+    Config(uint32_t startMilliHzIn, uint32_t stopMilliHzIn, uint16_t stepsIn, uint16_t stepHzIn,
+           Shape shapeIn, bool repeatIn)
+        : startMilliHz(startMilliHzIn),
+          stopMilliHz(stopMilliHzIn),
+          steps(stepsIn),
+          stepHz(stepHzIn),
+          shape(shapeIn),
+          repeat(repeatIn) {}
+  };
+
+  /// @brief Constructs an idle sweep.
+  FrequencySweep();
+
+  /// @brief Plans the sweep and makes the start frequency the current step.
+  /// @param clockHz Timer input clock in hertz (at most 33554431).
+  /// @param minHalfPeriodClocks Shortest half-period, in input clocks, either endpoint may use.
+  /// @return `false` when a frequency, `steps` or `stepHz` is out of range, either endpoint
+  /// does not fit Timer1 or is shorter than @p minHalfPeriodClocks, or a logarithmic step
+  /// would change the frequency by a factor of 16 or more.
+  bool begin(const Config& config, uint32_t clockHz, uint32_t minHalfPeriodClocks);
+
+  /// @brief Returns the step being played.
+  const Step& current() const;
+  /// @brief Returns the prepared next step; valid while @ref hasNext() is true.
+  const Step& next() const;
+  /// @brief Returns false once a non-repeating sweep holds its stop frequency.
+  bool hasNext() const;
+
+  /// @brief Accounts one elapsed half-period of the current step.
+  /// @return true when the next step is due.
+  bool onHalfPeriod();
+  /// @brief Makes the prepared step current and prepares the one after it.
+  /// @return `false` when the new current step is the last one (the sweep then holds it) or
+  /// when no step was prepared.
+  bool advance();
+
+  /// @brief Returns the index of the current step, `0..steps`.
+  uint16_t getStepIndex() const;
+  /// @brief Returns the input clocks each step is held for.
+  uint32_t getDwellClocks() const;
+
+ private:
+  uint32_t _clockQ7 = 0;
+  uint32_t _startQ16 = 0;
+  uint32_t _stopQ16 = 0;
+  // Frequency of the prepared step in Q16 hertz, and its index.
+  uint32_t _nextQ16 = 0;
+  uint16_t _nextIndex = 0;
+  uint16_t _currentIndex = 0;
+  uint16_t _steps = 0;
+  // Per-step change: signed Q16 hertz increment, or Q28 ratio for logarithmic sweeps.
+  int32_t _deltaQ16 = 0;
+  uint32_t _ratioQ28 = 0;
+  Shape _shape = LINEAR;
+  bool _repeat = false;
+  bool _hasNext = false;
+  uint32_t _dwellClocks = 0;
+  uint32_t _elapsedClocks = 0;
+  Step _current = {0, 0, 0};
+  Step _next = {0, 0, 0};
+
+  bool stepFor(uint32_t frequencyQ16, Step& step) const;
+  bool prepareNext();
+};
+
+#endif  // IOFUSION_FREQUENCY_SWEEP_H
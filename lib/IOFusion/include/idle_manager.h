@@ -0,0 +1,68 @@
+/// @file idle_manager.h
+/// @brief Loop-side AVR idle sleep with idle-time accounting.
+#ifndef IOFUSION_IDLE_MANAGER_H
+#define IOFUSION_IDLE_MANAGER_H
+
+#include <Arduino.h>
+
+/// @brief Puts the CPU into idle sleep between loop passes that found no work.
+///
+/// Idle sleep stops only the CPU clock: timers, USART and ADC keep running, and any enabled
+/// interrupt (Timer2 compare, USART RX, ADC complete, the `millis()` timer, ...) wakes the
+/// core. Time spent asleep is measured with `micros()` and reported as an idle fraction per
+/// sampling interval, which doubles as a CPU-utilization metric for the whole loop. The
+/// handler of the interrupt that ends each sleep is counted as idle time; the Timer2 load
+/// sample reports the tick ISR share separately.
+class IdleManager {
+ public:
+  /// @brief Returns true when an ISR has left work for `loop()`. Called with interrupts
+  /// disabled, so it must only read flags and must not block.
+  typedef bool (*PendingWorkFn)();
+
+  /// @brief Startup configuration for IdleManager.
+  struct Config {
+    /// Enters idle sleep when true; when false @ref idle() returns immediately (busy loop).
+    bool sleepEnabled = true;
+    /// Length of one idle-fraction sampling interval in milliseconds (1..60000).
+    uint16_t sampleMs = 1000;
+
+    Config() = default;
+    Config(bool sleepEnabledIn, uint16_t sampleMsIn)
+        : sleepEnabled(sleepEnabledIn), sampleMs(sampleMsIn) {}
+  };
+
+  /// @brief Constructs a manager with sleep disabled until @ref begin() succeeds.
+  IdleManager();
+
+  /// @brief Applies the configuration and starts the first sampling interval.
+  /// @return `false` when `sampleMs` is out of range.
+  bool begin(const Config& config);
+
+  /// @brief Sleeps until the next interrupt unless @p pending reports work. Call from loop
+  /// context once per pass, after all components were serviced.
+  /// @param pending Checked with interrupts disabled immediately before sleeping, so a flag
+  /// set by an ISR after the loop pass cannot be slept through; may be null.
+  /// @return `true` when the CPU actually slept.
+  bool idle(PendingWorkFn pending);
+
+  /// @brief Closes the sampling interval once `sampleMs` has elapsed.
+  /// @return `true` when a new idle fraction was published.
+  bool update();
+
+  /// @brief Returns the fraction of the last completed interval spent asleep, in permille.
+  uint16_t getIdlePermille() const;
+  /// @brief Returns the number of sleeps since @ref begin(), saturating at `UINT32_MAX`.
+  uint32_t getSleepCount() const;
+  /// @brief Returns true when idle sleep is enabled.
+  bool isSleepEnabled() const;
+
+ private:
+  Config _config;
+  bool _ready = false;
+  unsigned long _intervalStartUs = 0;
+  uint32_t _idleUs = 0;
+  uint16_t _idlePermille = 0;
+  uint32_t _sleepCount = 0;
+};
+
+#endif  // IOFUSION_IDLE_MANAGER_H
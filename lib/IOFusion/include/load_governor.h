@@ -0,0 +1,75 @@
+/// @file load_governor.h
+/// @brief Hysteretic shed-level governor driven by measured ISR utilization.
+#ifndef IOFUSION_LOAD_GOVERNOR_H
+#define IOFUSION_LOAD_GOVERNOR_H
+
+#include <Arduino.h>
+
+/// @brief Tracks ISR utilization and selects how much optional tick work to shed.
+///
+/// The governor only decides a shed level; the application maps each level to concrete
+/// work reductions (lower request rates, skipped ticks, ...). Levels rise one step per
+/// overloaded sample and fall one step after a run of quiet samples, so short bursts shed
+/// quickly while recovery does not oscillate.
+class LoadGovernor {
+ public:
+  /// Highest shed level supported by the governor.
+  static const uint8_t MAX_LEVEL = 3;
+
+  /// @brief Startup configuration for LoadGovernor.
+  struct Config {
+    /// Utilization in permille at or above which one more level is shed.
+    uint16_t shedAbovePermille = 800;
+    /// Utilization in permille at or below which a sample counts as quiet.
+    uint16_t restoreBelowPermille = 500;
+    /// Consecutive quiet samples required before one level is restored.
+    uint8_t restoreSamples = 4;
+    /// Highest level the governor may reach, in the range 1..MAX_LEVEL.
+    uint8_t maxLevel = MAX_LEVEL;
+
+    Config() = default;
+    Config(uint16_t shedAbovePermilleIn, uint16_t restoreBelowPermilleIn, uint8_t restoreSamplesIn,
+           uint8_t maxLevelIn)
+        : shedAbovePermille(shedAbovePermilleIn),
+          restoreBelowPermille(restoreBelowPermilleIn),
+          restoreSamples(restoreSamplesIn),
+          maxLevel(maxLevelIn) {}
+  };
+
+  /// @brief Constructs a governor at level 0 with the default thresholds.
+  LoadGovernor();
+
+  /// @brief Applies thresholds and resets the governor to level 0.
+  /// @param config Shed/restore thresholds and level limit.
+  /// @return `true` when `restoreBelowPermille < shedAbovePermille <= 1000`, `restoreSamples`
+  /// is non-zero, and `maxLevel` is in range.
+  bool begin(const Config& config);
+
+  /// @brief Feeds one utilization sample from loop context.
+  /// @param utilizationPermille ISR utilization of the sampled interval.
+  /// @param overrunTicks Ticks in the interval whose dispatch overran the period; any
+  /// overrun counts as an overloaded sample regardless of utilization.
+  /// @return `true` when the shed level changed.
+  bool update(uint16_t utilizationPermille, uint16_t overrunTicks = 0);
+
+  /// @brief Returns the current shed level. Safe to call from ISR context.
+  uint8_t getLevel() const;
+  /// @brief Returns the level that was active before the most recent transition.
+  uint8_t getPreviousLevel() const;
+  /// @brief Returns the utilization passed to the most recent @ref update() call.
+  uint16_t getUtilizationPermille() const;
+  /// @brief Returns the number of level transitions since @ref begin().
+  uint32_t getTransitionCount() const;
+
+ private:
+  Config _config;
+  volatile uint8_t _level = 0;
+  uint8_t _previousLevel = 0;
+  uint8_t _quietSamples = 0;
+  uint16_t _utilizationPermille = 0;
+  uint32_t _transitionCount = 0;
+
+  void setLevel(uint8_t level);
+};
+
+#endif  // IOFUSION_LOAD_GOVERNOR_H
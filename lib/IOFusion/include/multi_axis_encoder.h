@@ -0,0 +1,139 @@
+/// @file multi_axis_encoder.h
+/// @brief Quadrature outputs for several emulated axes with one output write per port.
+#ifndef IOFUSION_MULTI_AXIS_ENCODER_H
+#define IOFUSION_MULTI_AXIS_ENCODER_H
+
+#include <Arduino.h>
+
+#include "port_snapshot.h"
+#include "seqlock.h"
+
+/// @brief Generates quadrature A/B outputs for up to @ref MAX_AXES axes from up/down inputs.
+///
+/// Each axis behaves like an @ref EncoderGenerator without the index and motion profile:
+/// one step per tick while a direction input is asserted, or a lower rate paced by a 32-bit
+/// phase accumulator. Instead of a read-modify-write per output pin, @ref onTick() first
+/// advances every axis into an ISR-owned copy of the output bits per port, then stores each
+/// changed port once. ISR time therefore grows with the number of ports touched, not with
+/// `2 * axes`, and outputs of axes on the same port change together.
+///
+/// Output ports are written with read-modify-write, so other pins on those ports must only
+/// be written with interrupts masked (as `digitalWrite()` does) while the tick runs.
+class MultiAxisEncoder {
+ public:
+  /// Maximum number of axes.
+  static const uint8_t MAX_AXES = 4;
+  /// Maximum number of distinct output ports the A/B pins may span.
+  static const uint8_t MAX_PORTS = 4;
+
+  /// @brief Pins of one axis.
+  struct Axis {
+    /// Quadrature channel A output pin.
+    uint8_t pinA = 255;
+    /// Quadrature channel B output pin.
+    uint8_t pinB = 255;
+    /// Direction control input that advances the axis.
+    uint8_t upPin = 255;
+    /// Direction control input that reverses the axis.
+    uint8_t downPin = 255;
+
+    Axis() = default;
+    Axis(uint8_t pinAIn, uint8_t pinBIn, uint8_t upPinIn, uint8_t downPinIn)
+        : pinA(pinAIn), pinB(pinBIn), upPin(upPinIn), downPin(downPinIn) {}
+  };
+
+  /// @brief Startup configuration for MultiAxisEncoder.
+  struct Config {
+    /// Axis pins, one entry per axis.
+    const Axis* axes = nullptr;
+    /// Number of entries in @ref axes (1..MAX_AXES).
+    uint8_t axisCount = 0;
+    /// Enables INPUT_PULLUP on the direction inputs when true.
+    bool usePullup = false;
+    /// Interprets asserted direction inputs as HIGH when true, LOW when false.
+    bool activeHigh = true;
+    /// Rate at which the tick calls @ref onTick(), in hertz; 0 disables
+    /// @ref setStepRateMilliHz() and keeps one step per tick on every axis.
+    uint16_t tickHz = 0;
+
+    Config() = default;
+    Config(const Axis* axesIn, uint8_t axisCountIn, bool usePullupIn = false,
+           bool activeHighIn = true, uint16_t tickHzIn = 0)
+        : axes(axesIn),
+          axisCount(axisCountIn),
+          usePullup(usePullupIn),
+          activeHigh(activeHighIn),
+          tickHz(tickHzIn) {}
+  };
+
+  /// @brief Constructs an idle generator with no axes.
+  MultiAxisEncoder();
+
+  /// @brief Resolves ports and masks, drives every A/B output LOW and zeroes all positions.
+  /// @return `false` for a null axis list, a count outside 1..MAX_AXES, a pin without a
+  /// port, an output pin used twice, or A/B outputs spanning more than @ref MAX_PORTS ports.
+  bool begin(const Config& config);
+
+  /// @brief Sets the step rate of one axis while its direction input is asserted.
+  /// Same contract as EncoderGenerator::setStepRateMilliHz().
+  /// @return `false` for an invalid axis, without @ref Config::tickHz, or above the tick rate.
+  bool setStepRateMilliHz(uint8_t axis, uint32_t stepMilliHz);
+  /// @brief Returns the average step rate of @p axis, rounded to mHz, or 0 without rate
+  /// control or for an invalid axis.
+  uint32_t getStepRateMilliHz(uint8_t axis) const;
+
+  /// @brief Advances every axis using direction inputs from a tick-wide snapshot.
+  /// Call from the tick ISR only.
+  void onTick(const PortSnapshot& ports);
+  /// @brief Captures the input ports and advances every axis. Call from the tick ISR only.
+  void onTick();
+
+  /// @brief Returns the position of @p axis (0 when invalid), saturating at `int32_t` limits.
+  int32_t getPosition(uint8_t axis);
+  /// @brief Copies the positions of the first @p maxCount axes, all from the same tick.
+  /// @return Number of positions written.
+  uint8_t getPositions(int32_t* positions, uint8_t maxCount);
+  /// @brief Returns the last commanded direction of @p axis (true when invalid).
+  bool getDirection(uint8_t axis) const;
+  /// @brief Returns the number of configured axes.
+  uint8_t getAxisCount() const;
+  /// @brief Returns every axis to position 0 with both outputs LOW.
+  void reset();
+
+ private:
+  struct AxisState {
+    // Output slots (indexes into _portOut) and bit masks.
+    uint8_t slotA;
+    uint8_t maskA;
+    uint8_t slotB;
+    uint8_t maskB;
+    // Direction inputs as PortSnapshot indexes and masks.
+    uint8_t upPort;
+    uint8_t upMask;
+    uint8_t downPort;
+    uint8_t downMask;
+    uint8_t state;
+    // Every asserted tick steps when set; otherwise a step is due on each carry out of phase.
+    bool fullRate;
+    uint32_t increment;
+    uint32_t phase;
+  };
+
+  uint8_t _axisCount = 0;
+  uint8_t _portCount = 0;
+  bool _activeHigh = true;
+  uint16_t _tickHz = 0;
+  volatile uint8_t* _portOut[MAX_PORTS] = {nullptr};
+  // Every A/B bit on each port, and the ISR's copy of their levels.
+  uint8_t _portMask[MAX_PORTS] = {0};
+  uint8_t _portLevel[MAX_PORTS] = {0};
+  AxisState _axes[MAX_AXES];
+  // Bit per axis, set while the axis was last commanded up.
+  volatile uint8_t _directionUp = 0;
+  volatile int32_t _position[MAX_AXES] = {0};
+  SeqLock _positionLock;
+
+  void writePorts(uint8_t slots);
+};
+
+#endif  // IOFUSION_MULTI_AXIS_ENCODER_H
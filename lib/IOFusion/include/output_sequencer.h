@@ -0,0 +1,123 @@
+/// @file output_sequencer.h
+/// @brief Tick-timed digital output patterns and one-shot pulses.
+#ifndef IOFUSION_OUTPUT_SEQUENCER_H
+#define IOFUSION_OUTPUT_SEQUENCER_H
+
+#include <Arduino.h>
+
+/// @brief Plays timed output patterns on up to @ref MAX_CHANNELS pins from a periodic tick.
+///
+/// A sequence is a list of events, each giving a tick offset and the levels of a subset of
+/// channels. @ref play() compiles the list into per-port set and clear masks, so @ref onTick()
+/// only compares the tick counter with the next offset and, when it matches, stores each
+/// affected port once. A sequence can play once or loop with a fixed length in ticks.
+///
+/// Independently of the sequence, @ref pulse() drives one channel to a level for an exact
+/// number of ticks and then back. Pulse edges land on ticks, so their width is exact to the
+/// tick and their jitter is the tick ISR's latency rather than the host link's.
+///
+/// Output ports are updated with read-modify-write, so other pins on the same ports must only
+/// be written with interrupts masked (as `digitalWrite()` does) while the tick runs.
+class OutputSequencer {
+ public:
+  /// Maximum number of output channels (one bit each in an event mask).
+  static const uint8_t MAX_CHANNELS = 8;
+  /// Maximum number of distinct output ports the channels may span.
+  static const uint8_t MAX_PORTS = 4;
+  /// Maximum number of events in one sequence.
+  static const uint8_t MAX_EVENTS = 16;
+
+  /// @brief Output pins of the sequencer.
+  struct Config {
+    /// Output pins; bit `i` of an event mask refers to `pins[i]`.
+    const uint8_t* pins = nullptr;
+    /// Number of entries in @ref pins (1..MAX_CHANNELS).
+    uint8_t pinCount = 0;
+
+    Config() = default;
+    Config(const uint8_t* pinsIn, uint8_t pinCountIn) : pins(pinsIn), pinCount(pinCountIn) {}
+  };
+
+  /// @brief One step of a sequence.
+  struct Event {
+    /// Ticks from the start of the sequence; events must be in ascending order.
+    uint16_t tick = 0;
+    /// Channels this event drives.
+    uint8_t mask = 0;
+    /// Levels of the driven channels: a set bit drives HIGH.
+    uint8_t values = 0;
+
+    Event() = default;
+    Event(uint16_t tickIn, uint8_t maskIn, uint8_t valuesIn)
+        : tick(tickIn), mask(maskIn), values(valuesIn) {}
+  };
+
+  /// @brief Constructs an idle sequencer with no channels.
+  OutputSequencer();
+
+  /// @brief Resolves port registers and masks and drives every pin LOW.
+  /// @return `false` for a null pin list, a count outside 1..MAX_CHANNELS, a pin without an
+  /// output port, a repeated pin, or more than @ref MAX_PORTS ports.
+  bool begin(const Config& config);
+
+  /// @brief Starts @p events from the next tick, replacing any sequence being played.
+  /// The event at offset `t` is written on the `t`-th tick after the start (offset 0 on the
+  /// first). With @p loop the sequence restarts every @p lengthTicks ticks.
+  /// @return `false` for an empty or too long list, offsets that do not ascend or are not
+  /// below @p lengthTicks, or a mask naming an unconfigured channel.
+  bool play(const Event* events, uint8_t eventCount, uint16_t lengthTicks, bool loop);
+  /// @brief Stops the sequence, leaving the outputs at their current levels.
+  void stop();
+  /// @brief Returns true while a sequence is playing.
+  bool isPlaying() const;
+  /// @brief Returns how many times a looping sequence has wrapped.
+  uint16_t getLoopCount() const;
+
+  /// @brief Drives @p channel to @p high on the next tick and back after @p widthTicks ticks.
+  /// Restarting a running pulse restarts its width. A sequence event on the same channel also
+  /// changes the pin; the pulse still ends on time.
+  /// @return `false` for an invalid channel or a zero width.
+  bool pulse(uint8_t channel, uint16_t widthTicks, bool high = true);
+  /// @brief Returns true while a pulse on @p channel has not ended.
+  bool isPulsing(uint8_t channel) const;
+
+  /// @brief Returns the number of configured channels.
+  uint8_t getChannelCount() const;
+
+  /// @brief Advances one tick. Call from the tick ISR only.
+  void onTick();
+
+ private:
+  struct CompiledEvent {
+    uint16_t tick;
+    uint8_t setMask[MAX_PORTS];
+    uint8_t clearMask[MAX_PORTS];
+  };
+
+  uint8_t _channelCount = 0;
+  uint8_t _portCount = 0;
+  volatile uint8_t* _portOut[MAX_PORTS] = {nullptr};
+  uint8_t _channelPort[MAX_CHANNELS] = {0};
+  uint8_t _channelMask[MAX_CHANNELS] = {0};
+
+  // Sequence, rebuilt only while _playing is false.
+  CompiledEvent _events[MAX_EVENTS];
+  uint8_t _eventCount = 0;
+  uint16_t _length = 0;
+  bool _loop = false;
+  volatile bool _playing = false;
+  uint16_t _tick = 0;
+  uint8_t _nextEvent = 0;
+  volatile uint16_t _loopCount = 0;
+
+  // Pulses: requested starts and the ISR-owned running set, both one bit per channel.
+  volatile uint8_t _pulseStart = 0;
+  volatile uint8_t _pulseRunning = 0;
+  uint8_t _pulseHigh = 0;
+  uint16_t _pulseWidth[MAX_CHANNELS] = {0};
+  uint16_t _pulseRemaining[MAX_CHANNELS] = {0};
+
+  void runPulses(uint8_t* setMask, uint8_t* clearMask);
+};
+
+#endif  // IOFUSION_OUTPUT_SEQUENCER_H
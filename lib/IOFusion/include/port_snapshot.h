@@ -0,0 +1,72 @@
+/// @file port_snapshot.h
+/// @brief One-instant copy of the AVR port input registers shared by ISR consumers.
+#ifndef IOFUSION_PORT_SNAPSHOT_H
+#define IOFUSION_PORT_SNAPSHOT_H
+
+#include <Arduino.h>
+
+/// @brief Input register values for every port, captured back-to-back at the start of a tick.
+///
+/// Entries are indexed by the Arduino port number returned from `digitalPinToPort()`, so a
+/// consumer that cached `port` and `mask` at `begin()` can test a pin with one array read
+/// instead of another I/O register access.
+struct PortSnapshot {
+  /// Number of addressable port slots (`PA`..`PL` map to 1..12 on AVR cores).
+  static const uint8_t MAX_PORTS = 13;
+
+  /// Index of the tick this snapshot belongs to. Timer2Driver advances it once per tick;
+  /// it wraps after 2^32 ticks and is used to timestamp events posted from tick context.
+  uint32_t tick = 0;
+  /// Raw input register value per port number; unused slots read as 0.
+  uint8_t in[MAX_PORTS] = {0};
+
+  /// @brief Reads every available input register into @ref in. @ref tick is left unchanged.
+  /// On AVR this is a run of consecutive `PINx` reads with no table lookups.
+  inline void capture() {
+#if defined(__AVR__)
+#if defined(PINA)
+    in[PA] = PINA;
+#endif
+#if defined(PINB)
+    in[PB] = PINB;
+#endif
+#if defined(PINC)
+    in[PC] = PINC;
+#endif
+#if defined(PIND)
+    in[PD] = PIND;
+#endif
+#if defined(PINE)
+    in[PE] = PINE;
+#endif
+#if defined(PINF)
+    in[PF] = PINF;
+#endif
+#if defined(PING)
+    in[PG] = PING;
+#endif
+#if defined(PINH)
+    in[PH] = PINH;
+#endif
+#if defined(PINJ)
+    in[PJ] = PINJ;
+#endif
+#if defined(PINK)
+    in[PK] = PINK;
+#endif
+#if defined(PINL)
+    in[PL] = PINL;
+#endif
+#else
+    for (uint8_t port = 0; port < MAX_PORTS; ++port) {
+      volatile uint8_t* portIn = portInputRegister(port);
+      in[port] = portIn ? *portIn : 0;
+    }
+#endif
+  }
+
+  /// @brief Returns true when the captured level of the masked pin on @p port is HIGH.
+  inline bool isHigh(uint8_t port, uint8_t mask) const { return (in[port] & mask) != 0; }
+};
+
+#endif  // IOFUSION_PORT_SNAPSHOT_H
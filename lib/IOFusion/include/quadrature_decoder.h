@@ -0,0 +1,155 @@
+/// @file quadrature_decoder.h
+/// @brief Table-driven quadrature input decoder with windowed velocity.
+#ifndef IOFUSION_QUADRATURE_DECODER_H
+#define IOFUSION_QUADRATURE_DECODER_H
+
+#include <Arduino.h>
+
+#include "port_snapshot.h"
+#include "seqlock.h"
+
+/// @brief Counts up to @ref MAX_CHANNELS quadrature encoders from sampled A/B inputs.
+///
+/// Each sample packs the A/B levels of every channel into one byte and looks up the
+/// transition from the previous state in a 16-entry table: no change, one count forward or
+/// back, or an illegal two-bit change, which is counted as an error and leaves the position
+/// alone. A sample with no input change costs one compare for all channels.
+///
+/// Sample from the periodic tick (@ref onTick()), from a pin-change interrupt
+/// (@ref onPinChange()), or both; the tick also times the velocity window. Sampling must see
+/// every state, so the input count rate must stay below the sampling rate.
+///
+/// Position and error counts are ISR-owned and read under a `SeqLock`. Velocity follows the
+/// @ref DigitalInputMonitor frame convention: the tick latches the counts of each completed
+/// window, @ref updateIfReady() publishes them from the loop, and a window that completes
+/// before the previous one was drained marks the frame stale and counts an overrun. Unlike
+/// the monitor, decoding never pauses, so positions stay exact across overruns.
+class QuadratureDecoder {
+ public:
+  /// Maximum number of encoder channels (two input bits each in one state byte).
+  static const uint8_t MAX_CHANNELS = 4;
+
+  /// @brief Input pins of one encoder.
+  struct Channel {
+    /// Quadrature channel A input pin.
+    uint8_t pinA = 255;
+    /// Quadrature channel B input pin.
+    uint8_t pinB = 255;
+
+    Channel() = default;
+    Channel(uint8_t pinAIn, uint8_t pinBIn) : pinA(pinAIn), pinB(pinBIn) {}
+  };
+
+  /// @brief Startup configuration for QuadratureDecoder.
+  struct Config {
+    /// Encoder inputs, one entry per channel.
+    const Channel* channels = nullptr;
+    /// Number of entries in @ref channels (1..MAX_CHANNELS).
+    uint8_t channelCount = 0;
+    /// Number of timer ticks per velocity window.
+    uint16_t windowTicks = 1000;
+    /// Rate at which the tick calls @ref onTick(), in hertz.
+    uint16_t tickHz = 1000;
+    /// Enables INPUT_PULLUP on every input when true (open-collector encoders).
+    bool usePullup = false;
+
+    Config() = default;
+    Config(const Channel* channelsIn, uint8_t channelCountIn, uint16_t windowTicksIn,
+           uint16_t tickHzIn, bool usePullupIn = false)
+        : channels(channelsIn),
+          channelCount(channelCountIn),
+          windowTicks(windowTicksIn),
+          tickHz(tickHzIn),
+          usePullup(usePullupIn) {}
+  };
+
+  /// @brief Snapshot of one coherently copied measurement frame.
+  struct Frame {
+    uint8_t channelCount = 0;
+    uint32_t frameSequence = 0;
+    bool stale = false;
+    uint32_t overrunCount = 0;
+    /// Positions and error counts at the time of the copy.
+    int32_t position[MAX_CHANNELS] = {0};
+    uint32_t errorCount[MAX_CHANNELS] = {0};
+    /// Signed counts in the last published window, and the same as counts per second.
+    int32_t countsPerWindow[MAX_CHANNELS] = {0};
+    int32_t countsPerSecond[MAX_CHANNELS] = {0};
+  };
+
+  /// @brief Constructs an unconfigured decoder.
+  QuadratureDecoder();
+
+  /// @brief Configures inputs, takes the current A/B levels as the starting state and
+  /// zeroes positions, errors and the velocity window.
+  /// @return `false` for a null channel list, a count outside 1..MAX_CHANNELS, a zero window
+  /// or tick rate, a pin without an input port, or a pin used twice.
+  bool begin(const Config& config);
+
+  /// @brief Decodes one sample from a tick-wide port snapshot and advances the window.
+  void onTick(const PortSnapshot& ports);
+  /// @brief Reads the input registers, decodes one sample and advances the window.
+  void onTick();
+  /// @brief Reads the input registers and decodes one sample without advancing the window.
+  /// Call from a pin-change ISR on the A/B pins; it must not nest with the tick ISR.
+  void onPinChange();
+
+  /// @brief Publishes the most recently latched window as velocity. Call from loop context.
+  void updateIfReady();
+  /// @brief Returns true when a completed window is waiting for @ref updateIfReady().
+  bool isWindowReady() const;
+
+  /// @brief Returns the number of configured channels.
+  uint8_t getChannelCount() const;
+  /// @brief Returns the position of @p channel (0 when invalid), saturating at `int32_t`
+  /// limits. Read without masking interrupts.
+  int32_t getPosition(uint8_t channel) const;
+  /// @brief Returns the illegal transitions seen on @p channel, saturating.
+  uint32_t getErrorCount(uint8_t channel) const;
+  /// @brief Returns the counts of @p channel in the last published window.
+  int32_t getCountsPerWindow(uint8_t channel) const;
+  /// @brief Returns the last published velocity of @p channel in counts per second.
+  int32_t getCountsPerSecond(uint8_t channel) const;
+  /// @brief Copies positions, error counts, the published velocities and telemetry.
+  void copyFrame(Frame& frame) const;
+  /// @brief Returns the cumulative count of windows overwritten before being published.
+  uint32_t getOverrunCount() const;
+  /// @brief Zeroes positions and error counts, keeping the current input state.
+  void reset();
+
+ private:
+  uint8_t _channelCount = 0;
+  uint16_t _windowTicks = 1000;
+  uint16_t _tickHz = 1000;
+  // Per input bit (A of channel 0, B of channel 0, A of channel 1, ...): snapshot port index,
+  // input register and mask.
+  uint8_t _inputPort[MAX_CHANNELS * 2];
+  volatile uint8_t* _inputIn[MAX_CHANNELS * 2];
+  uint8_t _inputMask[MAX_CHANNELS * 2];
+
+  // ISR-owned decoder state: two bits per channel, channel 0 in the low bits.
+  uint8_t _lastStates = 0;
+  volatile int32_t _position[MAX_CHANNELS];
+  volatile uint32_t _errorCount[MAX_CHANNELS];
+  volatile uint32_t _overrunCount = 0;
+  SeqLock _countLock;
+
+  // Window accumulation in the ISR and the latched result of the last completed window.
+  int32_t _windowAccum[MAX_CHANNELS];
+  volatile int32_t _windowLatched[MAX_CHANNELS];
+  volatile uint16_t _ticksInWindow = 0;
+  volatile bool _windowReady = false;
+  volatile bool _pendingFrameStale = false;
+
+  // Loop-owned published frame.
+  bool _frameStale = false;
+  uint32_t _frameSequence = 0;
+  int32_t _countsPerWindow[MAX_CHANNELS];
+  int32_t _countsPerSecond[MAX_CHANNELS];
+
+  uint8_t readStates() const;
+  void decode(uint8_t states);
+  void advanceWindow();
+};
+
+#endif  // IOFUSION_QUADRATURE_DECODER_H
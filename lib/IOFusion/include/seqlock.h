@@ -0,0 +1,51 @@
+/// @file seqlock.h
+/// @brief Sequence counter that lets loop-side readers copy ISR-owned data without masking
+/// interrupts.
+#ifndef IOFUSION_SEQLOCK_H
+#define IOFUSION_SEQLOCK_H
+
+#include <Arduino.h>
+
+/// @brief Single-writer sequence lock.
+///
+/// The writer makes the counter odd before it updates the protected fields and even again
+/// afterwards. A reader samples the counter, copies the fields, and retries when the counter
+/// was odd or has moved, so the writer is never delayed by a reader. Readers must run in a
+/// context the writer can preempt (for ISR-owned data: `loop()`); a reader that preempts the
+/// writer would retry forever.
+///
+/// The counter is a single byte so every access is atomic on AVR. It wraps after 128 writes,
+/// far more than can land inside one short copy at any supported tick rate.
+class SeqLock {
+ public:
+  /// @brief Marks the start of an update. Call from the single writer context only.
+  void writeBegin() {
+    _sequence = static_cast<uint8_t>(_sequence + 1U);
+    // Readers must observe the odd count before any protected field changes.
+    __asm__ __volatile__("" ::: "memory");
+  }
+
+  /// @brief Marks the end of an update started with @ref writeBegin().
+  void writeEnd() {
+    __asm__ __volatile__("" ::: "memory");
+    _sequence = static_cast<uint8_t>(_sequence + 1U);
+  }
+
+  /// @brief Returns the counter value to pass to @ref readRetry() after copying.
+  uint8_t readBegin() const {
+    uint8_t sequence = _sequence;
+    __asm__ __volatile__("" ::: "memory");
+    return sequence;
+  }
+
+  /// @brief Returns true when the copy made since @p sequence may be torn and must be redone.
+  bool readRetry(uint8_t sequence) const {
+    __asm__ __volatile__("" ::: "memory");
+    return (sequence & 1U) != 0 || _sequence != sequence;
+  }
+
+ private:
+  volatile uint8_t _sequence = 0;
+};
+
+#endif  // IOFUSION_SEQLOCK_H
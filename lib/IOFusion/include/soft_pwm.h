@@ -0,0 +1,98 @@
+/// @file soft_pwm.h
+/// @brief Tick-driven software PWM on arbitrary digital pins.
+#ifndef IOFUSION_SOFT_PWM_H
+#define IOFUSION_SOFT_PWM_H
+
+#include <Arduino.h>
+
+/// @brief Generates PWM on up to @ref MAX_CHANNELS pins from a periodic tick.
+///
+/// One PWM period is `steps` ticks. Loop-side setters compile the channel levels into a
+/// schedule: one set mask per port applied at step 0, then one clear event per distinct
+/// level, sorted by step, each holding clear masks per port. @ref onTick() therefore writes
+/// whole output ports at the period start and at each distinct level, and otherwise only
+/// compares one byte, so its cost scales with the number of distinct levels rather than
+/// the channel count.
+///
+/// Schedules are double-buffered and swapped at a period boundary, so a level change never
+/// produces a truncated or doubled pulse. Output ports are updated with read-modify-write,
+/// so other pins on the same ports must only be written with interrupts masked (as
+/// `digitalWrite()` does) while the tick runs.
+class SoftPwm {
+ public:
+  /// Maximum number of PWM channels.
+  static const uint8_t MAX_CHANNELS = 12;
+  /// Maximum number of distinct output ports the channels may span.
+  static const uint8_t MAX_PORTS = 4;
+
+  /// @brief Startup configuration for SoftPwm.
+  struct Config {
+    /// Output pins, one per channel.
+    const uint8_t* pins = nullptr;
+    /// Number of entries in @ref pins (1..MAX_CHANNELS).
+    uint8_t pinCount = 0;
+    /// Ticks per PWM period and the number of duty steps (2..255). The PWM frequency is
+    /// `tickHz / steps`.
+    uint8_t steps = 100;
+
+    Config() = default;
+    Config(const uint8_t* pinsIn, uint8_t pinCountIn, uint8_t stepsIn)
+        : pins(pinsIn), pinCount(pinCountIn), steps(stepsIn) {}
+  };
+
+  /// @brief Constructs an idle engine with no channels.
+  SoftPwm();
+
+  /// @brief Resolves port registers and masks, drives every pin LOW and clears all levels.
+  /// @return `false` for a null pin list, a count outside 1..MAX_CHANNELS, `steps < 2`, a
+  /// pin without an output port, a repeated pin, or more than @ref MAX_PORTS ports.
+  bool begin(const Config& config);
+
+  /// @brief Sets a channel's on-time in ticks per period (clamped to `steps`).
+  /// Takes effect at the next period boundary.
+  /// @return `false` for an invalid channel.
+  bool setLevel(uint8_t channel, uint8_t level);
+  /// @brief Sets a channel's duty in permille, rounded to the nearest step.
+  bool setDutyPermille(uint8_t channel, uint16_t permille);
+  /// @brief Returns the level last set for @p channel (0 when invalid).
+  uint8_t getLevel(uint8_t channel) const;
+  /// @brief Returns the ticks per period configured at @ref begin().
+  uint8_t getSteps() const;
+  /// @brief Returns the number of configured channels.
+  uint8_t getChannelCount() const;
+  /// @brief Returns true while a new schedule waits for the next period boundary.
+  bool isUpdatePending() const;
+
+  /// @brief Advances one tick. Call from the tick ISR only.
+  void onTick();
+
+ private:
+  struct Schedule {
+    // Bits driven HIGH at step 0, per port.
+    uint8_t setMask[MAX_PORTS];
+    uint8_t eventCount;
+    // Ascending steps at which some channels go LOW, and the bits cleared per port.
+    uint8_t eventStep[MAX_CHANNELS];
+    uint8_t clearMask[MAX_CHANNELS][MAX_PORTS];
+  };
+
+  uint8_t _channelCount = 0;
+  uint8_t _steps = 0;
+  uint8_t _portCount = 0;
+  volatile uint8_t* _portOut[MAX_PORTS] = {nullptr};
+  // Every channel bit on each port; the step-0 write replaces exactly these bits.
+  uint8_t _portMask[MAX_PORTS] = {0};
+  uint8_t _channelPort[MAX_CHANNELS] = {0};
+  uint8_t _channelMask[MAX_CHANNELS] = {0};
+  uint8_t _level[MAX_CHANNELS] = {0};
+
+  Schedule _schedules[2];
+  volatile uint8_t _activeSchedule = 0;
+  volatile bool _swapPending = false;
+  uint8_t _step = 0;
+  uint8_t _nextEvent = 0;
+
+  void rebuild();
+};
+
+#endif  // IOFUSION_SOFT_PWM_H
@@ -0,0 +1,107 @@
+/// @file step_ramp.h
+/// @brief Precomputed acceleration table for step/direction moves on Timer1.
+#ifndef IOFUSION_STEP_RAMP_H
+#define IOFUSION_STEP_RAMP_H
+
+#include <Arduino.h>
+
+/// @brief Plans a trapezoidal step move as one Timer1 TOP per step period.
+///
+/// A move of `steps` pulses starts at `startHz`, accelerates at a constant rate to `maxHz`,
+/// cruises, and decelerates symmetrically so the last pulse is again at `startHz`. A move too
+/// short to reach `maxHz` turns into a triangle. The step rate after `n` steps of the ramp is
+/// `sqrt(startHz^2 + 2 * accel * n)`.
+///
+/// @ref begin() does all of the math: it picks one prescaler for the whole move from the
+/// slowest period and fills a table of at most @ref MAX_ENTRIES TOP values. Longer ramps hold
+/// each entry for `stride` consecutive steps, evaluated at the middle of its steps. @ref next()
+/// then walks the table forward while accelerating and backward while decelerating using only
+/// counters and compares, so it is cheap enough to call from the overflow ISR once per step.
+class StepRamp {
+ public:
+  /// Number of TOP values the ramp table holds.
+  static const uint8_t MAX_ENTRIES = 64;
+
+  /// @brief Startup configuration for StepRamp.
+  struct Config {
+    /// Pulses in the move (at least 1).
+    uint32_t steps = 0;
+    /// Step rate of the first and last pulse, in steps per second (1..maxHz). The slowest
+    /// rate played (this, or @ref maxHz without acceleration) must fit Timer1 at clk/64, which
+    /// at 16 MHz means at least 4 steps/s.
+    uint16_t startHz = 0;
+    /// Cruise step rate, in steps per second.
+    uint16_t maxHz = 0;
+    /// Acceleration and deceleration, in steps per second squared; 0 moves at @ref maxHz
+    /// throughout.
+    uint32_t accelHzPerSecond = 0;
+    /// Width of each step pulse, in microseconds (at least 1).
+    uint8_t pulseWidthUs = 3;
+
+    Config() = default;
+    Config(uint32_t stepsIn, uint16_t startHzIn, uint16_t maxHzIn, uint32_t accelHzPerSecondIn,
+           uint8_t pulseWidthUsIn = 3)
+        : steps(stepsIn),
+          startHz(startHzIn),
+          maxHz(maxHzIn),
+          accelHzPerSecond(accelHzPerSecondIn),
+          pulseWidthUs(pulseWidthUsIn) {}
+  };
+
+  /// @brief Constructs an empty plan.
+  StepRamp();
+
+  /// @brief Plans the move and rewinds it to the first step.
+  /// @param clockHz Timer input clock in hertz.
+  /// @param minPeriodClocks Shortest step period, in input clocks, the cruise rate may use.
+  /// @return `false` when a field is out of range, the start period does not fit Timer1 at
+  /// clk/64 or faster (at 16 MHz, start rates below 4 steps/s), the cruise period is shorter
+  /// than @p minPeriodClocks, or the pulse does not fit inside the cruise period with at least
+  /// one count low.
+  bool begin(const Config& config, uint32_t clockHz, uint32_t minPeriodClocks);
+
+  /// @brief Returns true while steps remain to be planned.
+  bool hasNext() const;
+  /// @brief Returns the TOP of the next step's period (`top + 1` timer counts) and advances.
+  /// Returns the cruise TOP once the move is fully planned. TOP is never 0xFFFF, so that
+  /// compare value is free to mark a period without a pulse.
+  uint16_t next();
+
+  /// @brief Returns the number of pulses in the move.
+  uint32_t getSteps() const;
+  /// @brief Returns the number of steps already returned by @ref next().
+  uint32_t getPlanned() const;
+  /// @brief Returns the steps needed to reach the cruise rate (0 without acceleration).
+  uint32_t getRampSteps() const;
+  /// @brief Returns how many consecutive steps share one table entry.
+  uint32_t getStride() const;
+  /// @brief Returns the Timer1 clock-select bits (`CS12:0`, 1..3) for the whole move.
+  uint8_t getClockSelect() const;
+  /// @brief Returns the TOP of the cruise period.
+  uint16_t getCruiseTop() const;
+  /// @brief Returns the pulse width in timer counts.
+  uint16_t getPulseCounts() const;
+
+ private:
+  uint16_t _tops[MAX_ENTRIES];
+  uint16_t _cruiseTop = 0;
+  uint16_t _pulseCounts = 0;
+  uint8_t _clockSelect = 0;
+  uint32_t _steps = 0;
+  uint32_t _rampSteps = 0;
+  uint32_t _stride = 1;
+
+  // Playback: the ramp position of the step last returned is min(_rampPos, _rampSteps) steps
+  // into the ramp, and _entry / _strideCount are that position split by _stride.
+  uint32_t _planned = 0;
+  uint32_t _risesLeft = 0;
+  bool _holdPeak = false;
+  uint32_t _rampPos = 0;
+  uint8_t _entry = 0;
+  uint32_t _strideCount = 0;
+
+  void rise();
+  void fall();
+};
+
+#endif  // IOFUSION_STEP_RAMP_H
@@ -0,0 +1,41 @@
+/// @file step_rate.h
+/// @brief Step-rate arithmetic shared by the tick-driven quadrature generators.
+#ifndef IOFUSION_STEP_RATE_H
+#define IOFUSION_STEP_RATE_H
+
+#include <Arduino.h>
+
+/// @brief Converts a step rate into the per-tick phase increment of a 32-bit accumulator.
+///
+/// The generator adds @p increment on every asserted tick and steps on carry, so the average
+/// rate is exact to `tickRate / 2^32`. The increment is rounded to nearest, except that a
+/// non-zero rate never rounds to 0, so very slow rates keep moving rather than stopping.
+/// A rate equal to the tick rate would need 2^32; @p fullRate is set instead and the
+/// generator steps on every asserted tick. Loop context only; runs a 64-bit division.
+/// @return `false` when @p tickMilliHz is 0 or @p stepMilliHz exceeds it.
+inline bool stepIncrementForMilliHz(uint32_t stepMilliHz, uint32_t tickMilliHz,
+                                    uint32_t& increment, bool& fullRate) {
+  if (tickMilliHz == 0 || stepMilliHz > tickMilliHz) return false;
+  increment = static_cast<uint32_t>(
+      ((static_cast<uint64_t>(stepMilliHz) << 32) + tickMilliHz / 2U) / tickMilliHz);
+  if (increment == 0 && stepMilliHz != 0) increment = 1;
+  fullRate = stepMilliHz == tickMilliHz;
+  return true;
+}
+
+/// @brief Returns the average step rate an increment produces at @p tickMilliHz, rounded to
+/// mHz; the inverse of @ref stepIncrementForMilliHz().
+inline uint32_t stepRateMilliHz(uint32_t increment, bool fullRate, uint32_t tickMilliHz) {
+  if (fullRate) return tickMilliHz;
+  return static_cast<uint32_t>((static_cast<uint64_t>(increment) * tickMilliHz + 0x80000000UL) >>
+                               32);
+}
+
+/// @brief Moves @p position one step up or down, saturating at the `int32_t` limits instead
+/// of wrapping.
+inline int32_t saturatingStep(int32_t position, bool up) {
+  if (up) return position == INT32_MAX ? INT32_MAX : position + 1;
+  return position == INT32_MIN ? INT32_MIN : position - 1;
+}
+
+#endif  // IOFUSION_STEP_RATE_H
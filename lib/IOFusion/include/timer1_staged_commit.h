@@ -0,0 +1,56 @@
+/// @file timer1_staged_commit.h
+/// @brief Period-boundary commit sequence for a staged Timer1 fast PWM (mode 14) update.
+#ifndef IOFUSION_TIMER1_STAGED_COMMIT_H
+#define IOFUSION_TIMER1_STAGED_COMMIT_H
+
+#include <Arduino.h>
+
+/// @brief Runs one overflow-ISR step of a staged TOP and compare update in fast PWM mode 14.
+///
+/// In mode 14 TOV1 is raised at TOP, the OCR1A/B buffers load one timer clock later at BOTTOM,
+/// and ICR1 (TOP) is not buffered. A glitch-free change therefore takes two periods: phase 1
+/// writes the compare buffers after BOTTOM of period N, so they load at the start of N+1, and
+/// phase 2 writes ICR1 early in N+1, before the counter reaches either TOP. Each phase first
+/// waits for the counter to leave TOP, since with a slow timer clock the ISR gets there before
+/// BOTTOM; the wait lasts at most one timer clock.
+///
+/// A step is late when another TOP has passed since the interrupt was raised, or, in phase 2,
+/// when the counter is already past the new TOP (writing ICR1 then would run it to 0xFFFF). A
+/// late step writes back the compare values that were active before phase 1 and restarts at
+/// phase 1, so at most the late period itself plays new duties against the old TOP.
+///
+/// Header-only and written against a register interface so the native tests can run the same
+/// sequence against a model of the timer. @p Registers provides `uint16_t counter()` (TCNT1),
+/// `bool topPassed()` and `void clearTopPassed()` (TOV1), `uint16_t compare(uint8_t channel)`,
+/// `void setCompare(uint16_t a, uint16_t b)` (OCR1A/B) and `void setTop(uint16_t top)` (ICR1).
+/// @param phase Current phase, 1 or 2.
+/// @param activeTop TOP the counter runs to now.
+/// @param restoreCounts Filled in phase 1 with the compare values it replaces; read by a late
+/// step to put them back.
+/// @return The next phase: 2 once phase 1 has written the buffers, 0 once ICR1 holds the new
+/// TOP, or 1 after a late step.
+template <typename Registers>
+uint8_t stepStagedCommit(Registers& registers, uint8_t phase, uint16_t activeTop,
+                         uint16_t stagedTop, const uint16_t* stagedCounts,
+                         uint16_t* restoreCounts) {
+  while (registers.counter() == activeTop) {
+  }
+  if (phase == 1) {
+    // Nothing has been written yet, so a TOP missed before this point costs nothing; the next
+    // one marks the end of the period these writes are buffered for.
+    registers.clearTopPassed();
+    restoreCounts[0] = registers.compare(0);
+    restoreCounts[1] = registers.compare(1);
+    registers.setCompare(stagedCounts[0], stagedCounts[1]);
+    // A BOTTOM between the two writes would have loaded a mixed pair.
+    if (!registers.topPassed()) return 2;
+  } else if (!registers.topPassed() && registers.counter() < stagedTop) {
+    registers.setTop(stagedTop);
+    return 0;
+  }
+  registers.setCompare(restoreCounts[0], restoreCounts[1]);
+  registers.clearTopPassed();
+  return 1;
+}
+
+#endif  // IOFUSION_TIMER1_STAGED_COMMIT_H
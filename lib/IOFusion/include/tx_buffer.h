@@ -0,0 +1,99 @@
+/// @file tx_buffer.h
+/// @brief Output ring that renders text and frames in RAM and feeds a stream without blocking.
+#ifndef IOFUSION_TX_BUFFER_H
+#define IOFUSION_TX_BUFFER_H
+
+#include <Arduino.h>
+
+/// @brief `Print` target that queues bytes and hands them to a sink only as fast as it accepts.
+///
+/// Formatting code prints into the buffer as it would into `Serial`. @ref pump() then moves at
+/// most `sink.availableForWrite()` bytes per call, so it never waits for the UART; calling it
+/// once per `loop()` pass bounds the time output costs per pass regardless of reply size.
+/// Callers check @ref getFree() before starting a reply; a write that finds the buffer full
+/// falls back to passing the oldest byte straight to the sink, which blocks like a direct
+/// `Serial.print()` but keeps the byte order intact.
+///
+/// Loop context only; nothing here is touched by an ISR.
+/// @tparam CAPACITY Buffer size in bytes; a power of two in the range 16..1024.
+template <uint16_t CAPACITY>
+class TxBuffer : public Print {
+  static_assert(CAPACITY >= 16 && CAPACITY <= 1024 && (CAPACITY & (CAPACITY - 1)) == 0,
+                "TxBuffer capacity must be a power of two between 16 and 1024.");
+
+ public:
+  /// @brief Creates an empty buffer that drains into @p sink.
+  explicit TxBuffer(Print& sink) : _sink(sink) {}
+
+  /// @brief Queues one byte.
+  size_t write(uint8_t value) override {
+    if (getFree() == 0) {
+      // Full: make room the slow way rather than reorder or lose output.
+      _sink.write(_buffer[_tail & (CAPACITY - 1)]);
+      ++_tail;
+    }
+    _buffer[_head & (CAPACITY - 1)] = value;
+    ++_head;
+    return 1;
+  }
+
+  /// @brief Queues @p size bytes.
+  size_t write(const uint8_t* data, size_t size) override {
+    for (size_t i = 0; i < size; ++i) write(data[i]);
+    return size;
+  }
+  using Print::write;
+
+  /// @brief Returns the free space, so `print()` callers can size what they are about to send.
+  int availableForWrite() override { return static_cast<int>(getFree()); }
+
+  /// @brief Hands the sink as many queued bytes as it can take without blocking.
+  /// @return Number of bytes moved.
+  uint16_t pump() {
+    int room = _sink.availableForWrite();
+    uint16_t moved = 0;
+    while (room > 0 && _head != _tail) {
+      uint16_t start = _tail & (CAPACITY - 1);
+      // One contiguous run up to the wrap point, the queued end, or the sink's room.
+      uint16_t run = CAPACITY - start;
+      uint16_t queued = static_cast<uint16_t>(_head - _tail);
+      if (run > queued) run = queued;
+      if (static_cast<int>(run) > room) run = static_cast<uint16_t>(room);
+      _sink.write(&_buffer[start], run);
+      _tail = static_cast<uint16_t>(_tail + run);
+      moved = static_cast<uint16_t>(moved + run);
+      room -= run;
+    }
+    return moved;
+  }
+
+  /// @brief Hands every queued byte to the sink, blocking as long as the sink does.
+  void drain() {
+    while (_head != _tail) {
+      uint16_t start = _tail & (CAPACITY - 1);
+      uint16_t run = CAPACITY - start;
+      uint16_t queued = static_cast<uint16_t>(_head - _tail);
+      if (run > queued) run = queued;
+      _sink.write(&_buffer[start], run);
+      _tail = static_cast<uint16_t>(_tail + run);
+    }
+  }
+
+  /// @brief Returns the number of queued bytes.
+  uint16_t size() const { return static_cast<uint16_t>(_head - _tail); }
+  /// @brief Returns the number of bytes that can be queued without blocking.
+  uint16_t getFree() const { return static_cast<uint16_t>(CAPACITY - size()); }
+  /// @brief Returns true when every queued byte has been handed to the sink.
+  bool isEmpty() const { return _head == _tail; }
+  /// @brief Returns the buffer size fixed at compile time.
+  static constexpr uint16_t capacity() { return CAPACITY; }
+
+ private:
+  Print& _sink;
+  uint8_t _buffer[CAPACITY];
+  // Free-running indices, masked on access.
+  uint16_t _head = 0;
+  uint16_t _tail = 0;
+};
+
+#endif  // IOFUSION_TX_BUFFER_H
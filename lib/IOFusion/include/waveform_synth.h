@@ -0,0 +1,83 @@
+/// @file waveform_synth.h
+/// @brief Phase-accumulator waveform synthesis from PROGMEM sample tables.
+#ifndef IOFUSION_WAVEFORM_SYNTH_H
+#define IOFUSION_WAVEFORM_SYNTH_H
+
+#include <Arduino.h>
+
+/// @brief Direct digital synthesis of two phase-offset outputs from one sample table.
+///
+/// Each @ref step() advances a 32-bit phase accumulator by a fixed increment and maps the top
+/// bits of the phase to a table index, so the output frequency is exact to
+/// `updateRate / 2^32`. Samples are unsigned bytes (`0..255`, 127.5 is mid-scale) scaled to
+/// compare counts around `top / 2`. Every division happens in @ref begin(); a step is two
+/// PROGMEM reads and two multiply-and-shifts, cheap enough to run once per PWM period.
+class WaveformSynth {
+ public:
+  /// Index width of the built-in sine table (256 entries).
+  static const uint8_t SINE_TABLE_BITS = 8;
+  /// Channel B phase lead, in 1/65536 of a turn, for a quadrature (90 degree) pair.
+  static const uint16_t PHASE_QUARTER_TURN = 16384;
+  /// Channel B phase offset that makes B lag A by 90 degrees (a three-quarter-turn lead).
+  static const uint16_t PHASE_QUARTER_TURN_LAG = 49152;
+
+  /// @brief Returns the built-in one-period sine table in PROGMEM.
+  static const uint8_t* sineTable();
+
+  /// @brief Startup configuration for WaveformSynth.
+  struct Config {
+    /// One waveform period of `2^tableBits` unsigned samples, stored in PROGMEM.
+    const uint8_t* table = nullptr;
+    /// Table index width in bits (1..16).
+    uint8_t tableBits = SINE_TABLE_BITS;
+    /// Output frequency in millihertz; must be below half the update rate.
+    uint32_t frequencyMilliHz = 0;
+    /// Peak-to-peak swing as a fraction of the full compare range, in permille (0..1000).
+    uint16_t amplitudePermille = 1000;
+    /// Phase by which channel B leads channel A, in 1/65536 of a turn.
+    uint16_t phaseOffsetB = PHASE_QUARTER_TURN;
+
+    Config() = default;
+    Config(const uint8_t* tableIn, uint8_t tableBitsIn, uint32_t frequencyMilliHzIn,
+           uint16_t amplitudePermilleIn, uint16_t phaseOffsetBIn)
+        : table(tableIn),
+          tableBits(tableBitsIn),
+          frequencyMilliHz(frequencyMilliHzIn),
+          amplitudePermille(amplitudePermilleIn),
+          phaseOffsetB(phaseOffsetBIn) {}
+  };
+
+  /// @brief Constructs an idle synthesizer.
+  WaveformSynth();
+
+  /// @brief Precomputes the phase increment and output scaling and resets the phase to 0.
+  /// @param top Compare range of the output; samples map onto `0..top`.
+  /// @param updateMilliHz Rate at which @ref step() will be called, in millihertz.
+  /// @return `false` when the table is null, `tableBits` or `amplitudePermille` is out of
+  /// range, `top` or `updateMilliHz` is 0, or the frequency is 0 or not below
+  /// `updateMilliHz / 2`.
+  bool begin(const Config& config, uint16_t top, uint32_t updateMilliHz);
+
+  /// @brief Advances the phase by one update and returns both channels' compare values.
+  void step(uint16_t& countsA, uint16_t& countsB);
+
+  /// @brief Returns the per-update phase increment (0 before a successful @ref begin()).
+  uint32_t getPhaseIncrement() const;
+  /// @brief Returns the output frequency the increment actually produces, rounded to mHz.
+  uint32_t getFrequencyMilliHz() const;
+
+ private:
+  const uint8_t* _table = nullptr;
+  uint8_t _indexShift = 0;
+  uint32_t _phase = 0;
+  uint32_t _increment = 0;
+  uint32_t _offsetB = 0;
+  uint32_t _updateMilliHz = 0;
+  // Sample-to-counts mapping: counts = _baseCounts + (sample * _scaleQ16 + 0x8000) >> 16.
+  uint16_t _baseCounts = 0;
+  uint32_t _scaleQ16 = 0;
+
+  uint16_t countsAt(uint32_t phase) const;
+};
+
+#endif  // IOFUSION_WAVEFORM_SYNTH_H
@@ -69,6 +69,15 @@ void AnalogSampler::sampleIfDue() {
     int v = analogRead(ch);
     _lastValues[i] = v;
   }
+  ++_roundCount;
+}
+
+bool AnalogSampler::isSampleDue() const {
+  return _sampleRequested;
+}
+
+uint32_t AnalogSampler::getRoundCount() const {
+  return _roundCount;
 }
 
 uint8_t AnalogSampler::getChannelCount() const {
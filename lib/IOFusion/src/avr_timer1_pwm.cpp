@@ -2,6 +2,8 @@
 
 #if defined(__AVR__)
 
+#include "timer1_staged_commit.h"
+
 namespace {
 
 constexpr uint8_t kPwmPins[2] = {9, 10};
@@ -28,6 +30,20 @@ void writePwmPinLevel(uint8_t channel, bool high) {
     *portOut &= static_cast<uint8_t>(~mask);
 }
 
+// Binds stepStagedCommit() to the Timer1 registers. Reading OCR1x in a PWM mode returns the
+// buffer, which phase 1 reads before replacing it.
+struct Timer1Registers {
+  uint16_t counter() const { return TCNT1; }
+  bool topPassed() const { return (TIFR1 & _BV(TOV1)) != 0; }
+  void clearTopPassed() { TIFR1 = _BV(TOV1); }
+  uint16_t compare(uint8_t channel) const { return channel == 0 ? OCR1A : OCR1B; }
+  void setCompare(uint16_t countsA, uint16_t countsB) {
+    OCR1A = countsA;
+    OCR1B = countsB;
+  }
+  void setTop(uint16_t top) { ICR1 = top; }
+};
+
 void setCompareMode(uint8_t channel, bool enabled) {
   if (channel == 0) {
     TCCR1A &= static_cast<uint8_t>(~(_BV(COM1A1) | _BV(COM1A0)));
@@ -40,6 +56,8 @@ void setCompareMode(uint8_t channel, bool enabled) {
 
 }  // namespace
 
+Timer1PWM* volatile Timer1PWM::_activeInstance = nullptr;
+
 Timer1PWM::Timer1PWM() {}
 
 bool Timer1PWM::begin(const Config& config) {
@@ -47,47 +65,29 @@ bool Timer1PWM::begin(const Config& config) {
 }
 
 bool Timer1PWM::begin(float freqHz) {
-  if (freqHz <= 0.0f) return false;
-
-  // Determine Timer1 top and prescaler for requested frequency.
-  const uint16_t pres[] = {1, 8, 64, 256, 1024};
-  const uint32_t F = F_CPU;
-  uint32_t top = 0;
-  uint16_t chosenPres = 1;
-  for (uint8_t i = 0; i < sizeof(pres) / sizeof(pres[0]); ++i) {
-    float t = ((float)F / (pres[i] * freqHz)) - 1.0f;
-    if (t > 0.0f && t <= 65535.0f) {
-      top = static_cast<uint32_t>(t + 0.5f);
-      chosenPres = pres[i];
-      break;
-    }
-  }
-  if (top == 0 || top > 65535) return false;
-
-  uint16_t newTop = static_cast<uint16_t>(top);
-  uint16_t newPresBits = 0;
-  switch (chosenPres) {
-    case 1:
-      newPresBits = _BV(CS10);
-      break;
-    case 8:
-      newPresBits = _BV(CS11);
-      break;
-    case 64:
-      newPresBits = _BV(CS11) | _BV(CS10);
-      break;
-    case 256:
-      newPresBits = _BV(CS12);
-      break;
-    case 1024:
-      newPresBits = _BV(CS12) | _BV(CS10);
-      break;
-    default:
-      newPresBits = _BV(CS10);
-      break;
-  }
+  if (!(freqHz > 0.0f) || freqHz >= 4294967.0f) return false;
+  return beginMilliHz(static_cast<uint32_t>(freqHz * 1000.0f + 0.5f));
+}
+
+bool Timer1PWM::beginMilliHz(uint32_t freqMilliHz, Preference preference) {
+  return begin(timingForMilliHz(freqMilliHz, preference));
+}
+
+bool Timer1PWM::begin(const Timing& timing) {
+  if (!timing.isValid()) return false;
+  stopWaveform();
+  cancelStaged();
+  stopSweep();
+
+  uint16_t newTop = timing.top;
+  uint16_t newPresBits = timing.clockSelect;
 
   noInterrupts();
+  if (_stepping) endSteps();
+  _stepMode = false;
+  _complementary = false;
+  _deadTimeCounts = 0;
+  _squareWave = false;
   pinMode(kPwmPins[0], OUTPUT);
   pinMode(kPwmPins[1], OUTPUT);
 
@@ -97,8 +97,9 @@ bool Timer1PWM::begin(float freqHz) {
   TCCR1B = tccr1b;
 
   ICR1 = newTop;
-  _applyDuty(0, _dutyPercent[0], newTop);
-  _applyDuty(1, _dutyPercent[1], newTop);
+  setDutyTop(newTop);
+  _applyDuty(0, _dutyCounts[0], newTop);
+  _applyDuty(1, _dutyCounts[1], newTop);
   TCNT1 = 0;
 
   tccr1b |= newPresBits;
@@ -112,39 +113,551 @@ bool Timer1PWM::begin(float freqHz) {
   return true;
 }
 
-void Timer1PWM::stop() {
+bool Timer1PWM::beginComplementary(const Timing& timing, uint16_t deadTimeCounts) {
+  if (!timing.isValid() || deadTimeCounts >= timing.top) return false;
+  stopWaveform();
+  cancelStaged();
+  stopSweep();
+
   noInterrupts();
+  if (_stepping) endSteps();
+  // Park both pins LOW, then stop Timer1 in normal mode, where compare registers are not
+  // double-buffered, so the first period already uses the new pair.
+  writePwmPinLevel(0, false);
+  writePwmPinLevel(1, false);
+  pinMode(kPwmPins[0], OUTPUT);
+  pinMode(kPwmPins[1], OUTPUT);
   TCCR1A = 0;
   TCCR1B = 0;
-  OCR1A = 0;
+  TCNT1 = 0;
+  // An earlier fast-PWM run can leave both compare latches HIGH, and the inverted OC1B would
+  // then start with the low side on together with the high side. Forced compares with "clear
+  // on match" latch them LOW, OC1A first so the two pins are never connected HIGH together.
+  TCCR1A = _BV(COM1A1);
+  TCCR1C = _BV(FOC1A);
+  TCCR1A = _BV(COM1A1) | _BV(COM1B1);
+  TCCR1C = _BV(FOC1B);
+  ICR1 = timing.top;
+  _stepMode = false;
+  _squareWave = false;
+  _complementary = true;
+  _deadTimeCounts = deadTimeCounts;
+  setDutyTop(timing.top);
+  applyComplementary(_dutyCounts[0], timing.top);
+
+  // Phase-correct PWM, TOP = ICR1 (mode 10): OC1A non-inverting, OC1B inverting.
+  TCCR1A = _BV(COM1A1) | _BV(COM1B1) | _BV(COM1B0) | _BV(WGM11);
+  TCCR1B = static_cast<uint8_t>(_BV(WGM13) | timing.clockSelect);
+
+  _top = timing.top;
+  _presBits = timing.clockSelect;
+  _configured = true;
+  interrupts();
+  return true;
+}
+
+bool Timer1PWM::isComplementary() const {
+  return _complementary;
+}
+
+uint16_t Timer1PWM::getDeadTimeCounts() const {
+  return _deadTimeCounts;
+}
+
+bool Timer1PWM::beginSquareWave(const Timing& timing) {
+  if (!timing.isValid()) return false;
+  stopWaveform();
+  cancelStaged();
+  stopSweep();
+
+  noInterrupts();
+  if (_stepping) endSteps();
+  writePwmPinLevel(0, false);
+  writePwmPinLevel(1, false);
+  pinMode(kPwmPins[0], OUTPUT);
+  pinMode(kPwmPins[1], OUTPUT);
+  // Stop the counter before changing TOP: OCR1A is not double-buffered in CTC mode.
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  OCR1A = timing.top;
   OCR1B = 0;
+  _stepMode = false;
+  _complementary = false;
+  _deadTimeCounts = 0;
+  _squareWave = true;
+
+  // CTC, TOP = OCR1A (mode 4): OC1A toggles at every match, once per half-period.
+  TCCR1A = _BV(COM1A0);
+  TCCR1B = static_cast<uint8_t>(_BV(WGM12) | timing.clockSelect);
+
+  _top = timing.top;
+  _presBits = timing.clockSelect;
+  _configured = true;
+  interrupts();
+  return true;
+}
+
+bool Timer1PWM::startSweep(const FrequencySweep::Config& config) {
+  // The compare ISR must be off while the plan is rebuilt.
+  stopSweep();
+  if (!_sweep.begin(config, CLOCK_HZ, MIN_SWEEP_HALF_PERIOD_CLOCKS)) return false;
+  const FrequencySweep::Step& first = _sweep.current();
+  if (!beginSquareWave(Timing(first.top, first.clockSelect))) return false;
+
+  noInterrupts();
+  _sweepActive = true;
+  _activeInstance = this;
+  TIFR1 = _BV(OCF1A);
+  TIMSK1 |= _BV(OCIE1A);
+  interrupts();
+  return true;
+}
+
+void Timer1PWM::stopSweep() {
+  if (!_sweepActive) return;
+  noInterrupts();
+  TIMSK1 &= static_cast<uint8_t>(~_BV(OCIE1A));
+  _sweepActive = false;
+  interrupts();
+}
+
+bool Timer1PWM::isSweepActive() const {
+  return _sweepActive;
+}
+
+bool Timer1PWM::isSquareWave() const {
+  return _squareWave;
+}
+
+uint32_t Timer1PWM::getSquareWaveFrequencyMilliHz() const {
+  return _squareWave ? squareWaveFrequencyMilliHz(getTiming()) : 0;
+}
+
+bool Timer1PWM::startSteps(const StepRamp::Config& config, bool forward) {
+  // The overflow ISR must be off while the plan is rebuilt.
+  noInterrupts();
+  if (_stepping) endSteps();
+  interrupts();
+  if (!_stepRamp.begin(config, CLOCK_HZ, MIN_STEP_PERIOD_CLOCKS)) return false;
+  stopWaveform();
+  cancelStaged();
+  stopSweep();
+
+  uint16_t pulse = _stepRamp.getPulseCounts();
+  uint16_t first = _stepRamp.next();
+
+  noInterrupts();
+  writePwmPinLevel(0, forward);
+  writePwmPinLevel(1, false);
+  pinMode(kPwmPins[0], OUTPUT);
+  pinMode(kPwmPins[1], OUTPUT);
+  // Stopped in normal mode the compare registers are written directly, so the first period
+  // is in place; a forced compare with "clear on match" leaves the OC1B latch LOW.
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  OCR1A = first;
+  OCR1B = first + 1U - pulse;
+  TCCR1A = _BV(COM1B1);
+  TCCR1C = _BV(FOC1B);
+
+  // Fast PWM, TOP = OCR1A (mode 15). Inverting OC1B is set at the compare match and cleared
+  // at BOTTOM, so the last `pulse` counts of every period are the step pulse.
+  TCCR1A = _BV(COM1B1) | _BV(COM1B0) | _BV(WGM11) | _BV(WGM10);
+  TCCR1B = _BV(WGM13) | _BV(WGM12);
+  // Now double-buffered: the second period loads at the first BOTTOM. A one-step move gives
+  // it no pulse (see stepPulse()).
+  uint16_t second = first;
+  if (_stepRamp.hasNext()) {
+    second = _stepRamp.next();
+    OCR1A = second;
+    OCR1B = second + 1U - pulse;
+  } else {
+    OCR1B = 0xFFFF;
+  }
+  _stepTopPlaying = first;
+  _stepTopQueued = second;
+
+  _complementary = false;
+  _deadTimeCounts = 0;
+  _squareWave = false;
+  _stepMode = true;
+  _top = 0;
+  _presBits = 0;
+  _configured = false;
+  _stepsDone = 0;
+  _stepLimit = _stepRamp.getSteps();
+  _stepPulseCounts = pulse;
+  _stepStopRequested = false;
+  _stepping = true;
+  _activeInstance = this;
+  TIFR1 = _BV(TOV1);
+  TIMSK1 |= _BV(TOIE1);
+  TCCR1B = static_cast<uint8_t>(_BV(WGM13) | _BV(WGM12) | _stepRamp.getClockSelect());
+  interrupts();
+  return true;
+}
+
+void Timer1PWM::stopSteps() {
+  if (_stepping) _stepStopRequested = true;
+}
+
+bool Timer1PWM::isStepping() const {
+  return _stepping;
+}
+
+uint32_t Timer1PWM::getStepsDone() const {
+  noInterrupts();
+  uint32_t done = _stepsDone;
+  interrupts();
+  return done;
+}
+
+void Timer1PWM::stop() {
+  stopWaveform();
+  cancelStaged();
+  stopSweep();
+  noInterrupts();
+  if (_stepping) endSteps();
+  // Port latches go LOW first, so disconnecting the compare units cannot pulse either pin.
   writePwmPinLevel(0, false);
   writePwmPinLevel(1, false);
+  TCCR1A = 0;
+  TCCR1B = 0;
+  OCR1A = 0;
+  OCR1B = 0;
   interrupts();
-  pinMode(kPwmPins[0], INPUT);
-  pinMode(kPwmPins[1], INPUT);
+  if (!_complementary) {
+    pinMode(kPwmPins[0], INPUT);
+    pinMode(kPwmPins[1], INPUT);
+  }
+  _stepMode = false;
+  _complementary = false;
+  _deadTimeCounts = 0;
+  _squareWave = false;
   _top = 0;
   _presBits = 0;
-  _dutyPercent[0] = 0.0f;
-  _dutyPercent[1] = 0.0f;
+  _dutyCounts[0] = 0;
+  _dutyCounts[1] = 0;
+  setDutyTop(UNCONFIGURED_TOP);
   _configured = false;
 }
 
 void Timer1PWM::setDuty(uint8_t channel, float percent) {
   if (channel > 1) return;
-  if (percent < 0.0f) percent = 0.0f;
+  if (!(percent > 0.0f)) percent = 0.0f;
   if (percent > 100.0f) percent = 100.0f;
-  _dutyPercent[channel] = percent;
+  setDutyCounts(channel, static_cast<uint16_t>((percent / 100.0f) * _dutyTop + 0.5f));
+}
+
+void Timer1PWM::setDutyPermille(uint8_t channel, uint16_t permille) {
+  if (permille > 1000U) permille = 1000U;
+  uint32_t scaled = static_cast<uint32_t>(permille) * _countsPerPermilleQ16 + 0x8000UL;
+  setDutyCounts(channel, static_cast<uint16_t>(scaled >> 16));
+}
+
+void Timer1PWM::setDutyCounts(uint8_t channel, uint16_t counts) {
+  if (channel > 1 || _squareWave || _stepMode || (_complementary && channel == 1)) return;
+  if (_waveformActive) stopWaveform();
+  if (_stagePhase != 0) cancelStaged();
+  if (counts > _dutyTop) counts = _dutyTop;
+  _dutyCounts[channel] = counts;
   if (!_configured || _top == 0) return;
   noInterrupts();
-  _applyDuty(channel, percent, _top);
+  _applyDuty(channel, counts, _top);
   interrupts();
 }
 
-void Timer1PWM::_applyDuty(uint8_t channel, float percent, uint16_t top) {
-  if (channel > 1) return;
+bool Timer1PWM::writeDutyPermilleFromIsr(uint8_t channel, uint16_t permille) {
+  if (channel > 1 || !_configured || _stagePhase != 0 || _waveformActive) return false;
+  if (_squareWave || (_complementary && channel == 1)) return false;
+  if (permille > 1000U) permille = 1000U;
+  uint32_t scaled = static_cast<uint32_t>(permille) * _countsPerPermilleQ16 + 0x8000UL;
+  uint16_t counts = static_cast<uint16_t>(scaled >> 16);
+  _dutyCounts[channel] = counts;
+  _applyDuty(channel, counts, _top);
+  return true;
+}
+
+uint16_t Timer1PWM::getTop() const {
+  noInterrupts();
+  uint16_t top = _top;
+  interrupts();
+  return top;
+}
+
+Timer1PWM::Timing Timer1PWM::getTiming() const {
+  if (!_configured) return Timing();
+  noInterrupts();
+  Timing timing(_top, static_cast<uint8_t>(_presBits));
+  interrupts();
+  return timing;
+}
+
+bool Timer1PWM::stageUpdate(const Timing& timing, uint16_t dutyPermilleA, uint16_t dutyPermilleB) {
+  if (!timing.isValid()) return false;
+  if (dutyPermilleA > 1000U) dutyPermilleA = 1000U;
+  if (dutyPermilleB > 1000U) dutyPermilleB = 1000U;
+  uint32_t scale = countsPerPermilleQ16(timing.top);
+  uint16_t countsA = static_cast<uint16_t>((dutyPermilleA * scale + 0x8000UL) >> 16);
+  uint16_t countsB = static_cast<uint16_t>((dutyPermilleB * scale + 0x8000UL) >> 16);
+  return stageCounts(timing, countsA, countsB);
+}
+
+bool Timer1PWM::stageTiming(const Timing& timing) {
+  if (!timing.isValid() || !_configured || _waveformActive || _complementary || _squareWave) {
+    return false;
+  }
+  // After cancelling, the overflow ISR no longer touches the duty bookkeeping read below.
+  cancelStaged();
+  // A tick-driven duty writer may still update the counts, so copy them in one piece.
+  noInterrupts();
+  uint16_t counts[2] = {_dutyCounts[0], _dutyCounts[1]};
+  interrupts();
+  for (uint8_t ch = 0; ch < 2; ++ch) {
+    uint32_t rescaled = static_cast<uint32_t>(counts[ch]) * timing.top + (_dutyTop / 2U);
+    counts[ch] = static_cast<uint16_t>(rescaled / _dutyTop);
+  }
+  return stageCounts(timing, counts[0], counts[1]);
+}
+
+bool Timer1PWM::isUpdatePending() const {
+  return _stagePhase != 0;
+}
+
+bool Timer1PWM::stageCounts(const Timing& timing, uint16_t countsA, uint16_t countsB) {
+  if (!_configured || _waveformActive || _complementary || _squareWave || !timing.isValid()) {
+    return false;
+  }
+  if (timing.periodClocks() < MIN_STAGED_PERIOD_CLOCKS) return false;
+  if (getTiming().periodClocks() < MIN_STAGED_PERIOD_CLOCKS) return false;
+  if (countsA > timing.top) countsA = timing.top;
+  if (countsB > timing.top) countsB = timing.top;
+  // Computed here so the commit ISR does no division.
+  uint32_t scale = countsPerPermilleQ16(timing.top);
+
+  noInterrupts();
+  if (_stagePhase == 2) {
+    // The compare buffers may already hold the replaced update; restore the active duties.
+    _applyDuty(0, _dutyCounts[0], _top);
+    _applyDuty(1, _dutyCounts[1], _top);
+  }
+  _stagedTop = timing.top;
+  _stagedClockSelect = timing.clockSelect;
+  _stagedCounts[0] = countsA;
+  _stagedCounts[1] = countsB;
+  _stagedScaleQ16 = scale;
+  _stagePhase = 1;
+  _activeInstance = this;
+  // Drop a flag left from an earlier boundary so phase 1 runs at the start of a period.
+  TIFR1 = _BV(TOV1);
+  TIMSK1 |= _BV(TOIE1);
+  interrupts();
+  return true;
+}
+
+void Timer1PWM::cancelStaged() {
+  noInterrupts();
+  TIMSK1 &= static_cast<uint8_t>(~_BV(TOIE1));
+  if (_stagePhase == 2) {
+    _applyDuty(0, _dutyCounts[0], _top);
+    _applyDuty(1, _dutyCounts[1], _top);
+  }
+  _stagePhase = 0;
+  interrupts();
+}
+
+bool Timer1PWM::startWaveform(const WaveformSynth::Config& config) {
+  Timing timing = getTiming();
+  if (_complementary || _squareWave || timing.periodClocks() < MIN_WAVEFORM_PERIOD_CLOCKS) {
+    return false;
+  }
+  stopWaveform();
+  cancelStaged();
+  // The ISR is off, so the synthesizer can be rebuilt in place.
+  if (!_waveform.begin(config, timing.top, timing.frequencyMilliHz())) return false;
+
+  uint16_t countsA = 0;
+  uint16_t countsB = 0;
+  _waveform.step(countsA, countsB);
+  noInterrupts();
+  // Compare outputs stay enabled throughout; a sample of 0 counts leaves a one-count pulse,
+  // which the output filter absorbs.
+  setCompareMode(0, true);
+  setCompareMode(1, true);
+  OCR1A = countsA;
+  OCR1B = countsB;
+  _waveformActive = true;
+  _activeInstance = this;
+  TIFR1 = _BV(TOV1);
+  TIMSK1 |= _BV(TOIE1);
+  interrupts();
+  return true;
+}
 
-  if (percent <= 0.0f) {
+void Timer1PWM::stopWaveform() {
+  if (!_waveformActive) return;
+  noInterrupts();
+  TIMSK1 &= static_cast<uint8_t>(~_BV(TOIE1));
+  _waveformActive = false;
+  _applyDuty(0, _dutyCounts[0], _top);
+  _applyDuty(1, _dutyCounts[1], _top);
+  interrupts();
+}
+
+bool Timer1PWM::isWaveformActive() const {
+  return _waveformActive;
+}
+
+uint32_t Timer1PWM::getWaveformFrequencyMilliHz() const {
+  return _waveformActive ? _waveform.getFrequencyMilliHz() : 0;
+}
+
+// ISR for Timer1 overflow. In fast PWM modes 14 and 15 TOV1 is set at TOP, so this runs at the
+// start of every period while an update is staged, a waveform is playing or a move is running.
+ISR(TIMER1_OVF_vect) {
+  Timer1PWM::handleOverflow();
+}
+
+void Timer1PWM::handleOverflow() {
+  Timer1PWM* pwm = _activeInstance;
+  if (pwm == nullptr) return;
+  if (pwm->_stepping) {
+    pwm->stepPulse();
+  } else if (pwm->_waveformActive) {
+    pwm->stepWaveform();
+  } else {
+    pwm->commitStaged();
+  }
+}
+
+// ISR for Timer1 compare A. In CTC mode 4 the match is at TOP, so this runs at every output
+// edge while a sweep is stepping.
+ISR(TIMER1_COMPA_vect) {
+  Timer1PWM::handleCompareA();
+}
+
+void Timer1PWM::handleCompareA() {
+  Timer1PWM* pwm = _activeInstance;
+  if (pwm != nullptr && pwm->_sweepActive) pwm->stepSweep();
+}
+
+void Timer1PWM::stepSweep() {
+  if (!_sweep.onHalfPeriod()) return;
+  const FrequencySweep::Step& next = _sweep.next();
+  // The counter has just restarted. If this ISR ran late, keep the step for one more
+  // half-period instead of risking a TOP below the count, which would run it to 0xFFFF.
+  if (TCNT1 >= next.top / 2U) return;
+  OCR1A = next.top;
+  if (next.clockSelect != _presBits) {
+    TCCR1B = static_cast<uint8_t>((TCCR1B & ~(_BV(CS12) | _BV(CS11) | _BV(CS10))) |
+                                  next.clockSelect);
+  }
+  _top = next.top;
+  _presBits = next.clockSelect;
+  // Resolving the following step is the slow part; the new TOP is already in place.
+  if (!_sweep.advance()) {
+    TIMSK1 &= static_cast<uint8_t>(~_BV(OCIE1A));
+    _sweepActive = false;
+  }
+}
+
+void Timer1PWM::stepPulse() {
+  // TOV1 is raised at TOP, one timer clock before BOTTOM loads the buffers. With a slow timer
+  // clock this ISR gets here first, and a write now would replace the period about to start.
+  // StepRamp keeps the prescaler at /64 or faster, so this waits at most 64 CPU cycles.
+  uint16_t ending = _stepTopPlaying;
+  while (TCNT1 == ending) {
+  }
+  _stepTopPlaying = _stepTopQueued;
+  // The pulse that ended at BOTTOM is complete; the period that just started was loaded from
+  // the buffers at BOTTOM, so values written now take effect one period later.
+  uint32_t done = _stepsDone + 1U;
+  _stepsDone = done;
+  if (done >= _stepLimit) {
+    endSteps();
+    return;
+  }
+  if (_stepStopRequested) {
+    _stepStopRequested = false;
+    _stepLimit = done + 1U;
+  }
+  if (done + 1U >= _stepLimit) {
+    // The period now playing holds the last pulse. The one after it gets none, since a compare
+    // value above TOP never matches, so a late ISR cannot let an extra pulse out.
+    OCR1B = 0xFFFF;
+    return;
+  }
+  uint16_t top = _stepRamp.next();
+  OCR1A = top;
+  OCR1B = top + 1U - _stepPulseCounts;
+  _stepTopQueued = top;
+}
+
+void Timer1PWM::endSteps() {
+  // Runs in the overflow ISR or with interrupts masked. The direction pin keeps its level.
+  TIMSK1 &= static_cast<uint8_t>(~_BV(TOIE1));
+  TCCR1B = 0;
+  writePwmPinLevel(1, false);
+  setCompareMode(1, false);
+  _stepping = false;
+}
+
+void Timer1PWM::stepWaveform() {
+  uint16_t countsA;
+  uint16_t countsB;
+  _waveform.step(countsA, countsB);
+  // Buffered until the next BOTTOM, so each sample lasts exactly one period.
+  OCR1A = countsA;
+  OCR1B = countsB;
+}
+
+void Timer1PWM::commitStaged() {
+  if (_stagePhase == 0) return;
+  Timer1Registers registers;
+  _stagePhase = stepStagedCommit(registers, _stagePhase, _top, _stagedTop, _stagedCounts,
+                                 _restoreCounts);
+  if (_stagePhase != 0) return;
+
+  // ICR1 now holds the new TOP; the prescaler and output modes follow in the same period.
+  if (_stagedClockSelect != _presBits) {
+    TCCR1B = static_cast<uint8_t>((TCCR1B & ~(_BV(CS12) | _BV(CS11) | _BV(CS10))) |
+                                  _stagedClockSelect);
+  }
+  _applyDuty(0, _stagedCounts[0], _stagedTop);
+  _applyDuty(1, _stagedCounts[1], _stagedTop);
+
+  _top = _stagedTop;
+  _presBits = _stagedClockSelect;
+  _dutyCounts[0] = _stagedCounts[0];
+  _dutyCounts[1] = _stagedCounts[1];
+  _dutyTop = _stagedTop;
+  _countsPerPermilleQ16 = _stagedScaleQ16;
+  TIMSK1 &= static_cast<uint8_t>(~_BV(TOIE1));
+}
+
+void Timer1PWM::setDutyTop(uint16_t top) {
+  // Re-express retained duties against the new TOP so a frequency change keeps the duty ratio.
+  // This division runs only on reconfiguration, never on a duty update.
+  if (top != _dutyTop) {
+    for (uint8_t ch = 0; ch < 2; ++ch) {
+      uint32_t rescaled = static_cast<uint32_t>(_dutyCounts[ch]) * top + (_dutyTop / 2U);
+      _dutyCounts[ch] = static_cast<uint16_t>(rescaled / _dutyTop);
+    }
+  }
+  _dutyTop = top;
+  _countsPerPermilleQ16 = countsPerPermilleQ16(top);
+}
+
+void Timer1PWM::_applyDuty(uint8_t channel, uint16_t counts, uint16_t top) {
+  if (channel > 1 || _squareWave) return;
+  if (_complementary) {
+    if (channel == 0) applyComplementary(counts, top);
+    return;
+  }
+
+  if (counts == 0) {
     setCompareMode(channel, false);
     if (channel == 0)
       OCR1A = 0;
@@ -154,7 +667,7 @@ void Timer1PWM::_applyDuty(uint8_t channel, float percent, uint16_t top) {
     return;
   }
 
-  if (percent >= 100.0f) {
+  if (counts >= top) {
     setCompareMode(channel, false);
     if (channel == 0)
       OCR1A = top;
@@ -164,20 +677,26 @@ void Timer1PWM::_applyDuty(uint8_t channel, float percent, uint16_t top) {
     return;
   }
 
-  uint16_t value = percentToCounts(percent, top);
   if (channel == 0)
-    OCR1A = value;
+    OCR1A = counts;
   else
-    OCR1B = value;
+    OCR1B = counts;
   setCompareMode(channel, true);
 }
 
-uint16_t Timer1PWM::percentToCounts(float percent, uint16_t top) const {
-  if (top == 0) return 0;
-  if (percent <= 0.0f) return 0;
-  if (percent >= 100.0f) return top;
-  uint32_t v = static_cast<uint32_t>((percent / 100.0f) * static_cast<float>(top) + 0.5f);
-  if (v > top) v = top;
-  return (uint16_t)v;
+void Timer1PWM::applyComplementary(uint16_t counts, uint16_t top) {
+  // OC1A is high while TCNT1 < OCR1A; inverted OC1B is high while TCNT1 > OCR1B. Keeping
+  // OCR1B exactly dead-time counts above OCR1A opens a both-low gap of that length on the way
+  // up and on the way down. At OCR1B == TOP the low side stays off for the whole period.
+  // Both registers are buffered and the timer keeps running, so the pair is stored in the
+  // order that never lets a loaded pair overlap. Reading OCR1A returns the buffered value.
+  ComplementaryCompare pair = complementaryCompare(counts, top, _deadTimeCounts, OCR1A);
+  if (pair.lowSideFirst) {
+    OCR1B = pair.lowSide;
+    OCR1A = pair.highSide;
+  } else {
+    OCR1A = pair.highSide;
+    OCR1B = pair.lowSide;
+  }
 }
 #endif  // __AVR__
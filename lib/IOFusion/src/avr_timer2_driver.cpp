@@ -31,6 +31,7 @@ uint16_t computeTimer2Ocr(float freqHz, uint16_t& chosenPres) {
 }  // namespace
 
 Timer2Driver* volatile Timer2Driver::_activeDriver = nullptr;
+PortSnapshot Timer2Driver::_tickSnapshot;
 
 Timer2Driver::Timer2Driver() {
   resetCallbacks();
@@ -80,6 +81,8 @@ uint16_t Timer2Driver::beginHz(float freqHz) {
   }
 
   resetCallbacks();
+  resetLoad();
+  _compareValue = static_cast<uint8_t>(chosenOCR);
 
   // Stop Timer2 and clear any stale counter/interrupt state before arming it.
   TCCR2A = 0;
@@ -169,7 +172,16 @@ ISR(TIMER2_COMPA_vect) {
 
 void Timer2Driver::handleInterrupt() {
   Timer2Driver* driver = _activeDriver;
-  if (driver != nullptr) driver->dispatchCallbacks();
+  if (driver == nullptr) return;
+  // Read every input port once, before any callback runs, so all consumers see one instant.
+  ++_tickSnapshot.tick;
+  _tickSnapshot.capture();
+  driver->dispatchCallbacks();
+  driver->recordLoad();
+}
+
+const PortSnapshot& Timer2Driver::tickSnapshot() {
+  return _tickSnapshot;
 }
 
 void Timer2Driver::resetCallbacks() {
@@ -178,6 +190,40 @@ void Timer2Driver::resetCallbacks() {
   }
 }
 
+bool Timer2Driver::takeLoadSample(LoadSample& sample) {
+  noInterrupts();
+  if (_activeDriver != this) {
+    interrupts();
+    return false;
+  }
+  sample.busyCounts = _busyCounts;
+  sample.ticks = _loadTicks;
+  sample.overrunTicks = _overrunTicks;
+  resetLoad();
+  interrupts();
+  sample.periodCounts = static_cast<uint16_t>(_compareValue) + 1U;
+  return true;
+}
+
+void Timer2Driver::resetLoad() {
+  _busyCounts = 0;
+  _loadTicks = 0;
+  _overrunTicks = 0;
+}
+
+void Timer2Driver::recordLoad() {
+  // In CTC mode TCNT2 restarts at the compare match, so its value now is the time this tick
+  // has spent in the ISR. A pending OCF2A means the dispatch already ran into the next tick.
+  uint16_t busy = TCNT2;
+  if (TIFR2 & _BV(OCF2A)) {
+    busy += static_cast<uint16_t>(_compareValue) + 1U;
+    if (_overrunTicks != 0xFFFFU) ++_overrunTicks;
+  }
+  if (_loadTicks == 0xFFFFU) return;
+  ++_loadTicks;
+  _busyCounts += busy;
+}
+
 void Timer2Driver::dispatchCallbacks() {
   for (uint8_t i = 0; i < MAX_CALLBACKS; ++i) {
     Timer2Callback cb = _cbs[i];
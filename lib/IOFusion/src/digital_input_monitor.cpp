@@ -29,16 +29,19 @@ bool DigitalInputMonitor::begin(const uint8_t* pins, uint8_t count, uint16_t win
   uint8_t newPins[MAX_PINS];
   volatile uint8_t* newPinPortIn[MAX_PINS];
   uint8_t newPinMask[MAX_PINS];
+  uint8_t newPinPort[MAX_PINS];
 
   for (uint8_t i = 0; i < count; ++i) {
     uint8_t pin = pins[i];
     uint8_t port = digitalPinToPort(pin);
     volatile uint8_t* portIn = portInputRegister(port);
     uint8_t mask = digitalPinToBitMask(pin);
-    if (port == NOT_A_PIN || portIn == nullptr || mask == 0) return false;
+    if (port == NOT_A_PIN || port >= PortSnapshot::MAX_PORTS || portIn == nullptr || mask == 0)
+      return false;
     newPins[i] = pin;
     newPinPortIn[i] = portIn;
     newPinMask[i] = mask;
+    newPinPort[i] = port;
   }
 
   _pinCount = count;
@@ -48,6 +51,7 @@ bool DigitalInputMonitor::begin(const uint8_t* pins, uint8_t count, uint16_t win
     _pins[i] = newPins[i];
     _pinPortIn[i] = newPinPortIn[i];
     _pinMask[i] = newPinMask[i];
+    _pinPort[i] = newPinPort[i];
     if (usePullup)
       pinMode(_pins[i], INPUT_PULLUP);
     else
@@ -69,14 +73,73 @@ bool DigitalInputMonitor::begin(const uint8_t* pins, uint8_t count, uint16_t win
 
 void DigitalInputMonitor::onTick() {
   if (_windowReady) {
-    _pendingFrameStale = true;
-    if (_overrunCount != 0xFFFFFFFFUL) {
-      ++_overrunCount;
-    }
+    recordOverrun();
     return;
   }
-  for (uint8_t i = 0; i < _pinCount; ++i) {
-    uint8_t s = readPinState(_pinPortIn[i], _pinMask[i]);
+  uint8_t levels = 0;
+  uint8_t bit = 1;
+  for (uint8_t i = 0; i < _pinCount; ++i, bit <<= 1) {
+    if (readPinState(_pinPortIn[i], _pinMask[i])) levels |= bit;
+  }
+  accumulateSample(levels);
+}
+
+void DigitalInputMonitor::onTick(const PortSnapshot& ports) {
+  if (_windowReady) {
+    bool firstOverrun = !_pendingFrameStale;
+    recordOverrun();
+    if (firstOverrun) postEvent(ports.tick, TICK_EVENT_WINDOW_OVERRUN, 0);
+    return;
+  }
+  uint8_t levels = 0;
+  uint8_t bit = 1;
+  for (uint8_t i = 0; i < _pinCount; ++i, bit <<= 1) {
+    if (ports.isHigh(_pinPort[i], _pinMask[i])) levels |= bit;
+  }
+  accumulateSample(levels);
+  if (_windowReady) postEvent(ports.tick, TICK_EVENT_WINDOW_READY, _samplesInWindow);
+}
+
+void DigitalInputMonitor::setEventQueue(TickEventQueue* queue, uint8_t source) {
+  noInterrupts();
+  _eventQueue = queue;
+  _eventSource = source;
+  interrupts();
+}
+
+void DigitalInputMonitor::postEvent(uint32_t tick, uint8_t code, uint16_t value) {
+  if (_eventQueue == nullptr) return;
+  TickEvent event;
+  event.tick = tick;
+  event.source = _eventSource;
+  event.code = code;
+  event.value = value;
+  (void)_eventQueue->push(event);
+}
+
+void DigitalInputMonitor::recordOverrun() {
+  _pendingFrameStale = true;
+  if (_overrunCount != 0xFFFFFFFFUL) {
+    _overrunLock.writeBegin();
+    ++_overrunCount;
+    _overrunLock.writeEnd();
+  }
+}
+
+uint32_t DigitalInputMonitor::readOverrunCount() const {
+  uint32_t v = 0;
+  uint8_t sequence = 0;
+  do {
+    sequence = _overrunLock.readBegin();
+    v = _overrunCount;
+  } while (_overrunLock.readRetry(sequence));
+  return v;
+}
+
+void DigitalInputMonitor::accumulateSample(uint8_t levels) {
+  uint8_t bit = 1;
+  for (uint8_t i = 0; i < _pinCount; ++i, bit <<= 1) {
+    uint8_t s = (levels & bit) ? 1 : 0;
     if (s) _highCnt[i]++;
     if (s && !_lastState[i]) _edgeCnt[i]++;
     _lastState[i] = s;
@@ -135,21 +198,25 @@ void DigitalInputMonitor::updateIfReady() {
   }
 }
 
+bool DigitalInputMonitor::isWindowReady() const {
+  return _windowReady;
+}
+
 uint8_t DigitalInputMonitor::getPinCount() const {
   return _pinCount;
 }
 
 void DigitalInputMonitor::copyFrame(Frame& frame) const {
-  noInterrupts();
+  // The published frame is written only by updateIfReady() in loop context, so it cannot
+  // change under a loop-side copy; only the overrun count is ISR-owned.
   frame.pinCount = _pinCount;
   frame.frameSequence = _frameSequence;
   frame.stale = _frameStale;
-  frame.overrunCount = _overrunCount;
   for (uint8_t i = 0; i < MAX_PINS; ++i) {
     frame.frequencyMilliHz[i] = _freqMilliHz[i];
     frame.dutyPermille[i] = _dutyPermille[i];
   }
-  interrupts();
+  frame.overrunCount = readOverrunCount();
 }
 
 float DigitalInputMonitor::getFrequency(uint8_t idx) const {
@@ -158,10 +225,7 @@ float DigitalInputMonitor::getFrequency(uint8_t idx) const {
 
 uint32_t DigitalInputMonitor::getFrequencyMilliHz(uint8_t idx) const {
   if (idx >= _pinCount) return 0;
-  noInterrupts();
-  uint32_t v = _freqMilliHz[idx];
-  interrupts();
-  return v;
+  return _freqMilliHz[idx];
 }
 
 float DigitalInputMonitor::getDutyCycle(uint8_t idx) const {
@@ -170,29 +234,17 @@ float DigitalInputMonitor::getDutyCycle(uint8_t idx) const {
 
 uint16_t DigitalInputMonitor::getDutyPermille(uint8_t idx) const {
   if (idx >= _pinCount) return 0;
-  noInterrupts();
-  uint16_t v = _dutyPermille[idx];
-  interrupts();
-  return v;
+  return _dutyPermille[idx];
 }
 
 bool DigitalInputMonitor::isFrameStale() const {
-  noInterrupts();
-  bool v = _frameStale;
-  interrupts();
-  return v;
+  return _frameStale;
 }
 
 uint32_t DigitalInputMonitor::getFrameSequence() const {
-  noInterrupts();
-  uint32_t v = _frameSequence;
-  interrupts();
-  return v;
+  return _frameSequence;
 }
 
 uint32_t DigitalInputMonitor::getOverrunCount() const {
-  noInterrupts();
-  uint32_t v = _overrunCount;
-  interrupts();
-  return v;
+  return readOverrunCount();
 }
\ No newline at end of file
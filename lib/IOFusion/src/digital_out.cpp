@@ -1,9 +1,11 @@
 #include "digital_out.h"
 
-DigitalOut::DigitalOut() : _pinCount(0) {
+DigitalOut::DigitalOut() : _portCount(0), _state(0), _pinCount(0) {
   for (uint8_t i = 0; i < MAX_PINS; ++i) {
     _pins[i] = 0;
-    _state[i] = false;
+    _slot[i] = 0;
+    _mask[i] = 0;
+    _portOut[i] = nullptr;
   }
 }
 
@@ -16,13 +18,40 @@ bool DigitalOut::begin(const uint8_t* pins, uint8_t count, bool initialHigh) {
     return false;
   }
 
+  uint8_t slot[MAX_PINS];
+  uint8_t mask[MAX_PINS];
+  volatile uint8_t* portOut[MAX_PINS] = {nullptr};
+  uint8_t portCount = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    for (uint8_t prev = 0; prev < i; ++prev) {
+      if (pins[prev] == pins[i]) return false;
+    }
+    uint8_t port = digitalPinToPort(pins[i]);
+    if (port == NOT_A_PIN) return false;
+    volatile uint8_t* out = portOutputRegister(port);
+    mask[i] = digitalPinToBitMask(pins[i]);
+    if (out == nullptr || mask[i] == 0) return false;
+    uint8_t s = 0;
+    while (s < portCount && portOut[s] != out) ++s;
+    if (s == portCount) portOut[portCount++] = out;
+    slot[i] = s;
+  }
+
   _pinCount = count;
+  _portCount = portCount;
+  for (uint8_t i = 0; i < MAX_PINS; ++i) {
+    _portOut[i] = portOut[i];
+  }
   for (uint8_t i = 0; i < _pinCount; ++i) {
     _pins[i] = pins[i];
-    _state[i] = initialHigh;
-    pinMode(_pins[i], OUTPUT);
+    _slot[i] = slot[i];
+    _mask[i] = mask[i];
+    // digitalWrite() once also detaches any timer PWM from the pin; the latch is set before
+    // the pin becomes an output, so it never shows the wrong level.
     digitalWrite(_pins[i], initialHigh ? HIGH : LOW);
+    pinMode(_pins[i], OUTPUT);
   }
+  _state = initialHigh ? allPins() : 0;
 
   return true;
 }
@@ -31,8 +60,8 @@ bool DigitalOut::write(uint8_t idx, bool high) {
   if (!validIndex(idx)) {
     return false;
   }
-  _state[idx] = high;
-  digitalWrite(_pins[idx], high ? HIGH : LOW);
+  uint8_t bit = static_cast<uint8_t>(1U << idx);
+  writePorts(bit, high ? bit : 0);
   return true;
 }
 
@@ -40,8 +69,8 @@ bool DigitalOut::toggle(uint8_t idx) {
   if (!validIndex(idx)) {
     return false;
   }
-  _state[idx] = !_state[idx];
-  digitalWrite(_pins[idx], _state[idx] ? HIGH : LOW);
+  uint8_t bit = static_cast<uint8_t>(1U << idx);
+  writePorts(bit, static_cast<uint8_t>(~_state));
   return true;
 }
 
@@ -49,10 +78,32 @@ bool DigitalOut::setAll(bool high) {
   if (_pinCount == 0) {
     return false;
   }
-  for (uint8_t i = 0; i < _pinCount; ++i) {
-    _state[i] = high;
-    digitalWrite(_pins[i], high ? HIGH : LOW);
+  writePorts(allPins(), high ? 0xFF : 0);
+  return true;
+}
+
+bool DigitalOut::writeMask(uint8_t mask, uint8_t values) {
+  if (_pinCount == 0 || (mask & ~allPins()) != 0) {
+    return false;
+  }
+  writePorts(mask, values);
+  return true;
+}
+
+bool DigitalOut::stage(uint8_t idx, bool high) {
+  if (!validIndex(idx)) {
+    return false;
   }
+  uint8_t bit = static_cast<uint8_t>(1U << idx);
+  _state = high ? static_cast<uint8_t>(_state | bit) : static_cast<uint8_t>(_state & ~bit);
+  return true;
+}
+
+bool DigitalOut::apply() {
+  if (_pinCount == 0) {
+    return false;
+  }
+  writePorts(allPins(), _state);
   return true;
 }
 
@@ -60,10 +111,14 @@ bool DigitalOut::getState(uint8_t idx, bool& out) const {
   if (!validIndex(idx)) {
     return false;
   }
-  out = _state[idx];
+  out = (_state & (1U << idx)) != 0;
   return true;
 }
 
+uint8_t DigitalOut::getStates() const {
+  return _state;
+}
+
 uint8_t DigitalOut::getPinCount() const {
   return _pinCount;
 }
@@ -71,3 +126,35 @@ uint8_t DigitalOut::getPinCount() const {
 bool DigitalOut::validIndex(uint8_t idx) const {
   return idx < _pinCount;
 }
+
+uint8_t DigitalOut::allPins() const {
+  return static_cast<uint8_t>((1U << _pinCount) - 1U);
+}
+
+void DigitalOut::writePorts(uint8_t mask, uint8_t values) {
+  // Translate pin bits into per-port set and clear masks first, so the critical section is
+  // only the stores.
+  uint8_t set[MAX_PINS] = {0};
+  uint8_t clear[MAX_PINS] = {0};
+  uint8_t touched = 0;
+  for (uint8_t i = 0; i < _pinCount; ++i) {
+    uint8_t bit = static_cast<uint8_t>(1U << i);
+    if ((mask & bit) == 0) continue;
+    uint8_t s = _slot[i];
+    if ((values & bit) != 0) {
+      set[s] |= _mask[i];
+    } else {
+      clear[s] |= _mask[i];
+    }
+    touched |= static_cast<uint8_t>(1U << s);
+  }
+  _state = static_cast<uint8_t>((_state & ~mask) | (values & mask));
+
+  noInterrupts();
+  for (uint8_t s = 0; s < _portCount; ++s) {
+    if ((touched & (1U << s)) == 0) continue;
+    volatile uint8_t* out = _portOut[s];
+    *out = static_cast<uint8_t>((*out & ~clear[s]) | set[s]);
+  }
+  interrupts();
+}
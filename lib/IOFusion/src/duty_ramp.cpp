@@ -0,0 +1,170 @@
+#include "duty_ramp.h"
+
+namespace {
+
+constexpr uint16_t kMaxPermille = 1000;
+
+uint16_t clampPermille(uint16_t permille) {
+  return permille > kMaxPermille ? kMaxPermille : permille;
+}
+
+int32_t stepFor(uint16_t fromPermille, uint16_t toPermille, uint32_t ticks) {
+  int32_t deltaQ16 = (static_cast<int32_t>(toPermille) - static_cast<int32_t>(fromPermille)) *
+                     65536L;
+  return deltaQ16 / static_cast<int32_t>(ticks);
+}
+
+}  // namespace
+
+DutyRamp::DutyRamp() {}
+
+bool DutyRamp::begin(const Config& config) {
+  if (config.pwm == nullptr || config.tickHz == 0) return false;
+  for (uint8_t ch = 0; ch < CHANNELS; ++ch) halt(_channels[ch]);
+  _pwm = config.pwm;
+  _tickHz = config.tickHz;
+  for (uint8_t ch = 0; ch < CHANNELS; ++ch) {
+    _channels[ch].dutyQ16 = 0;
+    _channels[ch].writtenPermille = 0;
+    _pwm->setDutyPermille(ch, 0);
+  }
+  return true;
+}
+
+bool DutyRamp::setDuty(uint8_t channel, uint16_t permille) {
+  if (_pwm == nullptr || channel >= CHANNELS) return false;
+  permille = clampPermille(permille);
+  Channel& c = _channels[channel];
+  halt(c);
+  c.dutyQ16 = static_cast<uint32_t>(permille) << 16;
+  c.writtenPermille = permille;
+  _pwm->setDutyPermille(channel, permille);
+  return true;
+}
+
+bool DutyRamp::rampTo(uint8_t channel, uint16_t targetPermille, uint16_t slewPermillePerSec) {
+  if (_pwm == nullptr || channel >= CHANNELS || slewPermillePerSec == 0) return false;
+  targetPermille = clampPermille(targetPermille);
+  Channel& c = _channels[channel];
+  halt(c);
+
+  uint16_t from = c.writtenPermille;
+  uint32_t delta = from > targetPermille ? from - targetPermille : targetPermille - from;
+  uint32_t ticks = (delta * _tickHz + slewPermillePerSec - 1U) / slewPermillePerSec;
+  if (ticks == 0) ticks = 1;
+  c.segmentTarget[0] = targetPermille;
+  c.segmentTicks[0] = ticks;
+  c.segmentStepQ16[0] = stepFor(from, targetPermille, ticks);
+  c.segmentCount = 1;
+  c.repeat = false;
+  start(c);
+  return true;
+}
+
+bool DutyRamp::playProfile(uint8_t channel, const Segment* segments, uint8_t count,
+                           bool repeat) {
+  if (_pwm == nullptr || channel >= CHANNELS || segments == nullptr || count == 0 ||
+      count > MAX_SEGMENTS) {
+    return false;
+  }
+  Channel& c = _channels[channel];
+  halt(c);
+
+  uint16_t from = c.writtenPermille;
+  for (uint8_t i = 0; i < count; ++i) {
+    uint16_t to = clampPermille(segments[i].dutyPermille);
+    uint32_t ticks = ticksForMs(segments[i].durationMs);
+    c.segmentTarget[i] = to;
+    c.segmentTicks[i] = ticks;
+    c.segmentStepQ16[i] = stepFor(from, to, ticks);
+    from = to;
+  }
+  c.wrapStepQ16 = stepFor(from, c.segmentTarget[0], c.segmentTicks[0]);
+  c.segmentCount = count;
+  c.repeat = repeat;
+  start(c);
+  return true;
+}
+
+void DutyRamp::stop(uint8_t channel) {
+  if (channel >= CHANNELS) return;
+  halt(_channels[channel]);
+}
+
+void DutyRamp::onTick() {
+  if (_pwm == nullptr) return;
+  _dutyLock.writeBegin();
+  for (uint8_t ch = 0; ch < CHANNELS; ++ch) {
+    Channel& c = _channels[ch];
+    if (!advance(c)) continue;
+    uint16_t permille = static_cast<uint16_t>((c.dutyQ16 + 0x8000UL) >> 16);
+    // A write refused during a staged Timer1 update is retried on the next tick.
+    if (permille != c.writtenPermille && _pwm->writeDutyPermilleFromIsr(ch, permille)) {
+      c.writtenPermille = permille;
+    }
+  }
+  _dutyLock.writeEnd();
+}
+
+uint16_t DutyRamp::getDutyPermille(uint8_t channel) const {
+  if (channel >= CHANNELS) return 0;
+  uint16_t permille;
+  uint8_t sequence;
+  do {
+    sequence = _dutyLock.readBegin();
+    permille = _channels[channel].writtenPermille;
+  } while (_dutyLock.readRetry(sequence));
+  return permille;
+}
+
+bool DutyRamp::isActive(uint8_t channel) const {
+  return channel < CHANNELS && _channels[channel].active;
+}
+
+uint32_t DutyRamp::ticksForMs(uint16_t durationMs) const {
+  uint32_t ticks = (static_cast<uint32_t>(durationMs) * _tickHz + 500U) / 1000U;
+  return ticks == 0 ? 1 : ticks;
+}
+
+void DutyRamp::halt(Channel& channel) {
+  noInterrupts();
+  channel.active = false;
+  interrupts();
+  // The tick no longer touches this channel, so its duty can be resynchronized to what was
+  // actually written.
+  channel.dutyQ16 = static_cast<uint32_t>(channel.writtenPermille) << 16;
+}
+
+void DutyRamp::start(Channel& channel) {
+  noInterrupts();
+  channel.segmentIndex = 0;
+  channel.stepQ16 = channel.segmentStepQ16[0];
+  channel.remainingTicks = channel.segmentTicks[0];
+  channel.active = true;
+  interrupts();
+}
+
+bool DutyRamp::advance(Channel& c) {
+  if (!c.active) return false;
+  if (c.remainingTicks > 1) {
+    --c.remainingTicks;
+    c.dutyQ16 += static_cast<uint32_t>(c.stepQ16);
+    return true;
+  }
+
+  // Land exactly on the segment target so rounding in the step never accumulates.
+  c.dutyQ16 = static_cast<uint32_t>(c.segmentTarget[c.segmentIndex]) << 16;
+  uint8_t next = static_cast<uint8_t>(c.segmentIndex + 1U);
+  if (next < c.segmentCount) {
+    c.segmentIndex = next;
+    c.stepQ16 = c.segmentStepQ16[next];
+    c.remainingTicks = c.segmentTicks[next];
+  } else if (c.repeat) {
+    c.segmentIndex = 0;
+    c.stepQ16 = c.wrapStepQ16;
+    c.remainingTicks = c.segmentTicks[0];
+  } else {
+    c.active = false;
+  }
+  return true;
+}
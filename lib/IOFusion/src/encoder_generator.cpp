@@ -1,5 +1,7 @@
 #include "encoder_generator.h"
 
+#include "step_rate.h"
+
 namespace {
 
 bool readControlState(volatile uint8_t* portIn, uint8_t mask, bool activeHigh) {
@@ -7,21 +9,15 @@ bool readControlState(volatile uint8_t* portIn, uint8_t mask, bool activeHigh) {
   return activeHigh ? levelHigh : !levelHigh;
 }
 
-int32_t saturatingIncrement(int32_t value) {
-  if (value == INT32_MAX) return INT32_MAX;
-  return value + 1;
-}
-
-int32_t saturatingDecrement(int32_t value) {
-  if (value == INT32_MIN) return INT32_MIN;
-  return value - 1;
-}
-
 }  // namespace
 
 bool EncoderGenerator::begin(const Config& config) {
-  return begin(config.pinA, config.pinB, config.upPin, config.downPin, config.usePullup,
-               config.activeHigh);
+  if (!begin(config.pinA, config.pinB, config.upPin, config.downPin, config.usePullup,
+             config.activeHigh)) {
+    return false;
+  }
+  _tickHz = config.tickHz;
+  return true;
 }
 
 bool EncoderGenerator::begin(uint8_t pinA, uint8_t pinB, uint8_t up, uint8_t down, bool usePullup,
@@ -43,8 +39,9 @@ bool EncoderGenerator::begin(uint8_t pinA, uint8_t pinB, uint8_t up, uint8_t dow
   volatile uint8_t* downPortIn = portInputRegister(portDown);
   uint8_t upMask = digitalPinToBitMask(up);
   uint8_t downMask = digitalPinToBitMask(down);
-  if (portUp == NOT_A_PIN || portDown == NOT_A_PIN || upPortIn == nullptr ||
-      downPortIn == nullptr || upMask == 0 || downMask == 0)
+  if (portUp == NOT_A_PIN || portDown == NOT_A_PIN || portUp >= PortSnapshot::MAX_PORTS ||
+      portDown >= PortSnapshot::MAX_PORTS || upPortIn == nullptr || downPortIn == nullptr ||
+      upMask == 0 || downMask == 0)
     return false;
 
   _pinA = pinA;
@@ -59,6 +56,8 @@ bool EncoderGenerator::begin(uint8_t pinA, uint8_t pinB, uint8_t up, uint8_t dow
   _downPortIn = downPortIn;
   _upMask = upMask;
   _downMask = downMask;
+  _upPort = portUp;
+  _downPort = portDown;
 
   pinMode(_pinA, OUTPUT);
   pinMode(_pinB, OUTPUT);
@@ -70,58 +69,337 @@ bool EncoderGenerator::begin(uint8_t pinA, uint8_t pinB, uint8_t up, uint8_t dow
     pinMode(_pinDown, INPUT);
   }
 
-  *_portAOut &= ~_maskA;
-  *_portBOut &= ~_maskB;
-  _state = 0;
   _activeHigh = activeHigh;
+  _tickHz = 0;
   noInterrupts();
+  _state = 0;
   _position = 0;
   _directionUp = true;
+  _fullRate = true;
+  _stepIncrement = 0;
+  _phase = 0;
+  _moveState = MOVE_IDLE;
+  _velocity = 0;
+  _pinZ = 255;
+  _portZOut = nullptr;
+  _maskZ = 0;
+  _countsPerRevolution = 0;
+  _revolutionCount = 0;
+  _revolutions = 0;
+  groupOutputs();
+  writeOutputs();
   interrupts();
 
   return true;
 }
 
+bool EncoderGenerator::beginIndex(const IndexConfig& config) {
+  uint16_t countsPerRevolution = config.countsPerRevolution;
+  volatile uint8_t* portZOut = nullptr;
+  uint8_t maskZ = 0;
+  if (countsPerRevolution != 0) {
+    if (config.offset >= countsPerRevolution || config.width == 0 ||
+        config.width >= countsPerRevolution) {
+      return false;
+    }
+    if (config.pin == _pinA || config.pin == _pinB) return false;
+    uint8_t portZ = digitalPinToPort(config.pin);
+    portZOut = portOutputRegister(portZ);
+    maskZ = digitalPinToBitMask(config.pin);
+    if (portZ == NOT_A_PIN || portZOut == nullptr || maskZ == 0) return false;
+  }
+
+  if (portZOut != nullptr) {
+    noInterrupts();
+    *portZOut &= ~maskZ;
+    interrupts();
+    pinMode(config.pin, OUTPUT);
+  }
+
+  noInterrupts();
+  _pinZ = countsPerRevolution != 0 ? config.pin : 255;
+  _portZOut = portZOut;
+  _maskZ = maskZ;
+  _countsPerRevolution = countsPerRevolution;
+  _indexOffset = config.offset;
+  _indexWidth = config.width;
+  // Revolutions are counted from the current position: floor division keeps revolution -1
+  // just below zero.
+  int32_t revolutions = 0;
+  int32_t count = 0;
+  if (countsPerRevolution != 0) {
+    revolutions = _position / countsPerRevolution;
+    count = _position % countsPerRevolution;
+    if (count < 0) {
+      count += countsPerRevolution;
+      --revolutions;
+    }
+  }
+  _positionLock.writeBegin();
+  _revolutionCount = static_cast<uint16_t>(count);
+  _revolutions = revolutions;
+  _positionLock.writeEnd();
+  groupOutputs();
+  writeOutputs();
+  interrupts();
+  return true;
+}
+
 void EncoderGenerator::onTick() {
-  // ISR-owned position/state updates; getters read with interrupt guards
-  bool upHigh = readControlState(_upPortIn, _upMask, _activeHigh);
-  bool downHigh = readControlState(_downPortIn, _downMask, _activeHigh);
-  bool stepped = false;
-  if (upHigh && !downHigh) {
-    _directionUp = true;
-    _state = (_state + 1) & 3;
-    _position = saturatingIncrement(_position);
-    stepped = true;
-  } else if (!upHigh && downHigh) {
-    _directionUp = false;
-    _state = (_state - 1) & 3;
-    _position = saturatingDecrement(_position);
-    stepped = true;
+  if (_moveState != MOVE_IDLE) {
+    runMove();
+    return;
+  }
+  step(readControlState(_upPortIn, _upMask, _activeHigh),
+       readControlState(_downPortIn, _downMask, _activeHigh));
+}
+
+void EncoderGenerator::onTick(const PortSnapshot& ports) {
+  bool wasUp = _directionUp;
+  if (_moveState != MOVE_IDLE) {
+    runMove();
   } else {
-    // both low or both high: do nothing
-  }
-  // write outputs once if a step occurred
-  if (stepped) {
-    uint8_t s = _state;
-    if (_portAOut) {
-      if (s == 2 || s == 3)
-        *_portAOut |= _maskA;
-      else
-        *_portAOut &= ~_maskA;
+    step(ports.isHigh(_upPort, _upMask) == _activeHigh,
+         ports.isHigh(_downPort, _downMask) == _activeHigh);
+  }
+  if (_eventQueue != nullptr && _directionUp != wasUp) {
+    TickEvent event;
+    event.tick = ports.tick;
+    event.source = _eventSource;
+    event.code = TICK_EVENT_DIRECTION_CHANGED;
+    event.value = _directionUp ? 1 : 0;
+    (void)_eventQueue->push(event);
+  }
+}
+
+void EncoderGenerator::setEventQueue(TickEventQueue* queue, uint8_t source) {
+  noInterrupts();
+  _eventQueue = queue;
+  _eventSource = source;
+  interrupts();
+}
+
+bool EncoderGenerator::setStepRateMilliHz(uint32_t stepMilliHz) {
+  uint32_t increment = 0;
+  bool fullRate = false;
+  uint32_t tickMilliHz = static_cast<uint32_t>(_tickHz) * 1000U;
+  if (!stepIncrementForMilliHz(stepMilliHz, tickMilliHz, increment, fullRate)) return false;
+  noInterrupts();
+  _fullRate = fullRate;
+  _stepIncrement = increment;
+  interrupts();
+  return true;
+}
+
+uint32_t EncoderGenerator::getStepRateMilliHz() const {
+  uint32_t tickMilliHz = static_cast<uint32_t>(_tickHz) * 1000U;
+  if (tickMilliHz == 0) return 0;
+  noInterrupts();
+  bool fullRate = _fullRate;
+  uint32_t increment = _stepIncrement;
+  interrupts();
+  return stepRateMilliHz(increment, fullRate, tickMilliHz);
+}
+
+bool EncoderGenerator::moveTo(int32_t target, uint16_t maxStepsPerSecond,
+                              uint32_t accelStepsPerSecond2) {
+  uint32_t tickHz = _tickHz;
+  if (tickHz == 0 || maxStepsPerSecond == 0 || maxStepsPerSecond >= tickHz) return false;
+  if (accelStepsPerSecond2 == 0 || _moveState != MOVE_IDLE) return false;
+
+  // Acceleration per tick in Q48 steps: a * 2^48 / tickHz^2, split into the Q32 increment
+  // and a 16-bit fraction. tickHz^2 fits 32 bits because tickHz is 16-bit.
+  uint32_t tickSquared = tickHz * tickHz;
+  uint64_t scaled = static_cast<uint64_t>(accelStepsPerSecond2) << 32;
+  uint64_t accel = scaled / tickSquared;
+  if (accel >= 0x80000000UL) return false;
+  uint32_t remainder = static_cast<uint32_t>(scaled % tickSquared);
+  uint16_t accelFraction =
+      static_cast<uint16_t>((static_cast<uint64_t>(remainder) << 16) / tickSquared);
+  uint32_t maxVelocity =
+      static_cast<uint32_t>((static_cast<uint64_t>(maxStepsPerSecond) << 32) / tickHz);
+
+  noInterrupts();
+  int32_t position = _position;
+  int64_t distance = static_cast<int64_t>(target) - position;
+  _moveTarget = target;
+  if (distance != 0) {
+    _moveUp = distance > 0;
+    _moveRemaining = static_cast<uint32_t>(distance > 0 ? distance : -distance);
+    _rampSteps = 0;
+    _velocity = 0;
+    _velocityFraction = 0;
+    _maxVelocity = maxVelocity;
+    _minVelocity = 0;
+    _accel = static_cast<uint32_t>(accel);
+    _accelFraction = accelFraction;
+    _phase = 0;
+    _moveState = MOVE_ACCEL;
+  }
+  interrupts();
+  return true;
+}
+
+void EncoderGenerator::stopMove() {
+  noInterrupts();
+  if (_moveState != MOVE_IDLE && _rampSteps < _moveRemaining) {
+    // Ramping down takes as many steps as ramping up did, so that many remain.
+    uint32_t skipped = _moveRemaining - _rampSteps;
+    _moveTarget = _moveUp ? _moveTarget - static_cast<int32_t>(skipped)
+                          : _moveTarget + static_cast<int32_t>(skipped);
+    _moveRemaining = _rampSteps;
+  }
+  if (_moveRemaining == 0) {
+    _moveState = MOVE_IDLE;
+    _velocity = 0;
+  } else if (_moveState != MOVE_IDLE) {
+    _moveState = MOVE_DECEL;
+  }
+  interrupts();
+}
+
+bool EncoderGenerator::isMoving() const {
+  return _moveState != MOVE_IDLE;
+}
+
+int32_t EncoderGenerator::getMoveTarget() const {
+  // Written only from the loop, so no masking is needed.
+  return _moveTarget;
+}
+
+void EncoderGenerator::runMove() {
+  MoveState state = _moveState;
+  bool accelerating = state == MOVE_ACCEL;
+  if (accelerating) {
+    uint16_t fraction = static_cast<uint16_t>(_velocityFraction + _accelFraction);
+    uint32_t delta = _accel + (fraction < _velocityFraction ? 1U : 0U);
+    _velocityFraction = fraction;
+    if (_maxVelocity - _velocity <= delta) {
+      _velocity = _maxVelocity;
+      state = MOVE_CRUISE;
+    } else {
+      _velocity += delta;
+    }
+  } else if (state == MOVE_DECEL) {
+    uint16_t fraction = static_cast<uint16_t>(_velocityFraction - _accelFraction);
+    uint32_t delta = _accel + (fraction > _velocityFraction ? 1U : 0U);
+    _velocityFraction = fraction;
+    _velocity = _velocity - _minVelocity <= delta ? _minVelocity : _velocity - delta;
+  }
+
+  uint32_t previous = _phase;
+  _phase += _velocity;
+  if (_phase < previous) {
+    _directionUp = _moveUp;
+    emitStep(_moveUp);
+    --_moveRemaining;
+    if (accelerating && ++_rampSteps == 1) _minVelocity = _velocity;
+    if (_moveRemaining == 0) {
+      state = MOVE_IDLE;
+      _velocity = 0;
+    } else if (state != MOVE_DECEL && _moveRemaining <= _rampSteps) {
+      state = MOVE_DECEL;
+    }
+  }
+  _moveState = state;
+}
+
+bool EncoderGenerator::stepDue() {
+  if (_fullRate) return true;
+  uint32_t previous = _phase;
+  _phase += _stepIncrement;
+  return _phase < previous;
+}
+
+void EncoderGenerator::step(bool upHigh, bool downHigh) {
+  // both low or both high: do nothing
+  if (upHigh == downHigh) return;
+  // The commanded direction is tracked every tick; the phase accumulator paces the steps.
+  _directionUp = upHigh;
+  if (!stepDue()) return;
+  emitStep(upHigh);
+}
+
+void EncoderGenerator::emitStep(bool up) {
+  // ISR-owned position/state updates; getPosition() reads under _positionLock
+  int32_t position = saturatingStep(_position, up);
+  uint16_t count = _revolutionCount;
+  int32_t revolutions = _revolutions;
+  if (_countsPerRevolution != 0 && position != _position) {
+    if (up) {
+      if (++count == _countsPerRevolution) {
+        count = 0;
+        ++revolutions;
+      }
+    } else {
+      if (count == 0) {
+        count = _countsPerRevolution;
+        --revolutions;
+      }
+      --count;
     }
-    if (_portBOut) {
-      if (s == 1 || s == 2)
-        *_portBOut |= _maskB;
-      else
-        *_portBOut &= ~_maskB;
+  }
+  _state = (_state + (up ? 1 : 3)) & 3;
+  _positionLock.writeBegin();
+  _position = position;
+  _revolutionCount = count;
+  _revolutions = revolutions;
+  _positionLock.writeEnd();
+  writeOutputs();
+}
+
+void EncoderGenerator::groupOutputs() {
+  volatile uint8_t* ports[OUTPUT_SLOTS] = {_portAOut, _portBOut, _portZOut};
+  uint8_t masks[OUTPUT_SLOTS] = {_maskA, _maskB, _maskZ};
+  _outSlotCount = 0;
+  for (uint8_t slot = 0; slot < OUTPUT_SLOTS; ++slot) {
+    _outPort[slot] = nullptr;
+    _outMask[slot] = 0;
+    _outMaskA[slot] = 0;
+    _outMaskB[slot] = 0;
+    _outMaskZ[slot] = 0;
+  }
+  for (uint8_t output = 0; output < OUTPUT_SLOTS; ++output) {
+    if (ports[output] == nullptr || masks[output] == 0) continue;
+    uint8_t slot = 0;
+    while (slot < _outSlotCount && _outPort[slot] != ports[output]) ++slot;
+    if (slot == _outSlotCount) {
+      _outPort[slot] = ports[output];
+      ++_outSlotCount;
     }
+    _outMask[slot] |= masks[output];
+    uint8_t* channelMasks = output == 0 ? _outMaskA : (output == 1 ? _outMaskB : _outMaskZ);
+    channelMasks[slot] |= masks[output];
+  }
+}
+
+void EncoderGenerator::writeOutputs() {
+  uint8_t s = _state;
+  bool a = (s == 2 || s == 3);
+  bool b = (s == 1 || s == 2);
+  bool z = false;
+  if (_countsPerRevolution != 0) {
+    uint16_t count = _revolutionCount;
+    uint16_t sinceIndex = count >= _indexOffset
+                              ? static_cast<uint16_t>(count - _indexOffset)
+                              : static_cast<uint16_t>(count + _countsPerRevolution - _indexOffset);
+    z = sinceIndex < _indexWidth;
+  }
+  for (uint8_t slot = 0; slot < _outSlotCount; ++slot) {
+    uint8_t level = static_cast<uint8_t>((a ? _outMaskA[slot] : 0) | (b ? _outMaskB[slot] : 0) |
+                                         (z ? _outMaskZ[slot] : 0));
+    volatile uint8_t* out = _outPort[slot];
+    *out = static_cast<uint8_t>((*out & ~_outMask[slot]) | level);
   }
 }
 
 int32_t EncoderGenerator::getPosition() {
-  noInterrupts();
-  int32_t v = _position;
-  interrupts();
+  int32_t v = 0;
+  uint8_t sequence = 0;
+  do {
+    sequence = _positionLock.readBegin();
+    v = _position;
+  } while (_positionLock.readRetry(sequence));
   return v;
 }
 
@@ -130,15 +408,34 @@ void EncoderGenerator::reset() {
   _position = 0;
   _state = 0;
   _directionUp = true;
-  // set outputs to known idle (both LOW)
-  if (_portAOut) *_portAOut &= ~_maskA;
-  if (_portBOut) *_portBOut &= ~_maskB;
+  _phase = 0;
+  _moveState = MOVE_IDLE;
+  _velocity = 0;
+  _revolutionCount = 0;
+  _revolutions = 0;
+  // A and B return to idle (both LOW); Z follows the new origin.
+  writeOutputs();
   interrupts();
 }
 
+int32_t EncoderGenerator::getPosition(int32_t& revolutions) {
+  int32_t v = 0;
+  uint8_t sequence = 0;
+  do {
+    sequence = _positionLock.readBegin();
+    v = _position;
+    revolutions = _revolutions;
+  } while (_positionLock.readRetry(sequence));
+  return v;
+}
+
+int32_t EncoderGenerator::getRevolutions() {
+  int32_t revolutions = 0;
+  (void)getPosition(revolutions);
+  return revolutions;
+}
+
 bool EncoderGenerator::getDirection() {
-  noInterrupts();
-  bool d = _directionUp;
-  interrupts();
-  return d;
+  // Single-byte flag: a plain volatile read is already atomic.
+  return _directionUp;
 }
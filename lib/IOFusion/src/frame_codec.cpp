@@ -0,0 +1,90 @@
+#include "frame_codec.h"
+
+void FrameEncoder::begin(uint8_t type, uint8_t sequence) {
+  _record[0] = type;
+  _record[1] = sequence;
+  _length = 2;
+  _overflow = false;
+}
+
+bool FrameEncoder::putU8(uint8_t value) {
+  if (_length >= 2 + MAX_PAYLOAD) {
+    _overflow = true;
+    return false;
+  }
+  _record[_length++] = value;
+  return true;
+}
+
+bool FrameEncoder::putU16(uint16_t value) {
+  if (_length + 2 > 2 + MAX_PAYLOAD) {
+    _overflow = true;
+    return false;
+  }
+  _record[_length++] = static_cast<uint8_t>(value);
+  _record[_length++] = static_cast<uint8_t>(value >> 8);
+  return true;
+}
+
+bool FrameEncoder::putU32(uint32_t value) {
+  if (_length + 4 > 2 + MAX_PAYLOAD) {
+    _overflow = true;
+    return false;
+  }
+  for (uint8_t i = 0; i < 4; ++i) {
+    _record[_length++] = static_cast<uint8_t>(value);
+    value >>= 8;
+  }
+  return true;
+}
+
+bool FrameEncoder::putI32(int32_t value) {
+  return putU32(static_cast<uint32_t>(value));
+}
+
+uint8_t FrameEncoder::getPayloadLength() const {
+  return _length < 2 ? 0 : static_cast<uint8_t>(_length - 2);
+}
+
+uint8_t FrameEncoder::finish(uint8_t* out) {
+  if (_overflow || _length < 2) return 0;
+  uint16_t crc = crc16(0xFFFF, _record, _length);
+  // The CRC goes after the payload without becoming part of it, so finish() can be repeated.
+  _record[_length] = static_cast<uint8_t>(crc);
+  _record[_length + 1] = static_cast<uint8_t>(crc >> 8);
+  out[0] = 0;
+  uint8_t encoded = cobsEncode(_record, static_cast<uint8_t>(_length + 2), out + 1);
+  out[encoded + 1] = 0;
+  return static_cast<uint8_t>(encoded + 2);
+}
+
+uint16_t FrameEncoder::crc16(uint16_t crc, const uint8_t* data, uint8_t length) {
+  // Table-free byte update, as in avr-libc's _crc_ccitt_update().
+  for (uint8_t i = 0; i < length; ++i) {
+    uint8_t x = static_cast<uint8_t>(data[i] ^ static_cast<uint8_t>(crc));
+    x = static_cast<uint8_t>(x ^ (x << 4));
+    crc = static_cast<uint16_t>(((static_cast<uint16_t>(x) << 8) | (crc >> 8)) ^
+                                static_cast<uint8_t>(x >> 4) ^ (static_cast<uint16_t>(x) << 3));
+  }
+  return crc;
+}
+
+uint8_t FrameEncoder::cobsEncode(const uint8_t* in, uint8_t length, uint8_t* out) {
+  // Each code byte gives the distance to the next zero (or the end); zeros are dropped. With at
+  // most 253 input bytes no run reaches the 254-byte block limit.
+  uint8_t codeIndex = 0;
+  uint8_t outLength = 1;
+  uint8_t code = 1;
+  for (uint8_t i = 0; i < length; ++i) {
+    if (in[i] == 0) {
+      out[codeIndex] = code;
+      codeIndex = outLength++;
+      code = 1;
+      continue;
+    }
+    out[outLength++] = in[i];
+    ++code;
+  }
+  out[codeIndex] = code;
+  return outLength;
+}
@@ -0,0 +1,195 @@
+#include "frequency_sweep.h"
+
+namespace {
+
+// log2 of each Timer1 prescaler (1, 8, 64, 256, 1024), in clock-select order.
+const uint8_t kPrescalerShift[5] = {0, 3, 6, 8, 10};
+
+// 2^(2^-(i + 1)) in Q30, for composing fractional powers of two bit by bit.
+const uint32_t kExp2Q30[24] PROGMEM = {
+    1518500250UL, 1276901417UL, 1170923762UL, 1121280436UL, 1097253708UL, 1085434106UL,
+    1079572136UL, 1076653033UL, 1075196443UL, 1074468888UL, 1074105294UL, 1073923544UL,
+    1073832680UL, 1073787251UL, 1073764537UL, 1073753181UL, 1073747502UL, 1073744663UL,
+    1073743244UL, 1073742534UL, 1073742179UL, 1073742001UL, 1073741913UL, 1073741868UL,
+};
+
+constexpr int32_t kOneQ24 = 1L << 24;
+
+uint32_t milliHzToQ16(uint32_t milliHz) {
+  return static_cast<uint32_t>(((static_cast<uint64_t>(milliHz) << 16) + 500U) / 1000U);
+}
+
+// log2(x) in Q24 for x > 0. Each squaring of the mantissa yields one fractional bit.
+int32_t log2Q24(uint32_t x) {
+  int32_t whole = 31;
+  while ((x & 0x80000000UL) == 0) {
+    x <<= 1;
+    --whole;
+  }
+  // Mantissa in [1, 2), held in Q30 so its square still fits 32 bits.
+  uint32_t m = x >> 1;
+  int32_t result = whole * kOneQ24;
+  for (int32_t bit = kOneQ24 >> 1; bit != 0; bit >>= 1) {
+    m = static_cast<uint32_t>((static_cast<uint64_t>(m) * m) >> 30);
+    if (m >= 0x80000000UL) {
+      m >>= 1;
+      result += bit;
+    }
+  }
+  return result;
+}
+
+// 2^(exponentQ24 / 2^24) in Q28, for -4 < exponent < 4.
+uint32_t exp2Q28(int32_t exponentQ24) {
+  int32_t whole = exponentQ24 / kOneQ24;
+  if (whole * kOneQ24 > exponentQ24) --whole;
+  uint32_t fraction = static_cast<uint32_t>(exponentQ24 - whole * kOneQ24);
+
+  uint32_t m = 1UL << 30;
+  for (uint8_t i = 0; i < 24; ++i) {
+    if ((fraction & (1UL << (23U - i))) == 0) continue;
+    uint64_t product = static_cast<uint64_t>(m) * pgm_read_dword(&kExp2Q30[i]);
+    m = static_cast<uint32_t>((product + (1UL << 29)) >> 30);
+  }
+  int32_t shift = whole - 2;
+  return shift >= 0 ? m << shift : m >> -shift;
+}
+
+}  // namespace
+
+FrequencySweep::FrequencySweep() {}
+
+bool FrequencySweep::begin(const Config& config, uint32_t clockHz,
+                           uint32_t minHalfPeriodClocks) {
+  _hasNext = false;
+  if (config.steps == 0 || config.stepHz == 0 || config.stepHz > MAX_STEP_HZ) return false;
+  if (config.startMilliHz == 0 || config.startMilliHz > MAX_FREQUENCY_MILLIHZ) return false;
+  if (config.stopMilliHz == 0 || config.stopMilliHz > MAX_FREQUENCY_MILLIHZ) return false;
+  if (clockHz == 0 || clockHz > 0x1FFFFFFUL) return false;
+
+  _clockQ7 = clockHz << 7;
+  uint32_t startQ16 = milliHzToQ16(config.startMilliHz);
+  uint32_t stopQ16 = milliHzToQ16(config.stopMilliHz);
+  Step first;
+  Step last;
+  if (!stepFor(startQ16, first) || !stepFor(stopQ16, last)) return false;
+  // Sweeps are monotonic, so the endpoints bound every step in between.
+  if (first.halfPeriodClocks < minHalfPeriodClocks || last.halfPeriodClocks < minHalfPeriodClocks) {
+    return false;
+  }
+
+  int32_t deltaQ16 = 0;
+  uint32_t ratioQ28 = 1UL << 28;
+  if (config.shape == LOGARITHMIC) {
+    int32_t perStep = (log2Q24(stopQ16) - log2Q24(startQ16)) / config.steps;
+    if (perStep <= -4 * kOneQ24 || perStep >= 4 * kOneQ24) return false;
+    ratioQ28 = exp2Q28(perStep);
+  } else if (config.steps > 1) {
+    // The last step is placed exactly, so with two or more steps the increment fits 31 bits.
+    deltaQ16 = static_cast<int32_t>(
+        (static_cast<int64_t>(stopQ16) - static_cast<int64_t>(startQ16)) / config.steps);
+  }
+
+  _startQ16 = startQ16;
+  _stopQ16 = stopQ16;
+  _deltaQ16 = deltaQ16;
+  _ratioQ28 = ratioQ28;
+  _steps = config.steps;
+  _shape = config.shape;
+  _repeat = config.repeat;
+  _dwellClocks = (clockHz + config.stepHz / 2U) / config.stepHz;
+  _elapsedClocks = 0;
+  _current = first;
+  _currentIndex = 0;
+  _nextIndex = 0;
+  _nextQ16 = startQ16;
+  _hasNext = prepareNext();
+  return true;
+}
+
+const FrequencySweep::Step& FrequencySweep::current() const {
+  return _current;
+}
+
+const FrequencySweep::Step& FrequencySweep::next() const {
+  return _next;
+}
+
+bool FrequencySweep::hasNext() const {
+  return _hasNext;
+}
+
+bool FrequencySweep::onHalfPeriod() {
+  if (!_hasNext) return false;
+  _elapsedClocks += _current.halfPeriodClocks;
+  return _elapsedClocks >= _dwellClocks;
+}
+
+bool FrequencySweep::advance() {
+  if (!_hasNext) return false;
+  // Carry the overshoot so the average step rate stays exact, but never more than one step:
+  // a step shorter than a half-period of its own frequency is played for one half-period.
+  uint32_t carry = _elapsedClocks >= _dwellClocks ? _elapsedClocks - _dwellClocks : 0;
+  _elapsedClocks = carry < _dwellClocks ? carry : _dwellClocks;
+  _current = _next;
+  _currentIndex = _nextIndex;
+  _hasNext = prepareNext();
+  return _hasNext;
+}
+
+uint16_t FrequencySweep::getStepIndex() const {
+  return _currentIndex;
+}
+
+uint32_t FrequencySweep::getDwellClocks() const {
+  return _dwellClocks;
+}
+
+bool FrequencySweep::stepFor(uint32_t frequencyQ16, Step& step) const {
+  if (frequencyQ16 == 0) return false;
+  // Half-period in input clocks: clockHz / (2 * f) = (_clockQ7 << 8) / frequencyQ16.
+  uint32_t clocks;
+  if (frequencyQ16 >= (1UL << 24)) {
+    // At 256 Hz and above, dropping 8 divisor bits still leaves 16 significant ones.
+    uint32_t frequencyQ8 = frequencyQ16 >> 8;
+    clocks = (_clockQ7 + frequencyQ8 / 2U) / frequencyQ8;
+  } else {
+    // Below 256 Hz, split the 40-bit dividend into two 32-bit divisions.
+    uint32_t quotient = _clockQ7 / frequencyQ16;
+    uint32_t remainder = _clockQ7 % frequencyQ16;
+    if (quotient >= (1UL << 24)) return false;
+    clocks = (quotient << 8) + ((remainder << 8) + frequencyQ16 / 2U) / frequencyQ16;
+  }
+
+  // The fastest prescaler whose TOP fits keeps the finest frequency resolution.
+  for (uint8_t i = 0; i < 5; ++i) {
+    uint8_t shift = kPrescalerShift[i];
+    uint32_t counts = (clocks + ((1UL << shift) >> 1)) >> shift;
+    if (counts > 65536UL) continue;
+    if (counts < 2U) return false;
+    step.top = static_cast<uint16_t>(counts - 1U);
+    step.clockSelect = static_cast<uint8_t>(i + 1U);
+    step.halfPeriodClocks = counts << shift;
+    return true;
+  }
+  return false;
+}
+
+bool FrequencySweep::prepareNext() {
+  if (_nextIndex >= _steps) {
+    if (!_repeat) return false;
+    _nextIndex = 0;
+    _nextQ16 = _startQ16;
+  } else {
+    ++_nextIndex;
+    if (_nextIndex == _steps) {
+      _nextQ16 = _stopQ16;
+    } else if (_shape == LOGARITHMIC) {
+      uint64_t product = static_cast<uint64_t>(_nextQ16) * _ratioQ28;
+      _nextQ16 = static_cast<uint32_t>((product + (1UL << 27)) >> 28);
+    } else {
+      _nextQ16 += static_cast<uint32_t>(_deltaQ16);
+    }
+  }
+  return stepFor(_nextQ16, _next);
+}
@@ -0,0 +1,79 @@
+#include "idle_manager.h"
+
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
+namespace {
+
+// Enters idle sleep with interrupts already disabled and returns with them enabled.
+void sleepUntilInterrupt() {
+#if defined(__AVR__)
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  // SEI takes effect after the next instruction, so no ISR can slip in between it and SLEEP
+  // and leave the CPU asleep with its work unnoticed.
+  sei();
+  sleep_cpu();
+  sleep_disable();
+#else
+  interrupts();
+#endif
+}
+
+}  // namespace
+
+IdleManager::IdleManager() {}
+
+bool IdleManager::begin(const Config& config) {
+  if (config.sampleMs == 0 || config.sampleMs > 60000U) return false;
+  _config = config;
+  _intervalStartUs = micros();
+  _idleUs = 0;
+  _idlePermille = 0;
+  _sleepCount = 0;
+  _ready = true;
+  return true;
+}
+
+bool IdleManager::idle(PendingWorkFn pending) {
+  if (!_ready || !_config.sleepEnabled) return false;
+
+  unsigned long startUs = micros();
+  noInterrupts();
+  if (pending != nullptr && pending()) {
+    interrupts();
+    return false;
+  }
+  sleepUntilInterrupt();
+  // The waking ISR has already run by now, so its handler time is counted as idle.
+  _idleUs += static_cast<uint32_t>(micros() - startUs);
+  if (_sleepCount != 0xFFFFFFFFUL) ++_sleepCount;
+  return true;
+}
+
+bool IdleManager::update() {
+  if (!_ready) return false;
+  unsigned long nowUs = micros();
+  uint32_t elapsedUs = static_cast<uint32_t>(nowUs - _intervalStartUs);
+  if (elapsedUs < static_cast<uint32_t>(_config.sampleMs) * 1000UL) return false;
+
+  uint32_t idleUs = _idleUs < elapsedUs ? _idleUs : elapsedUs;
+  uint64_t scaled = static_cast<uint64_t>(idleUs) * 1000U + (elapsedUs / 2U);
+  _idlePermille = static_cast<uint16_t>(scaled / elapsedUs);
+  _idleUs = 0;
+  _intervalStartUs = nowUs;
+  return true;
+}
+
+uint16_t IdleManager::getIdlePermille() const {
+  return _idlePermille;
+}
+
+uint32_t IdleManager::getSleepCount() const {
+  return _sleepCount;
+}
+
+bool IdleManager::isSleepEnabled() const {
+  return _ready && _config.sleepEnabled;
+}
@@ -0,0 +1,65 @@
+#include "load_governor.h"
+
+LoadGovernor::LoadGovernor() {}
+
+bool LoadGovernor::begin(const Config& config) {
+  if (config.shedAbovePermille > 1000) return false;
+  if (config.restoreBelowPermille >= config.shedAbovePermille) return false;
+  if (config.restoreSamples == 0) return false;
+  if (config.maxLevel == 0 || config.maxLevel > MAX_LEVEL) return false;
+
+  _config = config;
+  _level = 0;
+  _previousLevel = 0;
+  _quietSamples = 0;
+  _utilizationPermille = 0;
+  _transitionCount = 0;
+  return true;
+}
+
+bool LoadGovernor::update(uint16_t utilizationPermille, uint16_t overrunTicks) {
+  _utilizationPermille = utilizationPermille;
+  uint8_t level = _level;
+
+  if (overrunTicks != 0 || utilizationPermille >= _config.shedAbovePermille) {
+    _quietSamples = 0;
+    if (level >= _config.maxLevel) return false;
+    setLevel(level + 1);
+    return true;
+  }
+
+  if (utilizationPermille > _config.restoreBelowPermille || level == 0) {
+    _quietSamples = 0;
+    return false;
+  }
+
+  if (++_quietSamples < _config.restoreSamples) return false;
+  _quietSamples = 0;
+  setLevel(level - 1);
+  return true;
+}
+
+uint8_t LoadGovernor::getLevel() const {
+  return _level;
+}
+
+uint8_t LoadGovernor::getPreviousLevel() const {
+  return _previousLevel;
+}
+
+uint16_t LoadGovernor::getUtilizationPermille() const {
+  return _utilizationPermille;
+}
+
+uint32_t LoadGovernor::getTransitionCount() const {
+  return _transitionCount;
+}
+
+void LoadGovernor::setLevel(uint8_t level) {
+  _previousLevel = _level;
+  // Single-byte store: ISR readers see either the old or the new level, never a mix.
+  _level = level;
+  if (_transitionCount != 0xFFFFFFFFUL) {
+    ++_transitionCount;
+  }
+}
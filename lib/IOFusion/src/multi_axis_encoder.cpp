@@ -0,0 +1,239 @@
+#include "multi_axis_encoder.h"
+
+#include <string.h>
+
+#include "step_rate.h"
+
+namespace {
+
+// Resolves an output pin to a port slot, adding the port when it is new.
+bool addOutput(uint8_t pin, volatile uint8_t** portOut, uint8_t& portCount, uint8_t& slot,
+               uint8_t& mask) {
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PIN) return false;
+  volatile uint8_t* out = portOutputRegister(port);
+  mask = digitalPinToBitMask(pin);
+  if (out == nullptr || mask == 0) return false;
+
+  slot = 0;
+  while (slot < portCount && portOut[slot] != out) ++slot;
+  if (slot == portCount) {
+    if (portCount == MultiAxisEncoder::MAX_PORTS) return false;
+    portOut[slot] = out;
+    ++portCount;
+  }
+  return true;
+}
+
+bool resolveInput(uint8_t pin, uint8_t& port, uint8_t& mask) {
+  port = digitalPinToPort(pin);
+  mask = digitalPinToBitMask(pin);
+  return port != NOT_A_PIN && port < PortSnapshot::MAX_PORTS &&
+         portInputRegister(port) != nullptr && mask != 0;
+}
+
+}  // namespace
+
+MultiAxisEncoder::MultiAxisEncoder() {
+  memset(_axes, 0, sizeof(_axes));
+}
+
+bool MultiAxisEncoder::begin(const Config& config) {
+  if (config.axes == nullptr || config.axisCount == 0 || config.axisCount > MAX_AXES) {
+    return false;
+  }
+
+  volatile uint8_t* portOut[MAX_PORTS] = {nullptr};
+  uint8_t portMask[MAX_PORTS] = {0};
+  uint8_t portCount = 0;
+  AxisState axes[MAX_AXES];
+  memset(axes, 0, sizeof(axes));
+
+  for (uint8_t i = 0; i < config.axisCount; ++i) {
+    const Axis& axis = config.axes[i];
+    AxisState& a = axes[i];
+    if (axis.pinA == axis.pinB) return false;
+    for (uint8_t prev = 0; prev < i; ++prev) {
+      const Axis& other = config.axes[prev];
+      if (axis.pinA == other.pinA || axis.pinA == other.pinB || axis.pinB == other.pinA ||
+          axis.pinB == other.pinB) {
+        return false;
+      }
+    }
+    if (!addOutput(axis.pinA, portOut, portCount, a.slotA, a.maskA)) return false;
+    if (!addOutput(axis.pinB, portOut, portCount, a.slotB, a.maskB)) return false;
+    if (!resolveInput(axis.upPin, a.upPort, a.upMask)) return false;
+    if (!resolveInput(axis.downPin, a.downPort, a.downMask)) return false;
+    portMask[a.slotA] |= a.maskA;
+    portMask[a.slotB] |= a.maskB;
+    a.fullRate = true;
+  }
+
+  noInterrupts();
+  _axisCount = 0;
+  for (uint8_t p = 0; p < portCount; ++p) {
+    *portOut[p] &= static_cast<uint8_t>(~portMask[p]);
+  }
+  interrupts();
+
+  for (uint8_t i = 0; i < config.axisCount; ++i) {
+    const Axis& axis = config.axes[i];
+    pinMode(axis.pinA, OUTPUT);
+    pinMode(axis.pinB, OUTPUT);
+    uint8_t inputMode = config.usePullup ? INPUT_PULLUP : INPUT;
+    pinMode(axis.upPin, inputMode);
+    pinMode(axis.downPin, inputMode);
+  }
+  for (uint8_t p = 0; p < MAX_PORTS; ++p) {
+    _portOut[p] = portOut[p];
+    _portMask[p] = portMask[p];
+    _portLevel[p] = 0;
+  }
+  memcpy(_axes, axes, sizeof(_axes));
+  _portCount = portCount;
+  _activeHigh = config.activeHigh;
+  _tickHz = config.tickHz;
+
+  noInterrupts();
+  for (uint8_t i = 0; i < MAX_AXES; ++i) _position[i] = 0;
+  _directionUp = 0xFF;
+  _axisCount = config.axisCount;
+  interrupts();
+  return true;
+}
+
+bool MultiAxisEncoder::setStepRateMilliHz(uint8_t axis, uint32_t stepMilliHz) {
+  uint32_t increment = 0;
+  bool fullRate = false;
+  uint32_t tickMilliHz = static_cast<uint32_t>(_tickHz) * 1000U;
+  if (axis >= _axisCount ||
+      !stepIncrementForMilliHz(stepMilliHz, tickMilliHz, increment, fullRate)) {
+    return false;
+  }
+  noInterrupts();
+  _axes[axis].fullRate = fullRate;
+  _axes[axis].increment = increment;
+  interrupts();
+  return true;
+}
+
+uint32_t MultiAxisEncoder::getStepRateMilliHz(uint8_t axis) const {
+  uint32_t tickMilliHz = static_cast<uint32_t>(_tickHz) * 1000U;
+  if (axis >= _axisCount || tickMilliHz == 0) return 0;
+  noInterrupts();
+  bool fullRate = _axes[axis].fullRate;
+  uint32_t increment = _axes[axis].increment;
+  interrupts();
+  return stepRateMilliHz(increment, fullRate, tickMilliHz);
+}
+
+void MultiAxisEncoder::onTick(const PortSnapshot& ports) {
+  uint8_t count = _axisCount;
+  uint8_t directions = _directionUp;
+  uint8_t stepped = 0;
+  uint8_t steppedUp = 0;
+  uint8_t dirtySlots = 0;
+
+  // Pass 1: advance every axis into the per-port output copy.
+  for (uint8_t i = 0; i < count; ++i) {
+    AxisState& a = _axes[i];
+    bool up = ports.isHigh(a.upPort, a.upMask) == _activeHigh;
+    bool down = ports.isHigh(a.downPort, a.downMask) == _activeHigh;
+    if (up == down) continue;
+    uint8_t bit = static_cast<uint8_t>(1U << i);
+    directions = up ? static_cast<uint8_t>(directions | bit)
+                    : static_cast<uint8_t>(directions & ~bit);
+    if (!a.fullRate) {
+      uint32_t previous = a.phase;
+      a.phase += a.increment;
+      if (a.phase >= previous) continue;
+    }
+
+    uint8_t s = static_cast<uint8_t>((a.state + (up ? 1U : 3U)) & 3U);
+    a.state = s;
+    stepped |= bit;
+    if (up) steppedUp |= bit;
+    // A is HIGH in states 2 and 3, B in states 1 and 2.
+    if (s >= 2) {
+      _portLevel[a.slotA] |= a.maskA;
+    } else {
+      _portLevel[a.slotA] &= static_cast<uint8_t>(~a.maskA);
+    }
+    if (s == 1 || s == 2) {
+      _portLevel[a.slotB] |= a.maskB;
+    } else {
+      _portLevel[a.slotB] &= static_cast<uint8_t>(~a.maskB);
+    }
+    dirtySlots |= static_cast<uint8_t>((1U << a.slotA) | (1U << a.slotB));
+  }
+  _directionUp = directions;
+  if (stepped == 0) return;
+
+  // Pass 2: one store per changed port, then publish all positions under one sequence.
+  writePorts(dirtySlots);
+  _positionLock.writeBegin();
+  for (uint8_t i = 0; i < count; ++i) {
+    uint8_t bit = static_cast<uint8_t>(1U << i);
+    if ((stepped & bit) == 0) continue;
+    _position[i] = saturatingStep(_position[i], (steppedUp & bit) != 0);
+  }
+  _positionLock.writeEnd();
+}
+
+void MultiAxisEncoder::onTick() {
+  PortSnapshot ports;
+  ports.capture();
+  onTick(ports);
+}
+
+void MultiAxisEncoder::writePorts(uint8_t slots) {
+  for (uint8_t p = 0; p < _portCount; ++p) {
+    if ((slots & (1U << p)) == 0) continue;
+    volatile uint8_t* out = _portOut[p];
+    *out = static_cast<uint8_t>((*out & ~_portMask[p]) | _portLevel[p]);
+  }
+}
+
+int32_t MultiAxisEncoder::getPosition(uint8_t axis) {
+  if (axis >= _axisCount) return 0;
+  int32_t v = 0;
+  uint8_t sequence = 0;
+  do {
+    sequence = _positionLock.readBegin();
+    v = _position[axis];
+  } while (_positionLock.readRetry(sequence));
+  return v;
+}
+
+uint8_t MultiAxisEncoder::getPositions(int32_t* positions, uint8_t maxCount) {
+  if (positions == nullptr) return 0;
+  uint8_t count = maxCount < _axisCount ? maxCount : _axisCount;
+  uint8_t sequence = 0;
+  do {
+    sequence = _positionLock.readBegin();
+    for (uint8_t i = 0; i < count; ++i) positions[i] = _position[i];
+  } while (_positionLock.readRetry(sequence));
+  return count;
+}
+
+bool MultiAxisEncoder::getDirection(uint8_t axis) const {
+  if (axis >= _axisCount) return true;
+  return (_directionUp & (1U << axis)) != 0;
+}
+
+uint8_t MultiAxisEncoder::getAxisCount() const {
+  return _axisCount;
+}
+
+void MultiAxisEncoder::reset() {
+  noInterrupts();
+  for (uint8_t i = 0; i < _axisCount; ++i) {
+    _axes[i].state = 0;
+    _axes[i].phase = 0;
+    _position[i] = 0;
+  }
+  _directionUp = 0xFF;
+  for (uint8_t p = 0; p < _portCount; ++p) _portLevel[p] = 0;
+  writePorts(0xFF);
+  interrupts();
+}
@@ -0,0 +1,209 @@
+#include "output_sequencer.h"
+
+#include <string.h>
+
+OutputSequencer::OutputSequencer() {
+  memset(_events, 0, sizeof(_events));
+}
+
+bool OutputSequencer::begin(const Config& config) {
+  if (config.pins == nullptr || config.pinCount == 0 || config.pinCount > MAX_CHANNELS) {
+    return false;
+  }
+
+  volatile uint8_t* portOut[MAX_PORTS] = {nullptr};
+  uint8_t channelPort[MAX_CHANNELS] = {0};
+  uint8_t channelMask[MAX_CHANNELS] = {0};
+  uint8_t portCount = 0;
+
+  for (uint8_t ch = 0; ch < config.pinCount; ++ch) {
+    uint8_t pin = config.pins[ch];
+    for (uint8_t prev = 0; prev < ch; ++prev) {
+      if (config.pins[prev] == pin) return false;
+    }
+    uint8_t port = digitalPinToPort(pin);
+    if (port == NOT_A_PIN) return false;
+    volatile uint8_t* out = portOutputRegister(port);
+    uint8_t mask = digitalPinToBitMask(pin);
+    if (out == nullptr || mask == 0) return false;
+
+    uint8_t slot = 0;
+    while (slot < portCount && portOut[slot] != out) ++slot;
+    if (slot == portCount) {
+      if (portCount == MAX_PORTS) return false;
+      portOut[slot] = out;
+      ++portCount;
+    }
+    channelPort[ch] = slot;
+    channelMask[ch] = mask;
+  }
+
+  // Other Timer2 clients may write the same PORTx registers from the tick, so the
+  // read-modify-write clears run with interrupts masked.
+  noInterrupts();
+  _channelCount = 0;
+  _playing = false;
+  _pulseStart = 0;
+  _pulseRunning = 0;
+  for (uint8_t ch = 0; ch < config.pinCount; ++ch) {
+    *portOut[channelPort[ch]] &= static_cast<uint8_t>(~channelMask[ch]);
+  }
+  interrupts();
+
+  for (uint8_t ch = 0; ch < config.pinCount; ++ch) pinMode(config.pins[ch], OUTPUT);
+  for (uint8_t p = 0; p < MAX_PORTS; ++p) _portOut[p] = portOut[p];
+  memcpy(_channelPort, channelPort, sizeof(_channelPort));
+  memcpy(_channelMask, channelMask, sizeof(_channelMask));
+  _portCount = portCount;
+  _eventCount = 0;
+  _loopCount = 0;
+  _pulseHigh = 0;
+
+  noInterrupts();
+  _channelCount = config.pinCount;
+  interrupts();
+  return true;
+}
+
+bool OutputSequencer::play(const Event* events, uint8_t eventCount, uint16_t lengthTicks,
+                           bool loop) {
+  if (events == nullptr || eventCount == 0 || eventCount > MAX_EVENTS) return false;
+  uint8_t channels = static_cast<uint8_t>((1U << _channelCount) - 1U);
+  for (uint8_t i = 0; i < eventCount; ++i) {
+    if (events[i].tick >= lengthTicks || (events[i].mask & ~channels) != 0) return false;
+    if (i != 0 && events[i].tick <= events[i - 1].tick) return false;
+  }
+
+  // With _playing clear the tick no longer reads the event table.
+  stop();
+  for (uint8_t i = 0; i < eventCount; ++i) {
+    CompiledEvent& e = _events[i];
+    memset(&e, 0, sizeof(e));
+    e.tick = events[i].tick;
+    for (uint8_t ch = 0; ch < _channelCount; ++ch) {
+      uint8_t bit = static_cast<uint8_t>(1U << ch);
+      if ((events[i].mask & bit) == 0) continue;
+      if ((events[i].values & bit) != 0) {
+        e.setMask[_channelPort[ch]] |= _channelMask[ch];
+      } else {
+        e.clearMask[_channelPort[ch]] |= _channelMask[ch];
+      }
+    }
+  }
+  _eventCount = eventCount;
+  _length = lengthTicks;
+  _loop = loop;
+  _tick = 0;
+  _nextEvent = 0;
+
+  noInterrupts();
+  _loopCount = 0;
+  _playing = true;
+  interrupts();
+  return true;
+}
+
+void OutputSequencer::stop() {
+  noInterrupts();
+  _playing = false;
+  interrupts();
+}
+
+bool OutputSequencer::isPlaying() const {
+  return _playing;
+}
+
+uint16_t OutputSequencer::getLoopCount() const {
+  noInterrupts();
+  uint16_t count = _loopCount;
+  interrupts();
+  return count;
+}
+
+bool OutputSequencer::pulse(uint8_t channel, uint16_t widthTicks, bool high) {
+  if (channel >= _channelCount || widthTicks == 0) return false;
+  uint8_t bit = static_cast<uint8_t>(1U << channel);
+  noInterrupts();
+  _pulseWidth[channel] = widthTicks;
+  _pulseHigh = high ? static_cast<uint8_t>(_pulseHigh | bit)
+                    : static_cast<uint8_t>(_pulseHigh & ~bit);
+  _pulseStart |= bit;
+  interrupts();
+  return true;
+}
+
+bool OutputSequencer::isPulsing(uint8_t channel) const {
+  if (channel >= _channelCount) return false;
+  return ((_pulseStart | _pulseRunning) & (1U << channel)) != 0;
+}
+
+uint8_t OutputSequencer::getChannelCount() const {
+  return _channelCount;
+}
+
+void OutputSequencer::onTick() {
+  uint8_t setMask[MAX_PORTS] = {0};
+  uint8_t clearMask[MAX_PORTS] = {0};
+  bool changed = false;
+
+  if (_playing) {
+    if (_nextEvent < _eventCount && _events[_nextEvent].tick == _tick) {
+      const CompiledEvent& e = _events[_nextEvent];
+      memcpy(setMask, e.setMask, sizeof(setMask));
+      memcpy(clearMask, e.clearMask, sizeof(clearMask));
+      ++_nextEvent;
+      changed = true;
+    }
+    if (++_tick >= _length) {
+      if (_loop) {
+        _tick = 0;
+        _nextEvent = 0;
+        if (_loopCount != 0xFFFF) _loopCount = static_cast<uint16_t>(_loopCount + 1U);
+      } else {
+        _playing = false;
+      }
+    }
+  }
+  if ((_pulseStart | _pulseRunning) != 0) {
+    runPulses(setMask, clearMask);
+    changed = true;
+  }
+  if (!changed) return;
+
+  for (uint8_t p = 0; p < _portCount; ++p) {
+    if ((setMask[p] | clearMask[p]) == 0) continue;
+    volatile uint8_t* out = _portOut[p];
+    *out = static_cast<uint8_t>((*out & ~clearMask[p]) | setMask[p]);
+  }
+}
+
+void OutputSequencer::runPulses(uint8_t* setMask, uint8_t* clearMask) {
+  uint8_t start = _pulseStart;
+  _pulseStart = 0;
+  uint8_t running = static_cast<uint8_t>(_pulseRunning | start);
+  for (uint8_t ch = 0; ch < _channelCount; ++ch) {
+    uint8_t bit = static_cast<uint8_t>(1U << ch);
+    if ((running & bit) == 0) continue;
+    bool drive;
+    if ((start & bit) != 0) {
+      _pulseRemaining[ch] = _pulseWidth[ch];
+      drive = (_pulseHigh & bit) != 0;
+    } else if (--_pulseRemaining[ch] == 0) {
+      drive = (_pulseHigh & bit) == 0;
+      running = static_cast<uint8_t>(running & ~bit);
+    } else {
+      continue;
+    }
+    // A pulse edge overrides a sequence event on the same pin in the same tick.
+    uint8_t port = _channelPort[ch];
+    uint8_t mask = _channelMask[ch];
+    if (drive) {
+      setMask[port] |= mask;
+      clearMask[port] &= static_cast<uint8_t>(~mask);
+    } else {
+      clearMask[port] |= mask;
+      setMask[port] &= static_cast<uint8_t>(~mask);
+    }
+  }
+  _pulseRunning = running;
+}
@@ -0,0 +1,281 @@
+#include "quadrature_decoder.h"
+
+#include <string.h>
+
+namespace {
+
+// Marks a transition that changed both A and B: the direction is unknown.
+constexpr int8_t kIllegal = 2;
+
+// Indexed by (previous << 2) | current with state = (A << 1) | B. Forward is
+// 00 -> 01 -> 11 -> 10, the sequence EncoderGenerator emits when stepping up.
+const int8_t kTransition[16] = {
+    0,  1,        -1,       kIllegal,  // from 00
+    -1, 0,        kIllegal, 1,         // from 01
+    1,  kIllegal, 0,        -1,        // from 10
+    kIllegal, -1, 1,        0,         // from 11
+};
+
+}  // namespace
+
+QuadratureDecoder::QuadratureDecoder() {
+  memset(_inputPort, 0, sizeof(_inputPort));
+  memset(_inputIn, 0, sizeof(_inputIn));
+  memset(_inputMask, 0, sizeof(_inputMask));
+  for (uint8_t i = 0; i < MAX_CHANNELS; ++i) {
+    _position[i] = 0;
+    _errorCount[i] = 0;
+    _windowAccum[i] = 0;
+    _windowLatched[i] = 0;
+    _countsPerWindow[i] = 0;
+    _countsPerSecond[i] = 0;
+  }
+}
+
+bool QuadratureDecoder::begin(const Config& config) {
+  if (config.channels == nullptr || config.channelCount == 0 ||
+      config.channelCount > MAX_CHANNELS) {
+    return false;
+  }
+  if (config.windowTicks == 0 || config.tickHz == 0) return false;
+
+  uint8_t pins[MAX_CHANNELS * 2];
+  uint8_t inputCount = static_cast<uint8_t>(config.channelCount * 2U);
+  for (uint8_t i = 0; i < config.channelCount; ++i) {
+    pins[i * 2U] = config.channels[i].pinA;
+    pins[i * 2U + 1U] = config.channels[i].pinB;
+  }
+
+  uint8_t inputPort[MAX_CHANNELS * 2] = {0};
+  volatile uint8_t* inputIn[MAX_CHANNELS * 2] = {nullptr};
+  uint8_t inputMask[MAX_CHANNELS * 2] = {0};
+  for (uint8_t i = 0; i < inputCount; ++i) {
+    for (uint8_t prev = 0; prev < i; ++prev) {
+      if (pins[prev] == pins[i]) return false;
+    }
+    uint8_t port = digitalPinToPort(pins[i]);
+    if (port == NOT_A_PIN || port >= PortSnapshot::MAX_PORTS) return false;
+    inputIn[i] = portInputRegister(port);
+    inputMask[i] = digitalPinToBitMask(pins[i]);
+    if (inputIn[i] == nullptr || inputMask[i] == 0) return false;
+    inputPort[i] = port;
+  }
+
+  noInterrupts();
+  _channelCount = 0;
+  interrupts();
+
+  for (uint8_t i = 0; i < inputCount; ++i) {
+    pinMode(pins[i], config.usePullup ? INPUT_PULLUP : INPUT);
+  }
+  memcpy(_inputPort, inputPort, sizeof(_inputPort));
+  memcpy(_inputMask, inputMask, sizeof(_inputMask));
+  for (uint8_t i = 0; i < MAX_CHANNELS * 2; ++i) _inputIn[i] = inputIn[i];
+  _windowTicks = config.windowTicks;
+  _tickHz = config.tickHz;
+  for (uint8_t i = 0; i < MAX_CHANNELS; ++i) {
+    _position[i] = 0;
+    _errorCount[i] = 0;
+    _windowAccum[i] = 0;
+    _windowLatched[i] = 0;
+    _countsPerWindow[i] = 0;
+    _countsPerSecond[i] = 0;
+  }
+  _overrunCount = 0;
+  _ticksInWindow = 0;
+  _windowReady = false;
+  _pendingFrameStale = false;
+  _frameStale = false;
+  _frameSequence = 0;
+
+  noInterrupts();
+  _channelCount = config.channelCount;
+  _lastStates = readStates();
+  interrupts();
+  return true;
+}
+
+uint8_t QuadratureDecoder::readStates() const {
+  uint8_t states = 0;
+  uint8_t inputCount = static_cast<uint8_t>(_channelCount * 2U);
+  for (uint8_t i = 0; i < inputCount; ++i) {
+    // Input 2k is A (bit 1 of channel k's state), input 2k+1 is B (bit 0).
+    if ((*_inputIn[i] & _inputMask[i]) != 0) states |= static_cast<uint8_t>(1U << (i ^ 1U));
+  }
+  return states;
+}
+
+void QuadratureDecoder::onTick(const PortSnapshot& ports) {
+  uint8_t states = 0;
+  uint8_t inputCount = static_cast<uint8_t>(_channelCount * 2U);
+  for (uint8_t i = 0; i < inputCount; ++i) {
+    if (ports.isHigh(_inputPort[i], _inputMask[i])) states |= static_cast<uint8_t>(1U << (i ^ 1U));
+  }
+  decode(states);
+  advanceWindow();
+}
+
+void QuadratureDecoder::onTick() {
+  decode(readStates());
+  advanceWindow();
+}
+
+void QuadratureDecoder::onPinChange() {
+  decode(readStates());
+}
+
+void QuadratureDecoder::decode(uint8_t states) {
+  uint8_t previous = _lastStates;
+  if (states == previous || _channelCount == 0) return;
+  _lastStates = states;
+
+  _countLock.writeBegin();
+  for (uint8_t i = 0; i < _channelCount; ++i) {
+    uint8_t shift = static_cast<uint8_t>(i * 2U);
+    uint8_t from = static_cast<uint8_t>((previous >> shift) & 3U);
+    uint8_t to = static_cast<uint8_t>((states >> shift) & 3U);
+    int8_t delta = kTransition[(from << 2) | to];
+    if (delta == 0) continue;
+    if (delta == kIllegal) {
+      if (_errorCount[i] != 0xFFFFFFFFUL) _errorCount[i] = _errorCount[i] + 1U;
+      continue;
+    }
+    int32_t position = _position[i];
+    if (delta > 0) {
+      if (position != INT32_MAX) _position[i] = position + 1;
+    } else {
+      if (position != INT32_MIN) _position[i] = position - 1;
+    }
+    _windowAccum[i] += delta;
+  }
+  _countLock.writeEnd();
+}
+
+void QuadratureDecoder::advanceWindow() {
+  if (_channelCount == 0) return;
+  uint16_t ticks = static_cast<uint16_t>(_ticksInWindow + 1U);
+  if (ticks < _windowTicks) {
+    _ticksInWindow = ticks;
+    return;
+  }
+  _ticksInWindow = 0;
+  if (_windowReady) {
+    // The previous window was never published; it is replaced and the frame goes stale.
+    _pendingFrameStale = true;
+    if (_overrunCount != 0xFFFFFFFFUL) {
+      _countLock.writeBegin();
+      _overrunCount = _overrunCount + 1U;
+      _countLock.writeEnd();
+    }
+  }
+  for (uint8_t i = 0; i < _channelCount; ++i) {
+    _windowLatched[i] = _windowAccum[i];
+    _windowAccum[i] = 0;
+  }
+  _windowReady = true;
+}
+
+void QuadratureDecoder::updateIfReady() {
+  if (!_windowReady) return;
+
+  int32_t counts[MAX_CHANNELS];
+  bool publishedFrameStale = false;
+  noInterrupts();
+  for (uint8_t i = 0; i < _channelCount; ++i) counts[i] = _windowLatched[i];
+  publishedFrameStale = _pendingFrameStale;
+  _windowReady = false;
+  _pendingFrameStale = false;
+  interrupts();
+
+  for (uint8_t i = 0; i < _channelCount; ++i) {
+    _countsPerWindow[i] = counts[i];
+    int64_t scaled = static_cast<int64_t>(counts[i]) * _tickHz;
+    int64_t half = _windowTicks / 2U;
+    _countsPerSecond[i] =
+        static_cast<int32_t>((scaled + (scaled < 0 ? -half : half)) / _windowTicks);
+  }
+  _frameStale = publishedFrameStale;
+  if (_frameSequence != 0xFFFFFFFFUL) {
+    ++_frameSequence;
+  }
+}
+
+bool QuadratureDecoder::isWindowReady() const {
+  return _windowReady;
+}
+
+uint8_t QuadratureDecoder::getChannelCount() const {
+  return _channelCount;
+}
+
+int32_t QuadratureDecoder::getPosition(uint8_t channel) const {
+  if (channel >= _channelCount) return 0;
+  int32_t v = 0;
+  uint8_t sequence = 0;
+  do {
+    sequence = _countLock.readBegin();
+    v = _position[channel];
+  } while (_countLock.readRetry(sequence));
+  return v;
+}
+
+uint32_t QuadratureDecoder::getErrorCount(uint8_t channel) const {
+  if (channel >= _channelCount) return 0;
+  uint32_t v = 0;
+  uint8_t sequence = 0;
+  do {
+    sequence = _countLock.readBegin();
+    v = _errorCount[channel];
+  } while (_countLock.readRetry(sequence));
+  return v;
+}
+
+int32_t QuadratureDecoder::getCountsPerWindow(uint8_t channel) const {
+  if (channel >= _channelCount) return 0;
+  return _countsPerWindow[channel];
+}
+
+int32_t QuadratureDecoder::getCountsPerSecond(uint8_t channel) const {
+  if (channel >= _channelCount) return 0;
+  return _countsPerSecond[channel];
+}
+
+void QuadratureDecoder::copyFrame(Frame& frame) const {
+  // The velocity fields are written only by updateIfReady() in loop context; positions,
+  // errors and the overrun count are ISR-owned and copied under the sequence lock.
+  frame.channelCount = _channelCount;
+  frame.frameSequence = _frameSequence;
+  frame.stale = _frameStale;
+  for (uint8_t i = 0; i < MAX_CHANNELS; ++i) {
+    frame.countsPerWindow[i] = _countsPerWindow[i];
+    frame.countsPerSecond[i] = _countsPerSecond[i];
+  }
+  uint8_t sequence = 0;
+  do {
+    sequence = _countLock.readBegin();
+    for (uint8_t i = 0; i < MAX_CHANNELS; ++i) {
+      frame.position[i] = _position[i];
+      frame.errorCount[i] = _errorCount[i];
+    }
+    frame.overrunCount = _overrunCount;
+  } while (_countLock.readRetry(sequence));
+}
+
+uint32_t QuadratureDecoder::getOverrunCount() const {
+  uint32_t v = 0;
+  uint8_t sequence = 0;
+  do {
+    sequence = _countLock.readBegin();
+    v = _overrunCount;
+  } while (_countLock.readRetry(sequence));
+  return v;
+}
+
+void QuadratureDecoder::reset() {
+  noInterrupts();
+  for (uint8_t i = 0; i < MAX_CHANNELS; ++i) {
+    _position[i] = 0;
+    _errorCount[i] = 0;
+  }
+  interrupts();
+}
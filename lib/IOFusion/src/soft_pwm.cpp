@@ -0,0 +1,168 @@
+#include "soft_pwm.h"
+
+#include <string.h>
+
+SoftPwm::SoftPwm() {
+  memset(_schedules, 0, sizeof(_schedules));
+}
+
+bool SoftPwm::begin(const Config& config) {
+  if (config.pins == nullptr || config.pinCount == 0 || config.pinCount > MAX_CHANNELS) {
+    return false;
+  }
+  if (config.steps < 2) return false;
+
+  uint8_t portIds[MAX_PORTS] = {0};
+  volatile uint8_t* portOut[MAX_PORTS] = {nullptr};
+  uint8_t portMask[MAX_PORTS] = {0};
+  uint8_t channelPort[MAX_CHANNELS] = {0};
+  uint8_t channelMask[MAX_CHANNELS] = {0};
+  uint8_t portCount = 0;
+
+  for (uint8_t ch = 0; ch < config.pinCount; ++ch) {
+    uint8_t pin = config.pins[ch];
+    for (uint8_t prev = 0; prev < ch; ++prev) {
+      if (config.pins[prev] == pin) return false;
+    }
+    uint8_t port = digitalPinToPort(pin);
+    if (port == NOT_A_PIN) return false;
+    volatile uint8_t* out = portOutputRegister(port);
+    uint8_t mask = digitalPinToBitMask(pin);
+    if (out == nullptr || mask == 0) return false;
+
+    uint8_t slot = 0;
+    while (slot < portCount && portIds[slot] != port) ++slot;
+    if (slot == portCount) {
+      if (portCount == MAX_PORTS) return false;
+      portIds[slot] = port;
+      portOut[slot] = out;
+      ++portCount;
+    }
+    portMask[slot] |= mask;
+    channelPort[ch] = slot;
+    channelMask[ch] = mask;
+  }
+
+  noInterrupts();
+  _channelCount = 0;
+  interrupts();
+
+  for (uint8_t ch = 0; ch < config.pinCount; ++ch) {
+    *portOut[channelPort[ch]] &= static_cast<uint8_t>(~channelMask[ch]);
+    pinMode(config.pins[ch], OUTPUT);
+  }
+  for (uint8_t p = 0; p < MAX_PORTS; ++p) {
+    _portOut[p] = portOut[p];
+    _portMask[p] = portMask[p];
+  }
+  for (uint8_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+    _channelPort[ch] = channelPort[ch];
+    _channelMask[ch] = channelMask[ch];
+    _level[ch] = 0;
+  }
+  memset(_schedules, 0, sizeof(_schedules));
+  _portCount = portCount;
+  _steps = config.steps;
+  _activeSchedule = 0;
+  _swapPending = false;
+  _step = 0;
+  _nextEvent = 0;
+
+  noInterrupts();
+  _channelCount = config.pinCount;
+  interrupts();
+  return true;
+}
+
+bool SoftPwm::setLevel(uint8_t channel, uint8_t level) {
+  if (channel >= _channelCount) return false;
+  if (level > _steps) level = _steps;
+  if (_level[channel] == level) return true;
+  _level[channel] = level;
+  rebuild();
+  return true;
+}
+
+bool SoftPwm::setDutyPermille(uint8_t channel, uint16_t permille) {
+  if (permille > 1000U) permille = 1000U;
+  uint16_t level = static_cast<uint16_t>((static_cast<uint32_t>(permille) * _steps + 500U) / 1000U);
+  return setLevel(channel, static_cast<uint8_t>(level));
+}
+
+uint8_t SoftPwm::getLevel(uint8_t channel) const {
+  return channel < _channelCount ? _level[channel] : 0;
+}
+
+uint8_t SoftPwm::getSteps() const {
+  return _steps;
+}
+
+uint8_t SoftPwm::getChannelCount() const {
+  return _channelCount;
+}
+
+bool SoftPwm::isUpdatePending() const {
+  return _swapPending;
+}
+
+void SoftPwm::onTick() {
+  if (_channelCount == 0) return;
+  uint8_t step = _step;
+  if (step == 0) {
+    if (_swapPending) {
+      _activeSchedule ^= 1U;
+      _swapPending = false;
+    }
+    const Schedule& period = _schedules[_activeSchedule];
+    for (uint8_t p = 0; p < _portCount; ++p) {
+      volatile uint8_t* out = _portOut[p];
+      *out = static_cast<uint8_t>((*out & ~_portMask[p]) | period.setMask[p]);
+    }
+    _nextEvent = 0;
+  }
+
+  // Event steps are distinct, so at most one event falls on any tick.
+  const Schedule& s = _schedules[_activeSchedule];
+  uint8_t event = _nextEvent;
+  if (event < s.eventCount && s.eventStep[event] == step) {
+    for (uint8_t p = 0; p < _portCount; ++p) {
+      *_portOut[p] &= static_cast<uint8_t>(~s.clearMask[event][p]);
+    }
+    _nextEvent = static_cast<uint8_t>(event + 1U);
+  }
+
+  ++step;
+  _step = step >= _steps ? 0 : step;
+}
+
+void SoftPwm::rebuild() {
+  // With no swap pending the tick only reads the active schedule, so the other one is ours.
+  noInterrupts();
+  _swapPending = false;
+  interrupts();
+  Schedule& s = _schedules[_activeSchedule ^ 1U];
+  memset(&s, 0, sizeof(s));
+
+  for (uint8_t ch = 0; ch < _channelCount; ++ch) {
+    uint8_t level = _level[ch];
+    if (level == 0) continue;
+    uint8_t port = _channelPort[ch];
+    s.setMask[port] |= _channelMask[ch];
+    if (level >= _steps) continue;
+
+    uint8_t i = 0;
+    while (i < s.eventCount && s.eventStep[i] < level) ++i;
+    if (i == s.eventCount || s.eventStep[i] != level) {
+      for (uint8_t j = s.eventCount; j > i; --j) {
+        s.eventStep[j] = s.eventStep[j - 1];
+        memcpy(s.clearMask[j], s.clearMask[j - 1], MAX_PORTS);
+      }
+      s.eventStep[i] = level;
+      memset(s.clearMask[i], 0, MAX_PORTS);
+      ++s.eventCount;
+    }
+    s.clearMask[i][port] |= _channelMask[ch];
+  }
+
+  _swapPending = true;
+}
@@ -0,0 +1,169 @@
+#include "step_ramp.h"
+
+namespace {
+
+// log2 of the Timer1 prescalers a move may use (1, 8, 64), in clock-select order. The overflow
+// ISR must not write the next period before the buffers load at BOTTOM, one timer clock after
+// TOP, and waits for that; /256 and /1024 would make the wait too long for an ISR.
+const uint8_t kPrescalerShift[3] = {0, 3, 6};
+const uint8_t kPrescalerCount = 3;
+
+uint32_t isqrt64(uint64_t value) {
+  uint64_t root = 0;
+  uint64_t bit = 1ULL << 62;
+  while (bit > value) bit >>= 2;
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return static_cast<uint32_t>(root);
+}
+
+// Input clocks per step at a step rate whose square is @p rateSquared, rounded.
+uint32_t periodClocks(uint64_t rateSquared, uint32_t clockHz) {
+  // The rate in Q8 keeps the period exact to a fraction of a clock at any rate.
+  uint64_t rateQ8 = isqrt64(rateSquared << 16);
+  return static_cast<uint32_t>(((static_cast<uint64_t>(clockHz) << 8) + rateQ8 / 2U) / rateQ8);
+}
+
+uint32_t countsAt(uint32_t clocks, uint8_t shift) {
+  return (clocks + ((1UL << shift) >> 1)) >> shift;
+}
+
+}  // namespace
+
+StepRamp::StepRamp() {
+  for (uint8_t i = 0; i < MAX_ENTRIES; ++i) _tops[i] = 0;
+}
+
+bool StepRamp::begin(const Config& config, uint32_t clockHz, uint32_t minPeriodClocks) {
+  _steps = 0;
+  _planned = 0;
+  if (config.steps == 0 || config.startHz == 0 || config.startHz > config.maxHz) return false;
+  if (config.pulseWidthUs == 0 || clockHz == 0) return false;
+
+  uint64_t startSquared = static_cast<uint64_t>(config.startHz) * config.startHz;
+  uint64_t maxSquared = static_cast<uint64_t>(config.maxHz) * config.maxHz;
+  uint32_t rampSteps = 0;
+  if (config.accelHzPerSecond != 0 && config.startHz < config.maxHz) {
+    uint64_t twiceAccel = 2ULL * config.accelHzPerSecond;
+    rampSteps = static_cast<uint32_t>((maxSquared - startSquared + twiceAccel - 1U) / twiceAccel);
+  }
+
+  // One prescaler for the whole move: the fastest one whose TOP fits the slowest period. TOP
+  // stays below 0xFFFF so that compare value can mark a period without a pulse.
+  uint32_t slowestClocks = periodClocks(rampSteps != 0 ? startSquared : maxSquared, clockHz);
+  uint8_t select = 0;
+  while (select < kPrescalerCount && countsAt(slowestClocks, kPrescalerShift[select]) > 65535UL) {
+    ++select;
+  }
+  if (select == kPrescalerCount) return false;
+  uint8_t shift = kPrescalerShift[select];
+
+  uint32_t cruiseCounts = countsAt(periodClocks(maxSquared, clockHz), shift);
+  if ((cruiseCounts << shift) < minPeriodClocks) return false;
+  uint64_t pulseClocks = static_cast<uint64_t>(config.pulseWidthUs) * clockHz;
+  uint64_t pulseDivisor = 1000000ULL << shift;
+  uint32_t pulseCounts = static_cast<uint32_t>((pulseClocks + pulseDivisor - 1U) / pulseDivisor);
+  if (pulseCounts >= cruiseCounts) return false;
+
+  uint32_t stride = rampSteps > MAX_ENTRIES ? (rampSteps + MAX_ENTRIES - 1U) / MAX_ENTRIES : 1;
+  for (uint8_t i = 0; i < MAX_ENTRIES; ++i) {
+    uint32_t first = static_cast<uint32_t>(i) * stride;
+    if (first >= rampSteps) break;
+    // The last entry may cover fewer steps; each entry is evaluated at its middle step.
+    uint32_t covered = rampSteps - first < stride ? rampSteps - first : stride;
+    uint32_t middle = first + (covered - 1U) / 2U;
+    uint64_t rateSquared = startSquared + 2ULL * config.accelHzPerSecond * middle;
+    uint32_t counts = countsAt(periodClocks(rateSquared, clockHz), shift);
+    if (counts < cruiseCounts) counts = cruiseCounts;
+    if (counts > 65535UL) counts = 65535UL;
+    _tops[i] = static_cast<uint16_t>(counts - 1U);
+  }
+
+  _cruiseTop = static_cast<uint16_t>(cruiseCounts - 1U);
+  _pulseCounts = static_cast<uint16_t>(pulseCounts);
+  _clockSelect = static_cast<uint8_t>(select + 1U);
+  _rampSteps = rampSteps;
+  _stride = stride;
+  _steps = config.steps;
+  // The ramp position rises for the first half of the move and falls for the second half; an
+  // even move plays its peak twice.
+  _risesLeft = (config.steps - 1U) / 2U;
+  _holdPeak = config.steps % 2U == 0;
+  _rampPos = 0;
+  _entry = 0;
+  _strideCount = 0;
+  return true;
+}
+
+bool StepRamp::hasNext() const {
+  return _planned < _steps;
+}
+
+uint16_t StepRamp::next() {
+  if (_planned >= _steps) return _cruiseTop;
+  if (_planned != 0) {
+    if (_risesLeft != 0) {
+      --_risesLeft;
+      rise();
+    } else if (_holdPeak) {
+      _holdPeak = false;
+    } else {
+      fall();
+    }
+  }
+  ++_planned;
+  return _rampPos < _rampSteps ? _tops[_entry] : _cruiseTop;
+}
+
+uint32_t StepRamp::getSteps() const {
+  return _steps;
+}
+
+uint32_t StepRamp::getPlanned() const {
+  return _planned;
+}
+
+uint32_t StepRamp::getRampSteps() const {
+  return _rampSteps;
+}
+
+uint32_t StepRamp::getStride() const {
+  return _stride;
+}
+
+uint8_t StepRamp::getClockSelect() const {
+  return _clockSelect;
+}
+
+uint16_t StepRamp::getCruiseTop() const {
+  return _cruiseTop;
+}
+
+uint16_t StepRamp::getPulseCounts() const {
+  return _pulseCounts;
+}
+
+void StepRamp::rise() {
+  if (_rampPos < _rampSteps && ++_strideCount == _stride) {
+    _strideCount = 0;
+    ++_entry;
+  }
+  ++_rampPos;
+}
+
+void StepRamp::fall() {
+  --_rampPos;
+  if (_rampPos >= _rampSteps) return;
+  if (_strideCount == 0) {
+    _strideCount = _stride;
+    --_entry;
+  }
+  --_strideCount;
+}
@@ -0,0 +1,73 @@
+#include "waveform_synth.h"
+
+namespace {
+
+// One period of 127.5 + 127.5 * sin(2 * pi * i / 256), rounded.
+const uint8_t kSineTable[256] PROGMEM = {
+    128, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+    176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+    218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+    245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+    255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+    245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+    218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+    176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+    128, 124, 121, 118, 115, 112, 109, 106, 103, 100, 97, 93, 90, 88, 85, 82,
+    79, 76, 73, 70, 67, 65, 62, 59, 57, 54, 52, 49, 47, 44, 42, 40,
+    37, 35, 33, 31, 29, 27, 25, 23, 21, 20, 18, 17, 15, 14, 12, 11,
+    10, 9, 7, 6, 5, 5, 4, 3, 2, 2, 1, 1, 1, 0, 0, 0,
+    0, 0, 0, 0, 1, 1, 1, 2, 2, 3, 4, 5, 5, 6, 7, 9,
+    10, 11, 12, 14, 15, 17, 18, 20, 21, 23, 25, 27, 29, 31, 33, 35,
+    37, 40, 42, 44, 47, 49, 52, 54, 57, 59, 62, 65, 67, 70, 73, 76,
+    79, 82, 85, 88, 90, 93, 97, 100, 103, 106, 109, 112, 115, 118, 121, 124,
+};
+
+}  // namespace
+
+const uint8_t* WaveformSynth::sineTable() {
+  return kSineTable;
+}
+
+WaveformSynth::WaveformSynth() {}
+
+bool WaveformSynth::begin(const Config& config, uint16_t top, uint32_t updateMilliHz) {
+  if (config.table == nullptr || config.tableBits == 0 || config.tableBits > 16) return false;
+  if (config.amplitudePermille > 1000U || top == 0 || updateMilliHz == 0) return false;
+  // At or above Nyquist the table would be skipped through backwards or not at all.
+  if (config.frequencyMilliHz == 0 || config.frequencyMilliHz >= updateMilliHz / 2U) return false;
+
+  uint64_t scaled = (static_cast<uint64_t>(config.frequencyMilliHz) << 32) + updateMilliHz / 2U;
+  uint16_t span = static_cast<uint16_t>(
+      (static_cast<uint32_t>(config.amplitudePermille) * top + 500U) / 1000U);
+
+  _table = config.table;
+  _indexShift = static_cast<uint8_t>(32U - config.tableBits);
+  _phase = 0;
+  _increment = static_cast<uint32_t>(scaled / updateMilliHz);
+  _offsetB = static_cast<uint32_t>(config.phaseOffsetB) << 16;
+  _updateMilliHz = updateMilliHz;
+  _baseCounts = static_cast<uint16_t>((top - span) / 2U);
+  _scaleQ16 = ((static_cast<uint32_t>(span) << 16) + 127U) / 255U;
+  return true;
+}
+
+void WaveformSynth::step(uint16_t& countsA, uint16_t& countsB) {
+  uint32_t phase = _phase + _increment;
+  _phase = phase;
+  countsA = countsAt(phase);
+  countsB = countsAt(phase + _offsetB);
+}
+
+uint32_t WaveformSynth::getPhaseIncrement() const {
+  return _increment;
+}
+
+uint32_t WaveformSynth::getFrequencyMilliHz() const {
+  uint64_t scaled = static_cast<uint64_t>(_increment) * _updateMilliHz + 0x80000000ULL;
+  return static_cast<uint32_t>(scaled >> 32);
+}
+
+uint16_t WaveformSynth::countsAt(uint32_t phase) const {
+  uint8_t sample = pgm_read_byte(_table + static_cast<uint16_t>(phase >> _indexShift));
+  return static_cast<uint16_t>(_baseCounts + ((sample * _scaleQ16 + 0x8000UL) >> 16));
+}
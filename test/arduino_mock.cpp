@@ -1,6 +1,7 @@
 #include "Arduino.h"
 
 unsigned long mockMillis = 0;
+unsigned long mockMicros = 0;
 uint8_t mockPortIn[8] = {0};
 uint8_t mockPortOut[8] = {0};
 uint8_t mockPinModes[64] = {0};
@@ -10,6 +10,10 @@
 
 #define F(x) x
 #define PROGMEM
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t*>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t*>(addr))
+#define PSTR(x) x
+#define strcmp_P strcmp
 
 #define INPUT 0
 #define OUTPUT 1
@@ -34,6 +38,11 @@ inline void advanceMillis(unsigned long deltaMs) {
   mockMillis += deltaMs;
 }
 
+extern unsigned long mockMicros;
+inline unsigned long micros() {
+  return mockMicros;
+}
+
 extern uint8_t mockPortIn[8];
 extern uint8_t mockPortOut[8];
 extern uint8_t mockPinModes[64];
@@ -85,8 +94,52 @@ inline void digitalWrite(uint8_t pin, uint8_t value) {
     *out &= static_cast<uint8_t>(~mask);
 }
 
-class MockSerial {
+class Print {
  public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; ++i) write(buffer[i]);
+    return size;
+  }
+  virtual int availableForWrite() { return 0; }
+
+  size_t print(const char* s) {
+    if (!s) return 0;
+    return write(reinterpret_cast<const uint8_t*>(s), std::strlen(s));
+  }
+
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(int v) { return printString(std::to_string(v)); }
+  size_t print(unsigned int v) { return printString(std::to_string(v)); }
+  size_t print(long v) { return printString(std::to_string(v)); }
+  size_t print(unsigned long v) { return printString(std::to_string(v)); }
+
+  size_t print(float v, int digits = 2) {
+    std::ostringstream ss;
+    ss.setf(std::ios::fixed);
+    ss << std::setprecision(digits) << v;
+    return printString(ss.str());
+  }
+
+  size_t println() { return write('\n'); }
+
+  template <typename T>
+  size_t println(T v) {
+    size_t n = print(v);
+    return n + write('\n');
+  }
+
+ private:
+  size_t printString(const std::string& s) {
+    return write(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+  }
+};
+
+class MockSerial : public Print {
+ public:
+  static constexpr int kUnlimitedTxRoom = 1 << 20;
+
   void begin(unsigned long) {}
 
   size_t available() const {
@@ -107,67 +160,28 @@ class MockSerial {
   const std::string& getOutput() const { return _output; }
   void clearOutput() { _output.clear(); }
 
-  size_t print(const char* s) {
-    if (!s) return 0;
-    _output += s;
-    return std::strlen(s);
-  }
-
-  size_t print(char c) {
-    _output.push_back(c);
-    return 1;
-  }
-
-  size_t print(int v) {
-    _output += std::to_string(v);
-    return 1;
-  }
-
-  size_t print(unsigned int v) {
-    _output += std::to_string(v);
-    return 1;
-  }
-
-  size_t print(long v) {
-    _output += std::to_string(v);
-    return 1;
-  }
-
-  size_t print(unsigned long v) {
-    _output += std::to_string(v);
-    return 1;
-  }
-
-  size_t print(float v, int digits = 2) {
-    std::ostringstream ss;
-    ss.setf(std::ios::fixed);
-    ss << std::setprecision(digits) << v;
-    _output += ss.str();
-    return 1;
-  }
+  // Room left in the simulated hardware TX buffer; each write uses some of it up.
+  void setTxRoom(int room) { _txRoom = room; }
+  int availableForWrite() override { return _txRoom; }
 
-  size_t println() {
-    _output.push_back('\n');
+  using Print::write;
+  size_t write(uint8_t b) override {
+    _output.push_back(static_cast<char>(b));
+    if (_txRoom > 0) --_txRoom;
     return 1;
   }
 
-  size_t println(const char* s) {
-    size_t n = print(s);
-    _output.push_back('\n');
-    return n + 1;
-  }
-
-  template <typename T>
-  size_t println(T v) {
-    size_t n = print(v);
-    _output.push_back('\n');
-    return n + 1;
+  size_t write(const uint8_t* buffer, size_t size) override {
+    _output.append(reinterpret_cast<const char*>(buffer), size);
+    _txRoom = _txRoom > static_cast<int>(size) ? _txRoom - static_cast<int>(size) : 0;
+    return size;
   }
 
  private:
   std::string _input;
   size_t _readPos = 0;
   std::string _output;
+  int _txRoom = kUnlimitedTxRoom;
 };
 
 extern MockSerial Serial;
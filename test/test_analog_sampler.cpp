@@ -17,11 +17,14 @@ void test_analog_sampler_branches() {
 
   sampler.setVref(-1.0f);
   sampler.setVref(3.3f);
+  TEST_ASSERT_FALSE(sampler.isSampleDue());
   sampler.onTick();
   sampler.onTick();
+  TEST_ASSERT_TRUE(sampler.isSampleDue());
   mockAnalogValues[0] = 1023;
   mockAnalogValues[1] = 256;
   sampler.sampleIfDue();
+  TEST_ASSERT_FALSE(sampler.isSampleDue());
 
   TEST_ASSERT_FLOAT_WITHIN(0.02f, 3.3f, sampler.getValue(0));
   TEST_ASSERT_FLOAT_WITHIN(0.02f, (256.0f * 3.3f) / 1023.0f, sampler.getValue(1));
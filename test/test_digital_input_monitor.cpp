@@ -241,4 +241,87 @@ void test_digital_input_monitor_copy_frame() {
   TEST_ASSERT_EQUAL_UINT32(456000, frame.frequencyMilliHz[1]);
   TEST_ASSERT_EQUAL_UINT16(111, frame.dutyPermille[0]);
   TEST_ASSERT_EQUAL_UINT16(222, frame.dutyPermille[1]);
-}
\ No newline at end of file
+}
+void test_digital_input_monitor_port_snapshot() {
+  DigitalInputMonitor digitalMonitor;
+  const uint8_t pins[] = {2, 9};
+  TEST_ASSERT_TRUE(digitalMonitor.begin(DigitalInputMonitor::Config{pins, 2, 4, 1000.0f, false}));
+
+  PortSnapshot ports;
+  setDigitalPin(2, true);
+  setDigitalPin(9, false);
+  ports.capture();
+  TEST_ASSERT_TRUE(ports.isHigh(digitalPinToPort(2), digitalPinToBitMask(2)));
+  TEST_ASSERT_FALSE(ports.isHigh(digitalPinToPort(9), digitalPinToBitMask(9)));
+
+  // Live pin changes after capture must not leak into the snapshot-driven sample.
+  setDigitalPin(2, false);
+  setDigitalPin(9, true);
+  digitalMonitor.onTick(ports);
+  ports.capture();
+  digitalMonitor.onTick(ports);
+  digitalMonitor.onTick(ports);
+  setDigitalPin(9, false);
+  ports.capture();
+  digitalMonitor.onTick(ports);
+
+  digitalMonitor.onTick(ports);
+  TEST_ASSERT_EQUAL_UINT32(1, digitalMonitor.getOverrunCount());
+  digitalMonitor.updateIfReady();
+
+  TEST_ASSERT_EQUAL_UINT16(250, digitalMonitor.getDutyPermille(0));
+  TEST_ASSERT_EQUAL_UINT16(500, digitalMonitor.getDutyPermille(1));
+  TEST_ASSERT_EQUAL_UINT32(250000, digitalMonitor.getFrequencyMilliHz(1));
+  TEST_ASSERT_TRUE(digitalMonitor.isFrameStale());
+  TEST_ASSERT_EQUAL_UINT32(1, digitalMonitor.getFrameSequence());
+}
+
+void test_digital_input_monitor_events() {
+  DigitalInputMonitor digitalMonitor;
+  TickEventQueue queue;
+  const uint8_t pins[] = {2};
+  TEST_ASSERT_TRUE(digitalMonitor.begin(DigitalInputMonitor::Config{pins, 1, 2, 1000.0f, false}));
+
+  PortSnapshot ports;
+  ports.capture();
+  ports.tick = 10;
+  digitalMonitor.onTick(ports);
+  ports.tick = 11;
+  TEST_ASSERT_FALSE(digitalMonitor.isWindowReady());
+  digitalMonitor.onTick(ports);
+  TEST_ASSERT_TRUE(digitalMonitor.isWindowReady());
+  TEST_ASSERT_TRUE(queue.isEmpty());
+  digitalMonitor.updateIfReady();
+  TEST_ASSERT_FALSE(digitalMonitor.isWindowReady());
+
+  digitalMonitor.setEventQueue(&queue, 7);
+  ports.tick = 20;
+  digitalMonitor.onTick(ports);
+  TEST_ASSERT_TRUE(queue.isEmpty());
+  ports.tick = 21;
+  digitalMonitor.onTick(ports);
+  ports.tick = 22;
+  digitalMonitor.onTick(ports);
+  ports.tick = 23;
+  digitalMonitor.onTick(ports);
+  digitalMonitor.onTick();
+
+  TickEvent event;
+  TEST_ASSERT_EQUAL_UINT8(2, queue.size());
+  TEST_ASSERT_TRUE(queue.pop(event));
+  TEST_ASSERT_EQUAL_UINT32(21, event.tick);
+  TEST_ASSERT_EQUAL_UINT8(7, event.source);
+  TEST_ASSERT_EQUAL_UINT8(TICK_EVENT_WINDOW_READY, event.code);
+  TEST_ASSERT_EQUAL_UINT16(2, event.value);
+  TEST_ASSERT_TRUE(queue.pop(event));
+  TEST_ASSERT_EQUAL_UINT32(22, event.tick);
+  TEST_ASSERT_EQUAL_UINT8(TICK_EVENT_WINDOW_OVERRUN, event.code);
+  TEST_ASSERT_EQUAL_UINT32(3, digitalMonitor.getOverrunCount());
+
+  digitalMonitor.setEventQueue(nullptr);
+  digitalMonitor.updateIfReady();
+  digitalMonitor.onTick(ports);
+  digitalMonitor.onTick(ports);
+  digitalMonitor.onTick(ports);
+  TEST_ASSERT_TRUE(queue.isEmpty());
+}
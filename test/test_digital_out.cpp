@@ -1,6 +1,7 @@
 #include <unity.h>
 
 #include "digital_out.h"
+#include "test_support.h"
 
 void test_digital_out_begin_rejects_invalid_args() {
   DigitalOut out;
@@ -47,3 +48,44 @@ void test_digital_out_index_bounds() {
   TEST_ASSERT_FALSE(out.toggle(2));
   TEST_ASSERT_FALSE(out.getState(2, s));
 }
+
+void test_digital_out_port_batched_writes() {
+  DigitalOut out;
+  // Pins 2 and 4 share port 0, pin 9 is on port 1; the other bits of both ports are not ours.
+  uint8_t pins[3] = {2, 9, 4};
+  uint8_t repeated[2] = {2, 2};
+  TEST_ASSERT_FALSE(out.begin(repeated, 2));
+  uint8_t noPort[1] = {70};
+  TEST_ASSERT_FALSE(out.begin(noPort, 1));
+
+  mockPortOut[0] = 0x81;
+  mockPortOut[1] = 0x80;
+  TEST_ASSERT_TRUE(out.begin(pins, 3, true));
+  TEST_ASSERT_EQUAL_HEX8(0x95, mockPortOut[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x82, mockPortOut[1]);
+  TEST_ASSERT_EQUAL_UINT8(OUTPUT, mockPinModes[9]);
+  TEST_ASSERT_EQUAL_HEX8(0x07, out.getStates());
+
+  // Pins 0 and 2 low, pin 1 untouched.
+  TEST_ASSERT_TRUE(out.writeMask(0x05, 0x00));
+  TEST_ASSERT_EQUAL_HEX8(0x81, mockPortOut[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x82, mockPortOut[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x02, out.getStates());
+  TEST_ASSERT_FALSE(out.writeMask(0x08, 0x08));
+
+  TEST_ASSERT_TRUE(out.toggle(1));
+  TEST_ASSERT_EQUAL_HEX8(0x80, mockPortOut[1]);
+
+  // Staged levels reach the ports together on apply().
+  TEST_ASSERT_TRUE(out.stage(0, true));
+  TEST_ASSERT_TRUE(out.stage(1, true));
+  TEST_ASSERT_FALSE(out.stage(3, true));
+  TEST_ASSERT_EQUAL_HEX8(0x81, mockPortOut[0]);
+  TEST_ASSERT_TRUE(out.apply());
+  TEST_ASSERT_EQUAL_HEX8(0x85, mockPortOut[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x82, mockPortOut[1]);
+
+  TEST_ASSERT_TRUE(out.setAll(false));
+  TEST_ASSERT_EQUAL_HEX8(0x81, mockPortOut[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x80, mockPortOut[1]);
+}
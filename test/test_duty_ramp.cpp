@@ -0,0 +1,102 @@
+#include <unity.h>
+
+#include "duty_ramp.h"
+#include "test_support.h"
+
+namespace {
+
+void tick(DutyRamp& ramp, uint16_t count) {
+  for (uint16_t i = 0; i < count; ++i) ramp.onTick();
+}
+
+}  // namespace
+
+void test_duty_ramp_config_edges() {
+  Timer1PWM pwm;
+  DutyRamp ramp;
+  TEST_ASSERT_FALSE(ramp.setDuty(0, 100));
+  TEST_ASSERT_FALSE(ramp.rampTo(0, 100, 100));
+  ramp.onTick();
+
+  TEST_ASSERT_FALSE(ramp.begin(DutyRamp::Config(nullptr, 1000)));
+  TEST_ASSERT_FALSE(ramp.begin(DutyRamp::Config(&pwm, 0)));
+  TEST_ASSERT_TRUE(ramp.begin(DutyRamp::Config(&pwm, 1000)));
+
+  TEST_ASSERT_FALSE(ramp.setDuty(2, 100));
+  TEST_ASSERT_FALSE(ramp.rampTo(2, 100, 100));
+  TEST_ASSERT_FALSE(ramp.rampTo(0, 100, 0));
+  const DutyRamp::Segment segments[DutyRamp::MAX_SEGMENTS + 1] = {};
+  TEST_ASSERT_FALSE(ramp.playProfile(0, nullptr, 1));
+  TEST_ASSERT_FALSE(ramp.playProfile(0, segments, 0));
+  TEST_ASSERT_FALSE(ramp.playProfile(0, segments, DutyRamp::MAX_SEGMENTS + 1));
+  TEST_ASSERT_FALSE(ramp.isActive(2));
+  TEST_ASSERT_EQUAL_UINT16(0, ramp.getDutyPermille(2));
+
+  TEST_ASSERT_TRUE(ramp.setDuty(1, 1500));
+  TEST_ASSERT_EQUAL_UINT16(1000, ramp.getDutyPermille(1));
+
+  // Writes refused by an unconfigured PWM are retried on every tick until one lands.
+  TEST_ASSERT_TRUE(ramp.rampTo(0, 10, 10000));
+  tick(ramp, 5);
+  TEST_ASSERT_FALSE(ramp.isActive(0));
+  TEST_ASSERT_EQUAL_UINT16(0, ramp.getDutyPermille(0));
+  TEST_ASSERT_TRUE(pwm.begin(Timer1PWM::timingForMilliHz(1000000UL)));
+  TEST_ASSERT_TRUE(ramp.rampTo(0, 10, 10000));
+  tick(ramp, 1);
+  TEST_ASSERT_EQUAL_UINT16(10, ramp.getDutyPermille(0));
+}
+
+void test_duty_ramp_slew_and_profile() {
+  Timer1PWM pwm;
+  DutyRamp ramp;
+  TEST_ASSERT_TRUE(pwm.begin(Timer1PWM::timingForMilliHz(1000000UL)));
+  TEST_ASSERT_TRUE(ramp.begin(DutyRamp::Config(&pwm, 1000)));
+
+  // 1000 permille/s at 1 kHz moves exactly one permille per tick.
+  TEST_ASSERT_TRUE(ramp.rampTo(0, 500, 1000));
+  TEST_ASSERT_TRUE(ramp.isActive(0));
+  tick(ramp, 1);
+  TEST_ASSERT_EQUAL_UINT16(1, ramp.getDutyPermille(0));
+  tick(ramp, 249);
+  TEST_ASSERT_EQUAL_UINT16(250, ramp.getDutyPermille(0));
+  ramp.stop(0);
+  TEST_ASSERT_FALSE(ramp.isActive(0));
+  tick(ramp, 10);
+  TEST_ASSERT_EQUAL_UINT16(250, ramp.getDutyPermille(0));
+
+  // A step that does not divide evenly still ends exactly on the target.
+  TEST_ASSERT_TRUE(ramp.rampTo(0, 1000, 3000));
+  tick(ramp, 249);
+  TEST_ASSERT_TRUE(ramp.isActive(0));
+  TEST_ASSERT_UINT16_WITHIN(1, 997, ramp.getDutyPermille(0));
+  tick(ramp, 1);
+  TEST_ASSERT_FALSE(ramp.isActive(0));
+  TEST_ASSERT_EQUAL_UINT16(1000, ramp.getDutyPermille(0));
+
+  // Rise, dwell, then drop to zero in one tick.
+  const DutyRamp::Segment pulse[] = {{800, 10}, {800, 5}, {0, 0}};
+  TEST_ASSERT_TRUE(ramp.setDuty(1, 0));
+  TEST_ASSERT_TRUE(ramp.playProfile(1, pulse, 3));
+  tick(ramp, 5);
+  TEST_ASSERT_EQUAL_UINT16(400, ramp.getDutyPermille(1));
+  tick(ramp, 10);
+  TEST_ASSERT_TRUE(ramp.isActive(1));
+  TEST_ASSERT_EQUAL_UINT16(800, ramp.getDutyPermille(1));
+  tick(ramp, 1);
+  TEST_ASSERT_FALSE(ramp.isActive(1));
+  TEST_ASSERT_EQUAL_UINT16(0, ramp.getDutyPermille(1));
+
+  // A repeating triangle wraps from its last duty back into the first segment.
+  const DutyRamp::Segment triangle[] = {{100, 2}, {0, 2}};
+  TEST_ASSERT_TRUE(ramp.playProfile(1, triangle, 2, true));
+  const uint16_t expected[] = {50, 100, 50, 0, 50, 100, 50, 0};
+  for (uint8_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+    ramp.onTick();
+    TEST_ASSERT_EQUAL_UINT16(expected[i], ramp.getDutyPermille(1));
+  }
+  TEST_ASSERT_TRUE(ramp.isActive(1));
+
+  TEST_ASSERT_TRUE(ramp.setDuty(1, 300));
+  TEST_ASSERT_FALSE(ramp.isActive(1));
+  TEST_ASSERT_EQUAL_UINT16(300, ramp.getDutyPermille(1));
+}
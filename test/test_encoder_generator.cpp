@@ -169,4 +169,243 @@ void test_encoder_generator_position_saturates() {
 
   encoder.reset();
   TEST_ASSERT_EQUAL_INT32(0, encoder.getPosition());
-}
\ No newline at end of file
+}
+void test_encoder_generator_port_snapshot() {
+  EncoderGenerator encoder;
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 2, 24, false, true}));
+
+  PortSnapshot ports;
+  setDigitalPin(2, true);
+  setDigitalPin(24, false);
+  ports.capture();
+  setDigitalPin(2, false);
+  setDigitalPin(24, true);
+  encoder.onTick(ports);
+  encoder.onTick(ports);
+  TEST_ASSERT_EQUAL_INT32(2, encoder.getPosition());
+  TEST_ASSERT_TRUE(encoder.getDirection());
+  TEST_ASSERT_EQUAL_HEX8(digitalPinToBitMask(9) | digitalPinToBitMask(10),
+                         mockPortOut[digitalPinToPort(9)]);
+
+  ports.capture();
+  encoder.onTick(ports);
+  TEST_ASSERT_EQUAL_INT32(1, encoder.getPosition());
+  TEST_ASSERT_FALSE(encoder.getDirection());
+
+  EncoderGenerator activeLow;
+  TEST_ASSERT_TRUE(activeLow.begin(EncoderGenerator::Config{9, 10, 2, 24, true, false}));
+  setDigitalPin(2, false);
+  setDigitalPin(24, true);
+  ports.capture();
+  activeLow.onTick(ports);
+  TEST_ASSERT_EQUAL_INT32(1, activeLow.getPosition());
+  TEST_ASSERT_TRUE(activeLow.getDirection());
+}
+
+void test_encoder_generator_events() {
+  EncoderGenerator encoder;
+  TickEventQueue queue;
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 2, 3, false, true}));
+  encoder.setEventQueue(&queue, 4);
+
+  PortSnapshot ports;
+  setDigitalPin(2, true);
+  setDigitalPin(3, false);
+  ports.capture();
+  ports.tick = 5;
+  encoder.onTick(ports);
+  TEST_ASSERT_TRUE(queue.isEmpty());
+
+  setDigitalPin(2, false);
+  setDigitalPin(3, true);
+  ports.capture();
+  ports.tick = 6;
+  encoder.onTick(ports);
+  encoder.onTick(ports);
+  setDigitalPin(3, false);
+  ports.capture();
+  encoder.onTick(ports);
+  setDigitalPin(2, true);
+  ports.capture();
+  ports.tick = 9;
+  encoder.onTick(ports);
+
+  TickEvent event;
+  TEST_ASSERT_EQUAL_UINT8(2, queue.size());
+  TEST_ASSERT_TRUE(queue.pop(event));
+  TEST_ASSERT_EQUAL_UINT32(6, event.tick);
+  TEST_ASSERT_EQUAL_UINT8(4, event.source);
+  TEST_ASSERT_EQUAL_UINT8(TICK_EVENT_DIRECTION_CHANGED, event.code);
+  TEST_ASSERT_EQUAL_UINT16(0, event.value);
+  TEST_ASSERT_TRUE(queue.pop(event));
+  TEST_ASSERT_EQUAL_UINT32(9, event.tick);
+  TEST_ASSERT_EQUAL_UINT16(1, event.value);
+  TEST_ASSERT_EQUAL_INT32(0, encoder.getPosition());
+}
+
+void test_encoder_generator_step_rate() {
+  EncoderGenerator encoder;
+  TEST_ASSERT_TRUE(encoder.begin(9, 10, 2, 3));
+  TEST_ASSERT_FALSE(encoder.setStepRateMilliHz(1000));
+  TEST_ASSERT_EQUAL_UINT32(0, encoder.getStepRateMilliHz());
+
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 2, 3, false, true, 10000}));
+  // Until a rate is set the generator keeps its one-step-per-tick behaviour.
+  TEST_ASSERT_EQUAL_UINT32(10000000UL, encoder.getStepRateMilliHz());
+  TEST_ASSERT_FALSE(encoder.setStepRateMilliHz(10000001UL));
+
+  setDigitalPin(2, true);
+  setDigitalPin(3, false);
+  // 2.5 kHz from a 10 kHz tick is a quarter turn of the phase: every fourth tick steps.
+  TEST_ASSERT_TRUE(encoder.setStepRateMilliHz(2500000UL));
+  TEST_ASSERT_EQUAL_UINT32(2500000UL, encoder.getStepRateMilliHz());
+  for (uint8_t i = 0; i < 3; ++i) encoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(0, encoder.getPosition());
+  encoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(1, encoder.getPosition());
+  for (uint8_t i = 0; i < 36; ++i) encoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(10, encoder.getPosition());
+
+  // A rate that does not divide the tick still averages out exactly.
+  TEST_ASSERT_TRUE(encoder.setStepRateMilliHz(3333333UL));
+  TEST_ASSERT_EQUAL_UINT32(3333333UL, encoder.getStepRateMilliHz());
+  for (uint16_t i = 0; i < 30000; ++i) encoder.onTick();
+  TEST_ASSERT_INT32_WITHIN(1, 10010, encoder.getPosition());
+
+  // At rate 0 the direction still follows the inputs, but the position holds.
+  TEST_ASSERT_TRUE(encoder.setStepRateMilliHz(0));
+  TEST_ASSERT_EQUAL_UINT32(0, encoder.getStepRateMilliHz());
+  int32_t held = encoder.getPosition();
+  setDigitalPin(2, false);
+  setDigitalPin(3, true);
+  encoder.onTick();
+  TEST_ASSERT_FALSE(encoder.getDirection());
+  TEST_ASSERT_EQUAL_INT32(held, encoder.getPosition());
+
+  TEST_ASSERT_TRUE(encoder.setStepRateMilliHz(10000000UL));
+  encoder.onTick();
+  encoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(held - 2, encoder.getPosition());
+}
+
+void test_encoder_generator_move_profile() {
+  EncoderGenerator encoder;
+  TEST_ASSERT_TRUE(encoder.begin(9, 10, 2, 3));
+  TEST_ASSERT_FALSE(encoder.moveTo(100, 1000, 10000));
+
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 2, 3, false, true, 10000}));
+  TEST_ASSERT_FALSE(encoder.moveTo(100, 0, 10000));
+  TEST_ASSERT_FALSE(encoder.moveTo(100, 10000, 10000));
+  TEST_ASSERT_FALSE(encoder.moveTo(100, 1000, 0));
+  // Acceleration is capped at half a step per tick squared.
+  TEST_ASSERT_FALSE(encoder.moveTo(100, 1000, 50000000UL));
+  TEST_ASSERT_TRUE(encoder.moveTo(0, 1000, 10000));
+  TEST_ASSERT_FALSE(encoder.isMoving());
+
+  // The direction inputs are ignored while a move runs.
+  setDigitalPin(2, false);
+  setDigitalPin(3, true);
+  // 2000 steps/s at 20000 steps/s^2: 1000 ticks and 100 steps of ramp at each end, and
+  // 800 steps of cruise at one step per five ticks.
+  TEST_ASSERT_TRUE(encoder.moveTo(1000, 2000, 20000));
+  TEST_ASSERT_TRUE(encoder.isMoving());
+  TEST_ASSERT_FALSE(encoder.moveTo(0, 2000, 20000));
+  TEST_ASSERT_EQUAL_INT32(1000, encoder.getMoveTarget());
+  uint16_t ticks = 0;
+  while (ticks < 1000) {
+    encoder.onTick();
+    ++ticks;
+  }
+  TEST_ASSERT_INT32_WITHIN(2, 100, encoder.getPosition());
+  TEST_ASSERT_TRUE(encoder.getDirection());
+  int32_t cruiseStart = encoder.getPosition();
+  for (uint16_t i = 0; i < 1000; ++i) encoder.onTick();
+  TEST_ASSERT_INT32_WITHIN(1, cruiseStart + 200, encoder.getPosition());
+  while (encoder.isMoving() && ticks < 10000) {
+    encoder.onTick();
+    ++ticks;
+  }
+  ticks = static_cast<uint16_t>(ticks + 1000);
+  TEST_ASSERT_FALSE(encoder.isMoving());
+  TEST_ASSERT_EQUAL_INT32(1000, encoder.getPosition());
+  // The first step comes about 100 ticks into the ramp up, while the last one ends the move.
+  TEST_ASSERT_UINT16_WITHIN(60, 6000, ticks);
+
+  // Short moves never reach cruise and ramp straight back down; the inputs resume after.
+  TEST_ASSERT_TRUE(encoder.moveTo(990, 2000, 20000));
+  while (encoder.isMoving()) encoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(990, encoder.getPosition());
+  TEST_ASSERT_FALSE(encoder.getDirection());
+  encoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(989, encoder.getPosition());
+
+  // Stopping mid-ramp decelerates over as many steps as the ramp up took.
+  TEST_ASSERT_TRUE(encoder.moveTo(100000L, 2000, 20000));
+  for (uint16_t i = 0; i < 500; ++i) encoder.onTick();
+  int32_t stoppedAt = encoder.getPosition();
+  TEST_ASSERT_INT32_WITHIN(2, 989 + 25, stoppedAt);
+  encoder.stopMove();
+  TEST_ASSERT_EQUAL_INT32(stoppedAt + (stoppedAt - 989), encoder.getMoveTarget());
+  ticks = 0;
+  while (encoder.isMoving()) {
+    encoder.onTick();
+    ++ticks;
+  }
+  TEST_ASSERT_EQUAL_INT32(encoder.getMoveTarget(), encoder.getPosition());
+  // 500 ticks, less the same head start the first step had.
+  TEST_ASSERT_UINT16_WITHIN(10, 450, ticks);
+
+  TEST_ASSERT_TRUE(encoder.moveTo(5000, 2000, 20000));
+  encoder.reset();
+  TEST_ASSERT_FALSE(encoder.isMoving());
+}
+
+void test_encoder_generator_index_pulse() {
+  EncoderGenerator encoder;
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 2, 3, false, true}));
+  TEST_ASSERT_FALSE(encoder.beginIndex(EncoderGenerator::IndexConfig{10, 8}));
+  TEST_ASSERT_FALSE(encoder.beginIndex(EncoderGenerator::IndexConfig{11, 8, 8}));
+  TEST_ASSERT_FALSE(encoder.beginIndex(EncoderGenerator::IndexConfig{11, 8, 0, 0}));
+  TEST_ASSERT_FALSE(encoder.beginIndex(EncoderGenerator::IndexConfig{11, 8, 0, 8}));
+  TEST_ASSERT_TRUE(encoder.beginIndex(EncoderGenerator::IndexConfig{11, 0}));
+
+  // A (pin 9), B (pin 10) and Z (pin 11) share port 1, so each step is one port write.
+  const uint8_t aBit = 1U << 1;
+  const uint8_t bBit = 1U << 2;
+  const uint8_t zBit = 1U << 3;
+  mockPortOut[1] = 0x81;
+  TEST_ASSERT_TRUE(encoder.beginIndex(EncoderGenerator::IndexConfig{11, 8}));
+  TEST_ASSERT_EQUAL_HEX8(0x81 | zBit, mockPortOut[1]);
+
+  setDigitalPin(2, true);
+  setDigitalPin(3, false);
+  encoder.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x81 | bBit, mockPortOut[1]);
+  for (uint8_t i = 0; i < 7; ++i) encoder.onTick();
+  // Eight counts are two A/B cycles: back to the idle state with Z asserted.
+  TEST_ASSERT_EQUAL_HEX8(0x81 | zBit, mockPortOut[1]);
+  int32_t revolutions = 0;
+  TEST_ASSERT_EQUAL_INT32(8, encoder.getPosition(revolutions));
+  TEST_ASSERT_EQUAL_INT32(1, revolutions);
+
+  setDigitalPin(2, false);
+  setDigitalPin(3, true);
+  for (uint8_t i = 0; i < 9; ++i) encoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(-1, encoder.getPosition(revolutions));
+  TEST_ASSERT_EQUAL_INT32(-1, revolutions);
+  TEST_ASSERT_EQUAL_HEX8(0x81 | aBit, mockPortOut[1]);
+
+  // A two-count pulse starting at count 6 on another port, numbered from the current position.
+  TEST_ASSERT_TRUE(encoder.beginIndex(EncoderGenerator::IndexConfig{17, 8, 6, 2}));
+  TEST_ASSERT_EQUAL_INT32(-1, encoder.getRevolutions());
+  TEST_ASSERT_EQUAL_HEX8(1U << 1, mockPortOut[2] & (1U << 1));
+  encoder.onTick();
+  TEST_ASSERT_EQUAL_HEX8(1U << 1, mockPortOut[2] & (1U << 1));
+  encoder.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0, mockPortOut[2] & (1U << 1));
+
+  encoder.reset();
+  TEST_ASSERT_EQUAL_INT32(0, encoder.getRevolutions());
+  TEST_ASSERT_EQUAL_HEX8(0x81, mockPortOut[1]);
+  TEST_ASSERT_EQUAL_HEX8(0, mockPortOut[2] & (1U << 1));
+}
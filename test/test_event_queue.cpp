@@ -0,0 +1,69 @@
+#include <unity.h>
+
+#include "event_queue.h"
+#include "test_support.h"
+
+namespace {
+
+struct EventQueueMirror {
+  TickEvent items[TICK_EVENT_QUEUE_CAPACITY];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+  volatile uint16_t dropped;
+};
+
+}  // namespace
+
+void test_event_queue_fifo_and_drops() {
+  TickEventQueue queue;
+  TickEvent event;
+
+  TEST_ASSERT_EQUAL_UINT8(TICK_EVENT_QUEUE_CAPACITY, TickEventQueue::capacity());
+  TEST_ASSERT_TRUE(queue.isEmpty());
+  TEST_ASSERT_FALSE(queue.pop(event));
+
+  for (uint8_t i = 0; i < TICK_EVENT_QUEUE_CAPACITY; ++i) {
+    event.tick = 100U + i;
+    event.value = i;
+    TEST_ASSERT_TRUE(queue.push(event));
+  }
+  TEST_ASSERT_EQUAL_UINT8(TICK_EVENT_QUEUE_CAPACITY, queue.size());
+  event.tick = 999;
+  TEST_ASSERT_FALSE(queue.push(event));
+  TEST_ASSERT_FALSE(queue.push(event));
+  TEST_ASSERT_EQUAL_UINT16(2, queue.getDroppedCount());
+
+  for (uint8_t i = 0; i < TICK_EVENT_QUEUE_CAPACITY; ++i) {
+    TEST_ASSERT_TRUE(queue.pop(event));
+    TEST_ASSERT_EQUAL_UINT32(100U + i, event.tick);
+    TEST_ASSERT_EQUAL_UINT16(i, event.value);
+  }
+  TEST_ASSERT_TRUE(queue.isEmpty());
+  TEST_ASSERT_EQUAL_UINT16(2, queue.getDroppedCount());
+}
+
+void test_event_queue_index_wrap() {
+  TickEventQueue queue;
+  EventQueueMirror& mirror = reinterpret_cast<EventQueueMirror&>(queue);
+  TickEvent event;
+
+  // Free-running byte indices keep working across the 255 -> 0 rollover.
+  mirror.head = 254;
+  mirror.tail = 254;
+  for (uint32_t i = 0; i < 5; ++i) {
+    event.tick = i;
+    TEST_ASSERT_TRUE(queue.push(event));
+  }
+  TEST_ASSERT_EQUAL_UINT8(3, mirror.head);
+  TEST_ASSERT_EQUAL_UINT8(5, queue.size());
+  for (uint32_t i = 0; i < 5; ++i) {
+    TEST_ASSERT_TRUE(queue.pop(event));
+    TEST_ASSERT_EQUAL_UINT32(i, event.tick);
+  }
+  TEST_ASSERT_TRUE(queue.isEmpty());
+
+  mirror.dropped = 0xFFFF;
+  mirror.head = static_cast<uint8_t>(mirror.tail + TICK_EVENT_QUEUE_CAPACITY);
+  TEST_ASSERT_FALSE(queue.push(event));
+  TEST_ASSERT_EQUAL_UINT16(0xFFFF, queue.getDroppedCount());
+}
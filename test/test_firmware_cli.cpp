@@ -89,7 +89,12 @@ void test_firmware_cli_commands() {
   TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid frequency"));
 
   runCmd(cli, "pwm-freq 1000");
-  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "status"));
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":1000.000,\"resolutionBits\":13}\n",
+                           Serial.getOutput().c_str());
+
+  runCmd(cli, "pwm-freq 28854.832");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":28828.829,\"resolutionBits\":9}\n",
+                           Serial.getOutput().c_str());
 
   runCmd(cli, "pwm-freq 1000000");
   TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to set frequency"));
@@ -257,6 +262,33 @@ void test_firmware_cli_internal_edges() {
   runCmd(cli, "RESET extra");
   TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "resetting"));
 
+  // Tabs separate tokens, only the whole name matches, and tokens past a command's last
+  // argument are ignored.
+  runCmd(cli, "\tPwm-Freq\t500");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"status\":\"ok\""));
+  runCmd(cli, "pwm-freq 500 extra tokens");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"status\":\"ok\""));
+  runCmd(cli, "pwm");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unknown command"));
+  runCmd(cli, "analog?x");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unknown command"));
+  runCmd(cli, "encoder-rates 5");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unknown command"));
+  runCmd(cli, "STREAM?");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"streams\""));
+
+  // Every name resolves through the hash-ordered table, including analog? and reset, which
+  // share a hash.
+  const char* const kNames[] = {
+      "analog?",  "digital?",  "encoder?", "all?",         "load?",        "idle?",  "reset",
+      "pwm-freq", "pwm-duty",  "pwm-wave", "pwm-comp",     "pwm-square",   "pwm-sweep",
+      "pwm-step", "pwm-ramp",  "format",   "encoder-rate", "encoder-move", "stream",
+      "stream?",  "help"};
+  for (const char* name : kNames) {
+    runCmd(cli, name);
+    TEST_ASSERT_NULL(strstr(Serial.getOutput().c_str(), "unknown command"));
+  }
+
   Serial.clearOutput();
   advanceMillis(1);
   Serial.setInput("pwm-freq 500");
@@ -274,4 +306,698 @@ void test_firmware_cli_internal_edges() {
   Serial.setInput(longUnknown + "\n");
   cli.processSerial();
   TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unknown command"));
-}
\ No newline at end of file
+}
+void test_firmware_cli_load_governor() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  LoadGovernor governor;
+
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  TEST_ASSERT_TRUE(analog.begin(AnalogSampler::Config{aPins, 1, 5.0f}));
+  TEST_ASSERT_TRUE(digitalMonitor.begin(DigitalInputMonitor::Config{dPins, 1, 4, 1000.0f, false}));
+  TEST_ASSERT_TRUE(governor.begin(LoadGovernor::Config{800, 500, 1, 3}));
+
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "load?");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "load governor unavailable"));
+
+  Serial.clearOutput();
+  cli.reportLoadTransition();
+  TEST_ASSERT_EQUAL_STRING("", Serial.getOutput().c_str());
+
+  cli.setLoadGovernor(&governor);
+  TEST_ASSERT_TRUE(governor.update(912));
+  Serial.clearOutput();
+  cli.reportLoadTransition();
+  TEST_ASSERT_EQUAL_STRING("{\"event\":\"load\",\"from\":0,\"level\":1,\"utilization\":91.2}\n",
+                           Serial.getOutput().c_str());
+
+  runCmd(cli, "LOAD?");
+  TEST_ASSERT_EQUAL_STRING("{\"load\":{\"level\":1,\"utilization\":91.2,\"transitions\":1}}\n",
+                           Serial.getOutput().c_str());
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "load?"));
+}
+
+void test_firmware_cli_tick_events() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  TickEvent event;
+  event.tick = 1234;
+  event.source = 1;
+  event.code = TICK_EVENT_DIRECTION_CHANGED;
+  event.value = 0;
+  Serial.clearOutput();
+  cli.reportTickEvent(event);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"event\":\"direction\",\"direction\":\"DOWN\",\"source\":1,\"tick\":1234}\n",
+      Serial.getOutput().c_str());
+
+  event.value = 1;
+  Serial.clearOutput();
+  cli.reportTickEvent(event);
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"direction\":\"UP\""));
+
+  event.code = TICK_EVENT_WINDOW_OVERRUN;
+  event.source = 0;
+  Serial.clearOutput();
+  cli.reportTickEvent(event);
+  TEST_ASSERT_EQUAL_STRING("{\"event\":\"overrun\",\"source\":0,\"tick\":1234}\n",
+                           Serial.getOutput().c_str());
+
+  event.code = TICK_EVENT_WINDOW_READY;
+  Serial.clearOutput();
+  cli.reportTickEvent(event);
+  TEST_ASSERT_EQUAL_STRING("", Serial.getOutput().c_str());
+
+  cli.reportDroppedEvents(3);
+  TEST_ASSERT_EQUAL_STRING("{\"event\":\"dropped\",\"count\":3}\n", Serial.getOutput().c_str());
+}
+
+void test_firmware_cli_idle_manager() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  IdleManager idle;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "idle?");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "idle manager unavailable"));
+
+  cli.setIdleManager(&idle);
+  runCmd(cli, "idle?");
+  TEST_ASSERT_EQUAL_STRING("{\"idle\":{\"enabled\":false,\"percent\":0.0,\"sleeps\":0}}\n",
+                           Serial.getOutput().c_str());
+
+  TEST_ASSERT_TRUE(idle.begin(IdleManager::Config(true, 1)));
+  TEST_ASSERT_TRUE(idle.idle(nullptr));
+  mockMicros = 1000;
+  TEST_ASSERT_TRUE(idle.update());
+  runCmd(cli, "IDLE?");
+  TEST_ASSERT_EQUAL_STRING("{\"idle\":{\"enabled\":true,\"percent\":0.0,\"sleeps\":1}}\n",
+                           Serial.getOutput().c_str());
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "idle?"));
+}
+
+void test_firmware_cli_duty_ramp() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  DutyRamp ramp;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "pwm-ramp 0 50 10");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "duty ramp unavailable"));
+
+  TEST_ASSERT_TRUE(pwm.begin(Timer1PWM::timingForMilliHz(1000000UL)));
+  TEST_ASSERT_TRUE(ramp.begin(DutyRamp::Config(&pwm, 1000)));
+  cli.setDutyRamp(&ramp);
+
+  runCmd(cli, "pwm-ramp 0 50");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing ramp parameters"));
+  runCmd(cli, "pwm-ramp 2 50 10");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid channel"));
+  runCmd(cli, "pwm-ramp 0 x 10");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid duty"));
+  runCmd(cli, "pwm-ramp 0 50 0");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid rate"));
+  runCmd(cli, "pwm-ramp 0 50 0.049");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid rate"));
+  runCmd(cli, "pwm-ramp 0 50 6553.6");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid rate"));
+  TEST_ASSERT_FALSE(ramp.isActive(0));
+
+  // 100 %/s at 1 kHz is one permille per tick.
+  runCmd(cli, "PWM-RAMP 0 50 100");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\"}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_TRUE(ramp.isActive(0));
+  for (uint16_t i = 0; i < 100; ++i) ramp.onTick();
+  TEST_ASSERT_EQUAL_UINT16(100, ramp.getDutyPermille(0));
+
+  runCmd(cli, "pwm-duty 0 12.46");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "status"));
+  TEST_ASSERT_FALSE(ramp.isActive(0));
+  TEST_ASSERT_EQUAL_UINT16(125, ramp.getDutyPermille(0));
+  runCmd(cli, "pwm-duty 1 150");
+  TEST_ASSERT_EQUAL_UINT16(1000, ramp.getDutyPermille(1));
+  runCmd(cli, "pwm-duty 1 -5");
+  TEST_ASSERT_EQUAL_UINT16(0, ramp.getDutyPermille(1));
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "pwm-ramp"));
+}
+
+void test_firmware_cli_waveform() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "pwm-wave");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing frequency"));
+  runCmd(cli, "pwm-wave 0");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid frequency"));
+  runCmd(cli, "pwm-wave 50 101");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid amplitude"));
+  runCmd(cli, "pwm-wave 50 -1");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid amplitude"));
+  runCmd(cli, "pwm-wave 50");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to start waveform"));
+
+  TEST_ASSERT_TRUE(pwm.begin(Timer1PWM::Timing(511, 1)));
+  runCmd(cli, "PWM-WAVE 50 80");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":50.000}\n",
+                           Serial.getOutput().c_str());
+  TEST_ASSERT_TRUE(pwm.isWaveformActive());
+
+  // OC1B lags OC1A by a quarter period (625 samples per cycle at 31.25 kHz): it starts at its
+  // trough while OC1A crosses mid-scale, and a quarter period later plays what OC1A did.
+  Timer1PWM::handleOverflow();
+  uint16_t firstA = gWaveformCounts[0];
+  TEST_ASSERT_UINT16_WITHIN(8, 256, firstA);
+  TEST_ASSERT_TRUE(gWaveformCounts[1] < 64);
+  for (uint16_t i = 0; i < 625 / 4; ++i) Timer1PWM::handleOverflow();
+  TEST_ASSERT_UINT16_WITHIN(8, firstA, gWaveformCounts[1]);
+  TEST_ASSERT_TRUE(gWaveformCounts[0] > 448);
+
+  // A waveform cannot be retuned in place, so pwm-freq ends it and restarts Timer1.
+  runCmd(cli, "pwm-freq 1000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"frequency\":1000.000"));
+  TEST_ASSERT_FALSE(pwm.isWaveformActive());
+  runCmd(cli, "pwm-wave 50 80");
+  TEST_ASSERT_TRUE(pwm.isWaveformActive());
+
+  runCmd(cli, "pwm-wave off");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\"}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_FALSE(pwm.isWaveformActive());
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "pwm-wave"));
+}
+
+void test_firmware_cli_complementary() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "pwm-comp 20000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing complementary parameters"));
+  runCmd(cli, "pwm-comp x 16");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid frequency"));
+  runCmd(cli, "pwm-comp 20000 -1");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid dead time"));
+  runCmd(cli, "pwm-comp 20000 400");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to set complementary pwm"));
+  TEST_ASSERT_FALSE(pwm.isComplementary());
+
+  // 16 counts at clk/1 and 16 MHz is one microsecond per edge.
+  runCmd(cli, "PWM-COMP 20000 16");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":20000.000,\"deadTimeNs\":1000}\n",
+                           Serial.getOutput().c_str());
+  TEST_ASSERT_TRUE(pwm.isComplementary());
+
+  runCmd(cli, "pwm-comp off");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\"}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_FALSE(pwm.isComplementary());
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "pwm-comp"));
+}
+
+void test_firmware_cli_square_wave() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "pwm-square");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing frequency"));
+  runCmd(cli, "pwm-square x");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid frequency"));
+  runCmd(cli, "pwm-square 0.1");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to set square wave"));
+
+  // The reply carries the frequency Timer1 really produces: 2667 counts per half-period.
+  runCmd(cli, "pwm-square 3000");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":2999.625}\n",
+                           Serial.getOutput().c_str());
+  TEST_ASSERT_TRUE(pwm.isSquareWave());
+
+  // pwm-freq leaves square-wave mode by restarting Timer1 as PWM.
+  runCmd(cli, "pwm-freq 100");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"status\":\"ok\""));
+  TEST_ASSERT_FALSE(pwm.isSquareWave());
+
+  runCmd(cli, "pwm-sweep 1000 2000 4");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing sweep parameters"));
+  runCmd(cli, "pwm-sweep 1000 y 4 100");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid frequency"));
+  runCmd(cli, "pwm-sweep 1000 2000 0 100");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid steps"));
+  runCmd(cli, "pwm-sweep 1000 2000 4 1001");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid steps"));
+  runCmd(cli, "pwm-sweep 1000 2000 4 100 cubic");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid sweep option"));
+  runCmd(cli, "pwm-sweep 1000 20000 4 100");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to start sweep"));
+  TEST_ASSERT_FALSE(pwm.isSweepActive());
+
+  runCmd(cli, "pwm-sweep 1000 2000 4 100 log repeat");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":1000.000}\n",
+                           Serial.getOutput().c_str());
+  TEST_ASSERT_TRUE(pwm.isSweepActive());
+
+  // Stopping the sweep holds the output at the step being played.
+  runCmd(cli, "pwm-sweep off");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":1000.000}\n",
+                           Serial.getOutput().c_str());
+  TEST_ASSERT_FALSE(pwm.isSweepActive());
+  TEST_ASSERT_TRUE(pwm.isSquareWave());
+
+  runCmd(cli, "pwm-square off");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\"}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_FALSE(pwm.isSquareWave());
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "pwm-sweep"));
+}
+
+void test_firmware_cli_encoder_rate() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  TEST_ASSERT_TRUE(encoder.begin(9, 10, 2, 3));
+  runCmd(cli, "encoder-rate 100");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to set rate"));
+
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 2, 3, false, true, 10000}));
+  runCmd(cli, "encoder-rate");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing rate"));
+  runCmd(cli, "encoder-rate -5");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid rate"));
+  runCmd(cli, "encoder-rate 10000.001");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to set rate"));
+
+  runCmd(cli, "ENCODER-RATE 1234.5");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"rate\":1234.500}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_EQUAL_UINT32(1234500UL, encoder.getStepRateMilliHz());
+  runCmd(cli, "encoder-rate 0");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"rate\":0.000}\n", Serial.getOutput().c_str());
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "encoder-rate"));
+}
+
+void test_firmware_cli_encoder_move() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  TEST_ASSERT_TRUE(encoder.begin(9, 10, 2, 3));
+  runCmd(cli, "encoder-move 100 1000 5000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to start move"));
+
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 2, 3, false, true, 10000}));
+  runCmd(cli, "encoder-move 100 1000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing move parameters"));
+  runCmd(cli, "encoder-move 1.5 1000 5000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid position"));
+  runCmd(cli, "encoder-move 100 0 5000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid velocity"));
+  runCmd(cli, "encoder-move 100 1000 -1");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid acceleration"));
+  runCmd(cli, "encoder-move 100 10000 5000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to start move"));
+
+  runCmd(cli, "encoder-move -100 1000 5000");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\"}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_TRUE(encoder.isMoving());
+  TEST_ASSERT_EQUAL_INT32(-100, encoder.getMoveTarget());
+  // Stopping before the first step leaves nothing to ramp down.
+  runCmd(cli, "encoder-move stop");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"target\":0}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_FALSE(encoder.isMoving());
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "encoder-move"));
+}
+
+void test_firmware_cli_pwm_step() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "pwm-step 100 500 5000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing step parameters"));
+  runCmd(cli, "pwm-step 0 500 5000 20000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid steps"));
+  runCmd(cli, "pwm-step 100 500 70000 20000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid step rate"));
+  runCmd(cli, "pwm-step 100 500 5000 -1");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid acceleration"));
+  runCmd(cli, "pwm-step 100 500 5000 20000 up");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid direction"));
+  // 50 kHz is faster than the overflow ISR can load periods.
+  runCmd(cli, "pwm-step 100 500 50000 20000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to start steps"));
+  TEST_ASSERT_FALSE(pwm.isStepping());
+
+  TEST_ASSERT_TRUE(pwm.beginSquareWave(Timer1PWM::squareWaveTimingForMilliHz(1000000UL)));
+  runCmd(cli, "pwm-step 100 500 5000 20000 rev");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\"}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_TRUE(pwm.isStepping());
+  TEST_ASSERT_FALSE(pwm.isSquareWave());
+  TEST_ASSERT_FALSE(pwm.getTiming().isValid());
+
+  runCmd(cli, "pwm-step stop");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"done\":0}\n", Serial.getOutput().c_str());
+  TEST_ASSERT_FALSE(pwm.isStepping());
+
+  // pwm-freq leaves step mode by restarting Timer1 as PWM.
+  runCmd(cli, "pwm-step 100 500 5000 20000");
+  runCmd(cli, "pwm-freq 100");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"status\":\"ok\""));
+  TEST_ASSERT_FALSE(pwm.isStepping());
+
+  runCmd(cli, "help");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "pwm-step"));
+}
+
+void test_firmware_cli_binary_format() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0, 1};
+  const uint8_t dPins[] = {2};
+  TEST_ASSERT_TRUE(analog.begin(AnalogSampler::Config{aPins, 2, 5.0f}));
+  TEST_ASSERT_TRUE(digitalMonitor.begin(DigitalInputMonitor::Config{dPins, 1, 4, 1000.0f, false}));
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 4, 5, false, true}));
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 2, dPins, 1});
+
+  mockAnalogValues[0] = 1023;
+  mockAnalogValues[1] = 0;
+  analog.onTick();
+  analog.sampleIfDue();
+  setDigitalPin(4, true);
+  encoder.onTick();
+  encoder.onTick();
+
+  runCmd(cli, "format");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing format"));
+  runCmd(cli, "format json");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid format"));
+  runCmd(cli, "format bin");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"format\":\"bin\"}\n", Serial.getOutput().c_str());
+
+  std::string record;
+  runCmd(cli, "analog?");
+  TEST_ASSERT_TRUE(decodeFrame(Serial.getOutput(), record));
+  const char analogRecord[] = {FirmwareCli::RECORD_ANALOG, 0, 1, 0, 0, 0, 2, '\x88', 0x13, 0, 0};
+  TEST_ASSERT_EQUAL_UINT32(sizeof(analogRecord), record.size());
+  TEST_ASSERT_EQUAL_MEMORY(analogRecord, record.data(), sizeof(analogRecord));
+
+  runCmd(cli, "encoder?");
+  TEST_ASSERT_TRUE(decodeFrame(Serial.getOutput(), record));
+  const char encoderRecord[] = {FirmwareCli::RECORD_ENCODER, 1, 1, 2, 0, 0, 0};
+  TEST_ASSERT_EQUAL_UINT32(sizeof(encoderRecord), record.size());
+  TEST_ASSERT_EQUAL_MEMORY(encoderRecord, record.data(), sizeof(encoderRecord));
+
+  runCmd(cli, "digital?");
+  TEST_ASSERT_TRUE(decodeFrame(Serial.getOutput(), record));
+  TEST_ASSERT_EQUAL_UINT32(2 + 10 + 6, record.size());
+  TEST_ASSERT_EQUAL_UINT8(FirmwareCli::RECORD_DIGITAL, record[0]);
+  TEST_ASSERT_EQUAL_UINT8(2, record[1]);
+  TEST_ASSERT_EQUAL_UINT8(1, record[2]);
+
+  // all? concatenates the three payloads in one record: 9 + 16 + 5 bytes for this setup,
+  // against well over a hundred characters of JSON.
+  runCmd(cli, "all?");
+  TEST_ASSERT_TRUE(decodeFrame(Serial.getOutput(), record));
+  TEST_ASSERT_EQUAL_UINT32(2 + 9 + 16 + 5, record.size());
+  TEST_ASSERT_EQUAL_UINT8(FirmwareCli::RECORD_ALL, record[0]);
+  TEST_ASSERT_EQUAL_UINT8(3, record[1]);
+  TEST_ASSERT_EQUAL_MEMORY(analogRecord + 2, record.data() + 2, 9);
+  TEST_ASSERT_EQUAL_MEMORY(encoderRecord + 2, record.data() + 27, 5);
+  TEST_ASSERT_TRUE(Serial.getOutput().size() < 40);
+
+  // Commands that are not data queries still answer with text lines.
+  runCmd(cli, "pwm-duty 3 50");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid channel"));
+
+  runCmd(cli, "format text");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"format\":\"text\"}\n", Serial.getOutput().c_str());
+  runCmd(cli, "encoder?");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"position\":2"));
+}
+
+void test_firmware_cli_streams() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  TEST_ASSERT_TRUE(analog.begin(AnalogSampler::Config{aPins, 1, 5.0f}));
+  TEST_ASSERT_TRUE(digitalMonitor.begin(DigitalInputMonitor::Config{dPins, 1, 4, 1000.0f, false}));
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 4, 5, false, true}));
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "stream");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "missing stream source"));
+  runCmd(cli, "stream pwm");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid stream source"));
+  runCmd(cli, "stream analog -1");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "invalid interval"));
+
+  // Only rounds sampled after subscribing are pushed, each exactly once.
+  analog.onTick();
+  analog.sampleIfDue();
+  runCmd(cli, "stream analog");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\"}\n", Serial.getOutput().c_str());
+  Serial.clearOutput();
+  cli.serviceStreams();
+  TEST_ASSERT_EQUAL_STRING("", Serial.getOutput().c_str());
+  analog.onTick();
+  analog.sampleIfDue();
+  cli.serviceStreams();
+  cli.serviceStreams();
+  TEST_ASSERT_EQUAL_STRING("{\"stream\":\"analog\",\"round\":2,\"a0\":0.000}\n",
+                           Serial.getOutput().c_str());
+
+  // With a 10 ms interval the round sampled 5 ms after a record is skipped and counted.
+  runCmd(cli, "stream analog 10");
+  Serial.clearOutput();
+  for (uint8_t i = 0; i < 3; ++i) {
+    analog.onTick();
+    analog.sampleIfDue();
+    cli.serviceStreams();
+    advanceMillis(5);
+  }
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"round\":3"));
+  TEST_ASSERT_NULL(strstr(Serial.getOutput().c_str(), "\"round\":4"));
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"round\":5"));
+  runCmd(cli, "stream?");
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"streams\":{\"analog\":{\"enabled\":true,\"intervalMs\":10,\"dropped\":1},"
+      "\"digital\":{\"enabled\":false,\"intervalMs\":0,\"dropped\":0},"
+      "\"encoder\":{\"enabled\":false,\"intervalMs\":0,\"dropped\":0}}}\n",
+      Serial.getOutput().c_str());
+  runCmd(cli, "stream analog off");
+  analog.onTick();
+  analog.sampleIfDue();
+  Serial.clearOutput();
+  cli.serviceStreams();
+  TEST_ASSERT_EQUAL_STRING("", Serial.getOutput().c_str());
+
+  // Each published digital frame is pushed once.
+  runCmd(cli, "stream digital");
+  Serial.clearOutput();
+  for (uint8_t i = 0; i < 4; ++i) digitalMonitor.onTick();
+  digitalMonitor.updateIfReady();
+  cli.serviceStreams();
+  cli.serviceStreams();
+  const std::string digitalOut = Serial.getOutput();
+  TEST_ASSERT_EQUAL_UINT32(0, digitalOut.find("{\"stream\":\"digital\",\"frameSeq\":1,"));
+  TEST_ASSERT_EQUAL_UINT32(digitalOut.size() - 1, digitalOut.find('\n'));
+
+  // The encoder starts with its current position, then follows changes.
+  runCmd(cli, "stream encoder");
+  Serial.clearOutput();
+  cli.serviceStreams();
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"stream\":\"encoder\""));
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"position\":0"));
+  Serial.clearOutput();
+  cli.serviceStreams();
+  TEST_ASSERT_EQUAL_STRING("", Serial.getOutput().c_str());
+  setDigitalPin(4, true);
+  encoder.onTick();
+
+  // In binary format the same records go out as frames.
+  runCmd(cli, "format bin");
+  Serial.clearOutput();
+  cli.serviceStreams();
+  std::string record;
+  TEST_ASSERT_TRUE(decodeFrame(Serial.getOutput(), record));
+  TEST_ASSERT_EQUAL_UINT8(FirmwareCli::RECORD_ENCODER, record[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, record[3]);
+
+  runCmd(cli, "stream off");
+  encoder.onTick();
+  Serial.clearOutput();
+  cli.serviceStreams();
+  TEST_ASSERT_EQUAL_STRING("", Serial.getOutput().c_str());
+}
+
+void test_firmware_cli_buffered_output() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  TEST_ASSERT_TRUE(analog.begin(AnalogSampler::Config{aPins, 1, 5.0f}));
+  TEST_ASSERT_TRUE(digitalMonitor.begin(DigitalInputMonitor::Config{dPins, 1, 4, 1000.0f, false}));
+  TEST_ASSERT_TRUE(encoder.begin(EncoderGenerator::Config{9, 10, 4, 5, false, true}));
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "digital?");
+  std::string expected = Serial.getOutput();
+  runCmd(cli, "load?");
+  expected += Serial.getOutput();
+
+  // A slow link takes only what fits its TX buffer; the rest waits in the ring, and the next
+  // command stays unread until the reply has mostly drained.
+  Serial.setTxRoom(16);
+  runCmd(cli, "digital?\nload?");
+  TEST_ASSERT_EQUAL_UINT32(16, static_cast<uint32_t>(Serial.getOutput().size()));
+  TEST_ASSERT_TRUE(Serial.available() > 0);
+  TEST_ASSERT_FALSE(cli.hasRoomForReport());
+  for (uint8_t i = 0; i < 40 && Serial.getOutput().size() < expected.size(); ++i) {
+    Serial.setTxRoom(16);
+    cli.processSerial();
+  }
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), Serial.getOutput().c_str());
+  TEST_ASSERT_EQUAL_UINT32(0, static_cast<uint32_t>(Serial.available()));
+  TEST_ASSERT_TRUE(cli.hasRoomForReport());
+
+  // Help is longer than the ring. With no room at all only what fits is queued; the rest
+  // follows in pieces as the link drains, and the next command and reports wait for it.
+  Serial.setTxRoom(MockSerial::kUnlimitedTxRoom);
+  runCmd(cli, "help");
+  expected = Serial.getOutput();
+  TEST_ASSERT_NOT_NULL(strstr(expected.c_str(), "stream?\"}\n"));
+  runCmd(cli, "load?");
+  expected += Serial.getOutput();
+  Serial.setTxRoom(0);
+  runCmd(cli, "help\nload?");
+  TEST_ASSERT_EQUAL_STRING("", Serial.getOutput().c_str());
+  TEST_ASSERT_FALSE(cli.hasRoomForReport());
+  for (uint8_t i = 0; i < 80 && Serial.getOutput().size() < expected.size(); ++i) {
+    Serial.setTxRoom(16);
+    cli.processSerial();
+  }
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), Serial.getOutput().c_str());
+
+  // A text all? reply goes out in pieces with the same bytes as in one pass.
+  Serial.setTxRoom(MockSerial::kUnlimitedTxRoom);
+  runCmd(cli, "all?");
+  expected = Serial.getOutput();
+  TEST_ASSERT_NOT_NULL(strstr(expected.c_str(), "\"d2\":{"));
+  TEST_ASSERT_NOT_NULL(strstr(expected.c_str(), "\"position\":"));
+  Serial.setTxRoom(8);
+  runCmd(cli, "all?");
+  for (uint8_t i = 0; i < 80 && Serial.getOutput().size() < expected.size(); ++i) {
+    Serial.setTxRoom(8);
+    cli.processSerial();
+  }
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), Serial.getOutput().c_str());
+  Serial.setTxRoom(MockSerial::kUnlimitedTxRoom);
+}
+
+void test_firmware_cli_pwm_retune() {
+  AnalogSampler analog;
+  DigitalInputMonitor digitalMonitor;
+  EncoderGenerator encoder;
+  Timer1PWM pwm;
+  const uint8_t aPins[] = {0};
+  const uint8_t dPins[] = {2};
+  FirmwareCli cli(analog, digitalMonitor, encoder, pwm, FirmwareCli::Config{aPins, 1, dPins, 1});
+
+  runCmd(cli, "pwm-freq 1000");
+  TEST_ASSERT_FALSE(pwm.isUpdatePending());
+  TEST_ASSERT_EQUAL_UINT32(1000000UL, pwm.getTiming().frequencyMilliHz());
+
+  // A running output is staged rather than restarted and keeps its timing until the two
+  // overflow passes have committed it.
+  runCmd(cli, "pwm-freq 2000");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":2000.000,\"resolutionBits\":12}\n",
+                           Serial.getOutput().c_str());
+  TEST_ASSERT_TRUE(pwm.isUpdatePending());
+  TEST_ASSERT_EQUAL_UINT32(1000000UL, pwm.getTiming().frequencyMilliHz());
+  Timer1PWM::handleOverflow();
+  TEST_ASSERT_TRUE(pwm.isUpdatePending());
+  TEST_ASSERT_EQUAL_UINT32(1000000UL, pwm.getTiming().frequencyMilliHz());
+  Timer1PWM::handleOverflow();
+  TEST_ASSERT_FALSE(pwm.isUpdatePending());
+  TEST_ASSERT_EQUAL_UINT32(2000000UL, pwm.getTiming().frequencyMilliHz());
+
+  // Periods under 256 clocks cannot be staged, in either direction; Timer1 restarts instead.
+  runCmd(cli, "pwm-freq 100000");
+  TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\",\"frequency\":100000.000,\"resolutionBits\":7}\n",
+                           Serial.getOutput().c_str());
+  TEST_ASSERT_FALSE(pwm.isUpdatePending());
+  TEST_ASSERT_EQUAL_UINT32(100000000UL, pwm.getTiming().frequencyMilliHz());
+  runCmd(cli, "pwm-freq 1000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "\"status\":\"ok\""));
+  TEST_ASSERT_FALSE(pwm.isUpdatePending());
+  TEST_ASSERT_EQUAL_UINT32(1000000UL, pwm.getTiming().frequencyMilliHz());
+
+  // Complementary mode is the one case that refuses.
+  runCmd(cli, "pwm-comp 20000 16");
+  runCmd(cli, "pwm-freq 1000");
+  TEST_ASSERT_NOT_NULL(strstr(Serial.getOutput().c_str(), "unable to set frequency"));
+  TEST_ASSERT_TRUE(pwm.isComplementary());
+}
@@ -0,0 +1,84 @@
+#include <string>
+
+#include <unity.h>
+
+#include "frame_codec.h"
+#include "test_support.h"
+
+void test_frame_codec_crc_and_cobs() {
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  TEST_ASSERT_EQUAL_HEX16(0x6F91, FrameEncoder::crc16(0xFFFF, check, sizeof(check)));
+  // Folding in two parts gives the same CRC.
+  uint16_t crc = FrameEncoder::crc16(0xFFFF, check, 4);
+  TEST_ASSERT_EQUAL_HEX16(0x6F91, FrameEncoder::crc16(crc, check + 4, 5));
+
+  uint8_t out[254];
+  const uint8_t zero[] = {0x00};
+  TEST_ASSERT_EQUAL_UINT8(2, FrameEncoder::cobsEncode(zero, 1, out));
+  TEST_ASSERT_EQUAL_HEX8(0x01, out[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x01, out[1]);
+
+  const uint8_t mixed[] = {0x11, 0x22, 0x00, 0x33};
+  const uint8_t mixedEncoded[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+  TEST_ASSERT_EQUAL_UINT8(5, FrameEncoder::cobsEncode(mixed, 4, out));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(mixedEncoded, out, 5);
+
+  // The longest input is one run of 253 non-zero bytes behind a single code byte.
+  uint8_t run[253];
+  for (uint8_t i = 0; i < 253; ++i) run[i] = static_cast<uint8_t>(i + 1U);
+  TEST_ASSERT_EQUAL_UINT8(254, FrameEncoder::cobsEncode(run, 253, out));
+  TEST_ASSERT_EQUAL_HEX8(0xFE, out[0]);
+  TEST_ASSERT_EQUAL_HEX8(0xFD, out[253]);
+}
+
+void test_frame_codec_records() {
+  FrameEncoder frame;
+  uint8_t out[FrameEncoder::MAX_ENCODED];
+
+  frame.begin(3, 0x80);
+  TEST_ASSERT_TRUE(frame.putU8(0));
+  TEST_ASSERT_TRUE(frame.putU16(0x1234));
+  TEST_ASSERT_TRUE(frame.putI32(-2));
+  TEST_ASSERT_EQUAL_UINT8(7, frame.getPayloadLength());
+  uint8_t length = frame.finish(out);
+  TEST_ASSERT_TRUE(length > 0);
+  TEST_ASSERT_EQUAL_HEX8(0x00, out[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x00, out[length - 1]);
+  for (uint8_t i = 1; i + 1 < length; ++i) TEST_ASSERT_TRUE(out[i] != 0);
+
+  std::string record;
+  TEST_ASSERT_TRUE(decodeFrame(std::string(reinterpret_cast<char*>(out), length), record));
+  const char expected[] = {3, '\x80', 0, 0x34, 0x12, '\xFE', '\xFF', '\xFF', '\xFF'};
+  TEST_ASSERT_EQUAL_UINT32(sizeof(expected), record.size());
+  TEST_ASSERT_EQUAL_MEMORY(expected, record.data(), sizeof(expected));
+
+  // A corrupted byte fails the CRC.
+  out[3] ^= 0x01;
+  TEST_ASSERT_FALSE(decodeFrame(std::string(reinterpret_cast<char*>(out), length), record));
+
+  // COBS removes only zeros: newline bytes stay in a valid frame, here in the payload and as
+  // the first code byte (nine non-zero bytes before the payload's zero), so a host must not
+  // treat 0x0A as the sign of a text line.
+  std::string newlineRecord;
+  frame.begin(2, 0x0A);
+  TEST_ASSERT_TRUE(frame.putU32(0x0A0A0A0AUL));
+  TEST_ASSERT_TRUE(frame.putU16(0x0A0A));
+  TEST_ASSERT_TRUE(frame.putU8(0x0A));
+  TEST_ASSERT_TRUE(frame.putU8(0));
+  uint8_t newlineLength = frame.finish(out);
+  TEST_ASSERT_EQUAL_HEX8(0x0A, out[1]);
+  TEST_ASSERT_TRUE(decodeFrame(std::string(reinterpret_cast<char*>(out), newlineLength),
+                               newlineRecord));
+  const char newlineExpected[] = {2, '\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n', 0};
+  TEST_ASSERT_EQUAL_UINT32(sizeof(newlineExpected), newlineRecord.size());
+  TEST_ASSERT_EQUAL_MEMORY(newlineExpected, newlineRecord.data(), sizeof(newlineExpected));
+
+  // A payload that overflows is never sent, even after later puts fit.
+  frame.begin(1, 0);
+  for (uint8_t i = 0; i < FrameEncoder::MAX_PAYLOAD / 4; ++i) TEST_ASSERT_TRUE(frame.putU32(i));
+  TEST_ASSERT_FALSE(frame.putU16(1));
+  TEST_ASSERT_EQUAL_UINT8(0, frame.finish(out));
+  frame.begin(1, 1);
+  TEST_ASSERT_TRUE(frame.putU8(7));
+  TEST_ASSERT_TRUE(frame.finish(out) > 0);
+}
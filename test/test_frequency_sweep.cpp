@@ -0,0 +1,136 @@
+#include <unity.h>
+
+#include "frequency_sweep.h"
+#include "test_support.h"
+
+namespace {
+
+constexpr uint32_t kClockHz = 16000000UL;
+constexpr uint32_t kMinHalfPeriod = 512;
+
+FrequencySweep::Config linearConfig(uint32_t startMilliHz, uint32_t stopMilliHz, uint16_t steps,
+                                    uint16_t stepHz, bool repeat) {
+  return FrequencySweep::Config(startMilliHz, stopMilliHz, steps, stepHz,
+                                FrequencySweep::LINEAR, repeat);
+}
+
+// Plays half-periods until the next step is due and applies it, as the compare ISR does.
+uint16_t playStep(FrequencySweep& sweep, bool& more) {
+  uint16_t halfPeriods = 1;
+  while (!sweep.onHalfPeriod()) ++halfPeriods;
+  more = sweep.advance();
+  return halfPeriods;
+}
+
+}  // namespace
+
+void test_frequency_sweep_config_edges() {
+  FrequencySweep sweep;
+  TEST_ASSERT_FALSE(sweep.hasNext());
+  TEST_ASSERT_FALSE(sweep.onHalfPeriod());
+  TEST_ASSERT_FALSE(sweep.advance());
+
+  TEST_ASSERT_FALSE(sweep.begin(linearConfig(1000000, 2000000, 0, 100, false), kClockHz,
+                                kMinHalfPeriod));
+  TEST_ASSERT_FALSE(sweep.begin(linearConfig(1000000, 2000000, 4, 0, false), kClockHz,
+                                kMinHalfPeriod));
+  TEST_ASSERT_FALSE(sweep.begin(linearConfig(1000000, 2000000, 4, 1001, false), kClockHz,
+                                kMinHalfPeriod));
+  TEST_ASSERT_FALSE(sweep.begin(linearConfig(0, 2000000, 4, 100, false), kClockHz,
+                                kMinHalfPeriod));
+  TEST_ASSERT_FALSE(sweep.begin(linearConfig(1000000, 65535001UL, 4, 100, false), kClockHz,
+                                kMinHalfPeriod));
+  TEST_ASSERT_FALSE(sweep.begin(linearConfig(1000000, 2000000, 4, 100, false), 0,
+                                kMinHalfPeriod));
+  // 15.625 kHz is exactly 512 clocks per half-period; anything faster is refused.
+  TEST_ASSERT_TRUE(sweep.begin(linearConfig(1000000, 15625000UL, 4, 100, false), kClockHz,
+                               kMinHalfPeriod));
+  TEST_ASSERT_FALSE(sweep.begin(linearConfig(1000000, 15700000UL, 4, 100, false), kClockHz,
+                                kMinHalfPeriod));
+  TEST_ASSERT_FALSE(sweep.hasNext());
+  // 0.1 Hz needs 80e6 clocks per half-period, beyond TOP 65535 at clk/1024.
+  TEST_ASSERT_FALSE(sweep.begin(linearConfig(100, 2000000, 4, 100, false), kClockHz,
+                                kMinHalfPeriod));
+
+  // A logarithmic step may change the frequency by less than a factor of 16.
+  FrequencySweep::Config log(100000, 1600000UL, 1, 100, FrequencySweep::LOGARITHMIC, false);
+  TEST_ASSERT_FALSE(sweep.begin(log, kClockHz, kMinHalfPeriod));
+  log.stopMilliHz = 1500000UL;
+  TEST_ASSERT_TRUE(sweep.begin(log, kClockHz, kMinHalfPeriod));
+
+  // Low frequencies move to slower prescalers: 1 Hz is 8e6 clocks, 31250 counts at clk/256.
+  TEST_ASSERT_TRUE(sweep.begin(linearConfig(1000, 2000, 1, 1, false), kClockHz, kMinHalfPeriod));
+  TEST_ASSERT_EQUAL_UINT16(31249, sweep.current().top);
+  TEST_ASSERT_EQUAL_UINT8(4, sweep.current().clockSelect);
+  TEST_ASSERT_EQUAL_UINT32(8000000UL, sweep.current().halfPeriodClocks);
+  TEST_ASSERT_EQUAL_UINT16(62499, sweep.next().top);
+  TEST_ASSERT_EQUAL_UINT8(3, sweep.next().clockSelect);
+  TEST_ASSERT_EQUAL_UINT32(16000000UL, sweep.getDwellClocks());
+}
+
+void test_frequency_sweep_steps() {
+  FrequencySweep sweep;
+  // 1 kHz to 2 kHz in four 250 Hz steps at 100 steps per second (160000 clocks each).
+  TEST_ASSERT_TRUE(sweep.begin(linearConfig(1000000, 2000000, 4, 100, false), kClockHz,
+                               kMinHalfPeriod));
+  TEST_ASSERT_EQUAL_UINT32(160000UL, sweep.getDwellClocks());
+  TEST_ASSERT_EQUAL_UINT16(0, sweep.getStepIndex());
+  TEST_ASSERT_EQUAL_UINT16(7999, sweep.current().top);
+  TEST_ASSERT_EQUAL_UINT8(1, sweep.current().clockSelect);
+  TEST_ASSERT_TRUE(sweep.hasNext());
+  TEST_ASSERT_EQUAL_UINT16(6399, sweep.next().top);
+
+  bool more = false;
+  // 1 kHz holds for 20 half-periods of 8000 clocks.
+  TEST_ASSERT_EQUAL_UINT16(20, playStep(sweep, more));
+  TEST_ASSERT_TRUE(more);
+  TEST_ASSERT_EQUAL_UINT16(1, sweep.getStepIndex());
+  TEST_ASSERT_EQUAL_UINT16(6399, sweep.current().top);
+  // 1250 Hz: 25 half-periods of 6400 clocks.
+  TEST_ASSERT_EQUAL_UINT16(25, playStep(sweep, more));
+  TEST_ASSERT_EQUAL_UINT16(5332, sweep.current().top);
+  // 1500 Hz: 31 half-periods of 5333 clocks overshoot by 5323, which carry into 1750 Hz.
+  TEST_ASSERT_EQUAL_UINT16(31, playStep(sweep, more));
+  TEST_ASSERT_EQUAL_UINT16(4570, sweep.current().top);
+  TEST_ASSERT_EQUAL_UINT16(34, playStep(sweep, more));
+  TEST_ASSERT_FALSE(more);
+  TEST_ASSERT_EQUAL_UINT16(4, sweep.getStepIndex());
+  TEST_ASSERT_EQUAL_UINT16(3999, sweep.current().top);
+  TEST_ASSERT_FALSE(sweep.hasNext());
+  TEST_ASSERT_FALSE(sweep.onHalfPeriod());
+
+  // Downward and repeating: 2 kHz -> 1 kHz in one step, then back to the start.
+  TEST_ASSERT_TRUE(sweep.begin(linearConfig(2000000, 1000000, 1, 100, true), kClockHz,
+                               kMinHalfPeriod));
+  TEST_ASSERT_EQUAL_UINT16(3999, sweep.current().top);
+  TEST_ASSERT_TRUE(sweep.advance());
+  TEST_ASSERT_EQUAL_UINT16(7999, sweep.current().top);
+  TEST_ASSERT_EQUAL_UINT16(3999, sweep.next().top);
+  TEST_ASSERT_TRUE(sweep.advance());
+  TEST_ASSERT_EQUAL_UINT16(0, sweep.getStepIndex());
+  TEST_ASSERT_EQUAL_UINT16(3999, sweep.current().top);
+
+  // Logarithmic: 100 Hz to 10 kHz in four steps is a ratio of sqrt(10) per step.
+  FrequencySweep::Config log(100000, 10000000UL, 4, 100, FrequencySweep::LOGARITHMIC, false);
+  TEST_ASSERT_TRUE(sweep.begin(log, kClockHz, kMinHalfPeriod));
+  TEST_ASSERT_EQUAL_UINT16(9999, sweep.current().top);
+  TEST_ASSERT_EQUAL_UINT8(2, sweep.current().clockSelect);
+  TEST_ASSERT_EQUAL_UINT32(80000UL, sweep.current().halfPeriodClocks);
+  TEST_ASSERT_TRUE(sweep.advance());
+  // 316.228 Hz is 25298.2 clocks per half-period.
+  TEST_ASSERT_UINT32_WITHIN(1, 25298UL, sweep.current().halfPeriodClocks);
+  TEST_ASSERT_EQUAL_UINT8(1, sweep.current().clockSelect);
+  TEST_ASSERT_TRUE(sweep.advance());
+  TEST_ASSERT_UINT32_WITHIN(1, 8000UL, sweep.current().halfPeriodClocks);
+  TEST_ASSERT_TRUE(sweep.advance());
+  TEST_ASSERT_UINT32_WITHIN(1, 2530UL, sweep.current().halfPeriodClocks);
+  TEST_ASSERT_FALSE(sweep.advance());
+  TEST_ASSERT_EQUAL_UINT32(800UL, sweep.current().halfPeriodClocks);
+
+  // A step shorter than a half-period plays for one half-period without building a backlog.
+  TEST_ASSERT_TRUE(sweep.begin(linearConfig(1000, 1000000, 999, 1000, false), kClockHz,
+                               kMinHalfPeriod));
+  TEST_ASSERT_EQUAL_UINT16(1, playStep(sweep, more));
+  TEST_ASSERT_EQUAL_UINT16(1, playStep(sweep, more));
+  TEST_ASSERT_EQUAL_UINT16(2, sweep.getStepIndex());
+}
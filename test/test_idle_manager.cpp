@@ -0,0 +1,73 @@
+#include <unity.h>
+
+#include "idle_manager.h"
+#include "test_support.h"
+
+namespace {
+
+bool gPendingWork = false;
+uint32_t gPendingChecks = 0;
+
+// Stands in for the interrupt that ends a sleep: time passes between the check and the wake.
+bool pendingWorkAdvancing250us() {
+  ++gPendingChecks;
+  if (gPendingWork) return true;
+  mockMicros += 250;
+  return false;
+}
+
+}  // namespace
+
+void test_idle_manager_config_edges() {
+  IdleManager idle;
+  TEST_ASSERT_FALSE(idle.isSleepEnabled());
+  TEST_ASSERT_FALSE(idle.idle(nullptr));
+  TEST_ASSERT_FALSE(idle.update());
+
+  TEST_ASSERT_FALSE(idle.begin(IdleManager::Config(true, 0)));
+  TEST_ASSERT_FALSE(idle.begin(IdleManager::Config(true, 60001)));
+  TEST_ASSERT_FALSE(idle.isSleepEnabled());
+
+  TEST_ASSERT_TRUE(idle.begin(IdleManager::Config(false, 100)));
+  TEST_ASSERT_FALSE(idle.isSleepEnabled());
+  gPendingChecks = 0;
+  TEST_ASSERT_FALSE(idle.idle(pendingWorkAdvancing250us));
+  TEST_ASSERT_EQUAL_UINT32(0, gPendingChecks);
+  TEST_ASSERT_EQUAL_UINT32(0, idle.getSleepCount());
+
+  TEST_ASSERT_TRUE(idle.begin(IdleManager::Config()));
+  TEST_ASSERT_TRUE(idle.isSleepEnabled());
+  TEST_ASSERT_TRUE(idle.idle(nullptr));
+  TEST_ASSERT_EQUAL_UINT32(1, idle.getSleepCount());
+}
+
+void test_idle_manager_idle_fraction() {
+  IdleManager idle;
+  TEST_ASSERT_TRUE(idle.begin(IdleManager::Config(true, 1)));
+
+  gPendingWork = true;
+  gPendingChecks = 0;
+  TEST_ASSERT_FALSE(idle.idle(pendingWorkAdvancing250us));
+  TEST_ASSERT_EQUAL_UINT32(1, gPendingChecks);
+  TEST_ASSERT_EQUAL_UINT32(0, idle.getSleepCount());
+
+  gPendingWork = false;
+  TEST_ASSERT_TRUE(idle.idle(pendingWorkAdvancing250us));
+  TEST_ASSERT_TRUE(idle.idle(pendingWorkAdvancing250us));
+  TEST_ASSERT_EQUAL_UINT32(2, idle.getSleepCount());
+  TEST_ASSERT_EQUAL_UINT32(500, mockMicros);
+  TEST_ASSERT_FALSE(idle.update());
+
+  mockMicros = 1250;
+  TEST_ASSERT_TRUE(idle.update());
+  TEST_ASSERT_EQUAL_UINT16(400, idle.getIdlePermille());
+
+  // A fully idle interval reports 1000 and never more.
+  for (uint8_t i = 0; i < 5; ++i) TEST_ASSERT_TRUE(idle.idle(pendingWorkAdvancing250us));
+  TEST_ASSERT_TRUE(idle.update());
+  TEST_ASSERT_EQUAL_UINT16(1000, idle.getIdlePermille());
+
+  mockMicros += 2000;
+  TEST_ASSERT_TRUE(idle.update());
+  TEST_ASSERT_EQUAL_UINT16(0, idle.getIdlePermille());
+}
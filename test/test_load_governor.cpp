@@ -0,0 +1,69 @@
+#include <unity.h>
+
+#include "avr_timer2_driver.h"
+#include "load_governor.h"
+#include "test_support.h"
+
+void test_load_governor_config_edges() {
+  LoadGovernor governor;
+
+  TEST_ASSERT_FALSE(governor.begin(LoadGovernor::Config{1001, 500, 4, 3}));
+  TEST_ASSERT_FALSE(governor.begin(LoadGovernor::Config{800, 800, 4, 3}));
+  TEST_ASSERT_FALSE(governor.begin(LoadGovernor::Config{800, 500, 0, 3}));
+  TEST_ASSERT_FALSE(governor.begin(LoadGovernor::Config{800, 500, 4, 0}));
+  TEST_ASSERT_FALSE(governor.begin(LoadGovernor::Config{800, 500, 4, LoadGovernor::MAX_LEVEL + 1}));
+  TEST_ASSERT_TRUE(governor.begin(LoadGovernor::Config()));
+  TEST_ASSERT_EQUAL_UINT8(0, governor.getLevel());
+  TEST_ASSERT_EQUAL_UINT32(0, governor.getTransitionCount());
+
+  Timer2Driver::LoadSample sample;
+  TEST_ASSERT_EQUAL_UINT16(0, sample.utilizationPermille());
+  sample.busyCounts = 10;
+  TEST_ASSERT_EQUAL_UINT16(1000, sample.utilizationPermille());
+  sample.ticks = 100;
+  sample.periodCounts = 200;
+  sample.busyCounts = 5000;
+  TEST_ASSERT_EQUAL_UINT16(250, sample.utilizationPermille());
+  sample.busyCounts = 30000;
+  TEST_ASSERT_EQUAL_UINT16(1000, sample.utilizationPermille());
+  sample.ticks = 60000;
+  sample.periodCounts = 256;
+  sample.busyCounts = 7680000UL;
+  TEST_ASSERT_EQUAL_UINT16(500, sample.utilizationPermille());
+}
+
+void test_load_governor_shed_and_restore() {
+  LoadGovernor governor;
+  TEST_ASSERT_TRUE(governor.begin(LoadGovernor::Config{800, 500, 2, 2}));
+
+  TEST_ASSERT_FALSE(governor.update(300));
+  TEST_ASSERT_FALSE(governor.update(700));
+  TEST_ASSERT_EQUAL_UINT8(0, governor.getLevel());
+
+  TEST_ASSERT_TRUE(governor.update(850));
+  TEST_ASSERT_EQUAL_UINT8(1, governor.getLevel());
+  TEST_ASSERT_EQUAL_UINT8(0, governor.getPreviousLevel());
+  TEST_ASSERT_EQUAL_UINT16(850, governor.getUtilizationPermille());
+
+  TEST_ASSERT_TRUE(governor.update(100, 3));
+  TEST_ASSERT_EQUAL_UINT8(2, governor.getLevel());
+  TEST_ASSERT_FALSE(governor.update(950));
+  TEST_ASSERT_EQUAL_UINT8(2, governor.getLevel());
+
+  // Recovery needs consecutive quiet samples; a sample between thresholds restarts the run.
+  TEST_ASSERT_FALSE(governor.update(400));
+  TEST_ASSERT_FALSE(governor.update(600));
+  TEST_ASSERT_FALSE(governor.update(400));
+  TEST_ASSERT_TRUE(governor.update(400));
+  TEST_ASSERT_EQUAL_UINT8(1, governor.getLevel());
+  TEST_ASSERT_EQUAL_UINT8(2, governor.getPreviousLevel());
+  TEST_ASSERT_FALSE(governor.update(500));
+  TEST_ASSERT_TRUE(governor.update(0));
+  TEST_ASSERT_EQUAL_UINT8(0, governor.getLevel());
+  TEST_ASSERT_FALSE(governor.update(0));
+  TEST_ASSERT_FALSE(governor.update(0));
+  TEST_ASSERT_EQUAL_UINT32(4, governor.getTransitionCount());
+
+  TEST_ASSERT_TRUE(governor.begin(LoadGovernor::Config{800, 500, 2, 2}));
+  TEST_ASSERT_EQUAL_UINT32(0, governor.getTransitionCount());
+}
@@ -5,6 +5,7 @@
 void test_digital_out_begin_rejects_invalid_args();
 void test_digital_out_begin_and_basic_ops();
 void test_digital_out_index_bounds();
+void test_digital_out_port_batched_writes();
 
 void setUp() {
   resetTestState();
@@ -20,15 +21,73 @@ int main(int argc, char** argv) {
   RUN_TEST(test_digital_input_monitor_branches);
   RUN_TEST(test_digital_input_monitor_config_edges);
   RUN_TEST(test_digital_input_monitor_copy_frame);
+  RUN_TEST(test_digital_input_monitor_port_snapshot);
+  RUN_TEST(test_digital_input_monitor_events);
   RUN_TEST(test_encoder_generator_branches);
   RUN_TEST(test_encoder_generator_config_edges);
   RUN_TEST(test_encoder_generator_position_saturates);
+  RUN_TEST(test_encoder_generator_port_snapshot);
+  RUN_TEST(test_encoder_generator_events);
+  RUN_TEST(test_encoder_generator_step_rate);
+  RUN_TEST(test_encoder_generator_move_profile);
+  RUN_TEST(test_encoder_generator_index_pulse);
+  RUN_TEST(test_event_queue_fifo_and_drops);
+  RUN_TEST(test_event_queue_index_wrap);
+  RUN_TEST(test_seqlock_detects_concurrent_write);
+  RUN_TEST(test_seqlock_counter_wrap);
+  RUN_TEST(test_frame_codec_crc_and_cobs);
+  RUN_TEST(test_frame_codec_records);
+  RUN_TEST(test_idle_manager_config_edges);
+  RUN_TEST(test_idle_manager_idle_fraction);
+  RUN_TEST(test_duty_ramp_config_edges);
+  RUN_TEST(test_duty_ramp_slew_and_profile);
+  RUN_TEST(test_waveform_synth_config_edges);
+  RUN_TEST(test_waveform_synth_phase_and_scaling);
+  RUN_TEST(test_soft_pwm_config_edges);
+  RUN_TEST(test_soft_pwm_schedule);
+  RUN_TEST(test_multi_axis_encoder_config_edges);
+  RUN_TEST(test_multi_axis_encoder_steps);
+  RUN_TEST(test_step_rate_conversion);
+  RUN_TEST(test_quadrature_decoder_config_edges);
+  RUN_TEST(test_quadrature_decoder_counts);
+  RUN_TEST(test_output_sequencer_config_edges);
+  RUN_TEST(test_output_sequencer_playback);
+  RUN_TEST(test_output_sequencer_pulses);
+  RUN_TEST(test_frequency_sweep_config_edges);
+  RUN_TEST(test_frequency_sweep_steps);
+  RUN_TEST(test_step_ramp_config_edges);
+  RUN_TEST(test_step_ramp_profile);
+  RUN_TEST(test_timer1_pwm_timing_solver);
+  RUN_TEST(test_timer1_pwm_integer_setup);
+  RUN_TEST(test_timer1_pwm_accuracy_readback);
+  RUN_TEST(test_timer1_pwm_waveform_playback);
+  RUN_TEST(test_timer1_pwm_complementary);
+  RUN_TEST(test_timer1_pwm_square_wave);
+  RUN_TEST(test_timer1_staged_commit_boundary);
+  RUN_TEST(test_timer1_staged_commit_late);
   RUN_TEST(test_firmware_cli_commands);
   RUN_TEST(test_firmware_cli_edge_cases);
   RUN_TEST(test_firmware_cli_internal_edges);
+  RUN_TEST(test_firmware_cli_load_governor);
+  RUN_TEST(test_firmware_cli_tick_events);
+  RUN_TEST(test_firmware_cli_idle_manager);
+  RUN_TEST(test_firmware_cli_duty_ramp);
+  RUN_TEST(test_firmware_cli_waveform);
+  RUN_TEST(test_firmware_cli_complementary);
+  RUN_TEST(test_firmware_cli_square_wave);
+  RUN_TEST(test_firmware_cli_encoder_rate);
+  RUN_TEST(test_firmware_cli_encoder_move);
+  RUN_TEST(test_firmware_cli_pwm_step);
+  RUN_TEST(test_firmware_cli_binary_format);
+  RUN_TEST(test_firmware_cli_streams);
+  RUN_TEST(test_firmware_cli_buffered_output);
+  RUN_TEST(test_firmware_cli_pwm_retune);
+  RUN_TEST(test_load_governor_config_edges);
+  RUN_TEST(test_load_governor_shed_and_restore);
   RUN_TEST(test_digital_out_begin_rejects_invalid_args);
   RUN_TEST(test_digital_out_begin_and_basic_ops);
   RUN_TEST(test_digital_out_index_bounds);
+  RUN_TEST(test_digital_out_port_batched_writes);
 
   return UNITY_END();
 }
\ No newline at end of file
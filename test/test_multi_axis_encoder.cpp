@@ -0,0 +1,86 @@
+#include <unity.h>
+
+#include "multi_axis_encoder.h"
+#include "test_support.h"
+
+void test_multi_axis_encoder_config_edges() {
+  MultiAxisEncoder encoder;
+  TEST_ASSERT_EQUAL_UINT8(0, encoder.getAxisCount());
+  TEST_ASSERT_EQUAL_INT32(0, encoder.getPosition(0));
+  encoder.onTick();
+
+  const MultiAxisEncoder::Axis axes[] = {{9, 10, 2, 3}, {11, 12, 4, 5}};
+  TEST_ASSERT_FALSE(encoder.begin(MultiAxisEncoder::Config(nullptr, 1)));
+  TEST_ASSERT_FALSE(encoder.begin(MultiAxisEncoder::Config(axes, 0)));
+  TEST_ASSERT_FALSE(encoder.begin(MultiAxisEncoder::Config(axes, MultiAxisEncoder::MAX_AXES + 1)));
+
+  const MultiAxisEncoder::Axis sameAB[] = {{9, 9, 2, 3}};
+  TEST_ASSERT_FALSE(encoder.begin(MultiAxisEncoder::Config(sameAB, 1)));
+  const MultiAxisEncoder::Axis sharedOutput[] = {{9, 10, 2, 3}, {12, 9, 4, 5}};
+  TEST_ASSERT_FALSE(encoder.begin(MultiAxisEncoder::Config(sharedOutput, 2)));
+  const MultiAxisEncoder::Axis fivePorts[] = {{0, 8, 2, 3}, {16, 24, 2, 3}, {32, 33, 2, 3}};
+  TEST_ASSERT_FALSE(encoder.begin(MultiAxisEncoder::Config(fivePorts, 3)));
+  const MultiAxisEncoder::Axis noInputPort[] = {{9, 10, 2, 64}};
+  TEST_ASSERT_FALSE(encoder.begin(MultiAxisEncoder::Config(noInputPort, 1)));
+  mockNullOutputPort = 1;
+  TEST_ASSERT_FALSE(encoder.begin(MultiAxisEncoder::Config(axes, 2)));
+  mockNullOutputPort = -1;
+  TEST_ASSERT_EQUAL_UINT8(0, encoder.getAxisCount());
+
+  mockPortOut[1] = 0xFF;
+  TEST_ASSERT_TRUE(encoder.begin(MultiAxisEncoder::Config(axes, 2, true)));
+  TEST_ASSERT_EQUAL_UINT8(2, encoder.getAxisCount());
+  TEST_ASSERT_EQUAL_HEX8(0xE1, mockPortOut[1]);
+  TEST_ASSERT_EQUAL_UINT8(OUTPUT, mockPinModes[12]);
+  TEST_ASSERT_EQUAL_UINT8(INPUT_PULLUP, mockPinModes[5]);
+  TEST_ASSERT_TRUE(encoder.getDirection(1));
+
+  TEST_ASSERT_FALSE(encoder.setStepRateMilliHz(0, 1000));
+  TEST_ASSERT_EQUAL_UINT32(0, encoder.getStepRateMilliHz(0));
+  TEST_ASSERT_TRUE(encoder.begin(MultiAxisEncoder::Config(axes, 2, false, true, 10000)));
+  TEST_ASSERT_FALSE(encoder.setStepRateMilliHz(2, 1000));
+  TEST_ASSERT_FALSE(encoder.setStepRateMilliHz(0, 10000001UL));
+  TEST_ASSERT_EQUAL_UINT32(10000000UL, encoder.getStepRateMilliHz(1));
+}
+
+void test_multi_axis_encoder_steps() {
+  MultiAxisEncoder encoder;
+  // Axes 0 and 1 share port 1 (bits 1..4); axis 2 is on port 2 (bits 1, 2).
+  const MultiAxisEncoder::Axis axes[] = {{9, 10, 2, 3}, {11, 12, 4, 5}, {17, 18, 6, 7}};
+  TEST_ASSERT_TRUE(encoder.begin(MultiAxisEncoder::Config(axes, 3, false, true, 10000)));
+  mockPortOut[1] = 0x81;  // unrelated pins on a shared port are left alone
+
+  setDigitalPin(2, true);
+  setDigitalPin(5, true);
+  encoder.onTick();
+  // Axis 0 up to state 1 (B), axis 1 down to state 3 (A), axis 2 idle.
+  TEST_ASSERT_EQUAL_HEX8(0x81 | (1U << 2) | (1U << 3), mockPortOut[1]);
+  TEST_ASSERT_EQUAL_HEX8(0, mockPortOut[2] & 0x06);
+  encoder.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x81 | (1U << 1) | (1U << 2) | (1U << 3) | (1U << 4), mockPortOut[1]);
+
+  int32_t positions[4] = {0, 0, 0, 0};
+  TEST_ASSERT_EQUAL_UINT8(3, encoder.getPositions(positions, 4));
+  TEST_ASSERT_EQUAL_INT32(2, positions[0]);
+  TEST_ASSERT_EQUAL_INT32(-2, positions[1]);
+  TEST_ASSERT_EQUAL_INT32(0, positions[2]);
+  TEST_ASSERT_TRUE(encoder.getDirection(0));
+  TEST_ASSERT_FALSE(encoder.getDirection(1));
+  TEST_ASSERT_EQUAL_UINT8(0, encoder.getPositions(nullptr, 4));
+
+  // Axis 2 paced at a quarter of the tick rate, axis 0 held at rate 0.
+  TEST_ASSERT_TRUE(encoder.setStepRateMilliHz(2, 2500000UL));
+  TEST_ASSERT_TRUE(encoder.setStepRateMilliHz(0, 0));
+  setDigitalPin(6, true);
+  for (uint8_t i = 0; i < 8; ++i) encoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(2, encoder.getPosition(0));
+  TEST_ASSERT_EQUAL_INT32(-10, encoder.getPosition(1));
+  TEST_ASSERT_EQUAL_INT32(2, encoder.getPosition(2));
+  TEST_ASSERT_EQUAL_HEX8(1U << 2 | 1U << 1, mockPortOut[2] & 0x06);
+  TEST_ASSERT_EQUAL_INT32(0, encoder.getPosition(3));
+
+  encoder.reset();
+  TEST_ASSERT_EQUAL_INT32(0, encoder.getPosition(1));
+  TEST_ASSERT_EQUAL_HEX8(0x81, mockPortOut[1]);
+  TEST_ASSERT_EQUAL_HEX8(0, mockPortOut[2] & 0x06);
+}
@@ -0,0 +1,121 @@
+#include <unity.h>
+
+#include "output_sequencer.h"
+#include "test_support.h"
+
+void test_output_sequencer_config_edges() {
+  OutputSequencer seq;
+  TEST_ASSERT_FALSE(seq.pulse(0, 1));
+
+  const uint8_t repeated[2] = {8, 8};
+  const uint8_t noPort[1] = {70};
+  const uint8_t fivePorts[5] = {0, 8, 16, 24, 32};
+  TEST_ASSERT_FALSE(seq.begin(OutputSequencer::Config(nullptr, 1)));
+  TEST_ASSERT_FALSE(seq.begin(OutputSequencer::Config(repeated, 0)));
+  TEST_ASSERT_FALSE(seq.begin(OutputSequencer::Config(repeated, 2)));
+  TEST_ASSERT_FALSE(seq.begin(OutputSequencer::Config(noPort, 1)));
+  TEST_ASSERT_FALSE(seq.begin(OutputSequencer::Config(fivePorts, 5)));
+  TEST_ASSERT_EQUAL_UINT8(0, seq.getChannelCount());
+
+  const uint8_t pins[2] = {8, 9};
+  mockPortOut[1] = 0xF3;
+  TEST_ASSERT_TRUE(seq.begin(OutputSequencer::Config(pins, 2)));
+  TEST_ASSERT_EQUAL_UINT8(2, seq.getChannelCount());
+  TEST_ASSERT_EQUAL_HEX8(0xF0, mockPortOut[1]);
+  TEST_ASSERT_EQUAL_UINT8(OUTPUT, mockPinModes[9]);
+
+  const OutputSequencer::Event ok[2] = {{0, 0x01, 0x01}, {5, 0x01, 0x00}};
+  const OutputSequencer::Event unordered[2] = {{5, 0x01, 0x01}, {5, 0x01, 0x00}};
+  const OutputSequencer::Event badMask[1] = {{0, 0x04, 0x04}};
+  TEST_ASSERT_FALSE(seq.play(nullptr, 1, 10, false));
+  TEST_ASSERT_FALSE(seq.play(ok, 0, 10, false));
+  TEST_ASSERT_FALSE(seq.play(ok, OutputSequencer::MAX_EVENTS + 1, 10, false));
+  TEST_ASSERT_FALSE(seq.play(ok, 2, 5, false));
+  TEST_ASSERT_FALSE(seq.play(unordered, 2, 10, false));
+  TEST_ASSERT_FALSE(seq.play(badMask, 1, 10, false));
+  TEST_ASSERT_FALSE(seq.isPlaying());
+  TEST_ASSERT_TRUE(seq.play(ok, 2, 6, false));
+  TEST_ASSERT_TRUE(seq.isPlaying());
+
+  TEST_ASSERT_FALSE(seq.pulse(2, 1));
+  TEST_ASSERT_FALSE(seq.pulse(0, 0));
+  TEST_ASSERT_FALSE(seq.isPulsing(2));
+}
+
+void test_output_sequencer_playback() {
+  // Channels 0 and 1 share port 1 (bits 0 and 1), channel 2 is port 2 bit 0.
+  const uint8_t pins[3] = {8, 9, 16};
+  OutputSequencer seq;
+  TEST_ASSERT_TRUE(seq.begin(OutputSequencer::Config(pins, 3)));
+  mockPortOut[1] = 0x80;
+  mockPortOut[2] = 0x40;
+
+  const OutputSequencer::Event events[3] = {
+      {0, 0x07, 0x05}, {2, 0x03, 0x02}, {3, 0x05, 0x00}};
+  TEST_ASSERT_TRUE(seq.play(events, 3, 5, true));
+  const uint8_t port1[10] = {0x81, 0x81, 0x82, 0x82, 0x82, 0x81, 0x81, 0x82, 0x82, 0x82};
+  const uint8_t port2[10] = {0x41, 0x41, 0x41, 0x40, 0x40, 0x41, 0x41, 0x41, 0x40, 0x40};
+  for (uint8_t t = 0; t < 10; ++t) {
+    seq.onTick();
+    TEST_ASSERT_EQUAL_HEX8(port1[t], mockPortOut[1]);
+    TEST_ASSERT_EQUAL_HEX8(port2[t], mockPortOut[2]);
+  }
+  TEST_ASSERT_EQUAL_UINT16(2, seq.getLoopCount());
+  seq.stop();
+  seq.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x82, mockPortOut[1]);
+
+  // A one-shot sequence stops after its length; outputs keep their last levels.
+  const OutputSequencer::Event once[1] = {{1, 0x04, 0x04}};
+  TEST_ASSERT_TRUE(seq.play(once, 1, 3, false));
+  seq.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x40, mockPortOut[2]);
+  seq.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x41, mockPortOut[2]);
+  seq.onTick();
+  TEST_ASSERT_FALSE(seq.isPlaying());
+  TEST_ASSERT_EQUAL_UINT16(0, seq.getLoopCount());
+}
+
+void test_output_sequencer_pulses() {
+  const uint8_t pins[2] = {8, 9};
+  OutputSequencer seq;
+  TEST_ASSERT_TRUE(seq.begin(OutputSequencer::Config(pins, 2)));
+  mockPortOut[1] = 0x02;
+
+  // A 3-tick high pulse on channel 0 and a 1-tick low pulse on channel 1.
+  TEST_ASSERT_TRUE(seq.pulse(0, 3));
+  TEST_ASSERT_TRUE(seq.pulse(1, 1, false));
+  TEST_ASSERT_TRUE(seq.isPulsing(0));
+  const uint8_t levels[5] = {0x01, 0x03, 0x03, 0x02, 0x02};
+  for (uint8_t t = 0; t < 5; ++t) {
+    seq.onTick();
+    TEST_ASSERT_EQUAL_HEX8(levels[t], mockPortOut[1]);
+  }
+  TEST_ASSERT_FALSE(seq.isPulsing(0));
+  TEST_ASSERT_FALSE(seq.isPulsing(1));
+
+  // Restarting a running pulse restarts its width.
+  TEST_ASSERT_TRUE(seq.pulse(0, 2));
+  seq.onTick();
+  seq.onTick();
+  TEST_ASSERT_TRUE(seq.pulse(0, 2));
+  seq.onTick();
+  seq.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x03, mockPortOut[1]);
+  seq.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x02, mockPortOut[1]);
+
+  // A pulse edge wins over a sequence event on the same tick; a later event still moves the
+  // pin mid-pulse, and the pulse ends on time.
+  const OutputSequencer::Event events[2] = {{0, 0x01, 0x00}, {1, 0x01, 0x00}};
+  TEST_ASSERT_TRUE(seq.play(events, 2, 4, false));
+  TEST_ASSERT_TRUE(seq.pulse(0, 2));
+  seq.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x03, mockPortOut[1]);
+  seq.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x02, mockPortOut[1]);
+  seq.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x02, mockPortOut[1]);
+  TEST_ASSERT_FALSE(seq.isPulsing(0));
+}
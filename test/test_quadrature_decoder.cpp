@@ -0,0 +1,119 @@
+#include <unity.h>
+
+#include "quadrature_decoder.h"
+#include "test_support.h"
+
+namespace {
+
+// Drives channel inputs A (pin a) and B (pin b) to an EncoderGenerator waveform state.
+void setQuadrature(uint8_t a, uint8_t b, uint8_t state) {
+  setDigitalPin(a, state == 2 || state == 3);
+  setDigitalPin(b, state == 1 || state == 2);
+}
+
+}  // namespace
+
+void test_quadrature_decoder_config_edges() {
+  QuadratureDecoder decoder;
+  TEST_ASSERT_EQUAL_UINT8(0, decoder.getChannelCount());
+  decoder.onTick();
+  decoder.onPinChange();
+  TEST_ASSERT_EQUAL_INT32(0, decoder.getPosition(0));
+
+  const QuadratureDecoder::Channel channels[] = {{2, 3}, {4, 5}};
+  TEST_ASSERT_FALSE(decoder.begin(QuadratureDecoder::Config(nullptr, 1, 10, 1000)));
+  TEST_ASSERT_FALSE(decoder.begin(QuadratureDecoder::Config(channels, 0, 10, 1000)));
+  TEST_ASSERT_FALSE(
+      decoder.begin(QuadratureDecoder::Config(channels, QuadratureDecoder::MAX_CHANNELS + 1, 10,
+                                              1000)));
+  TEST_ASSERT_FALSE(decoder.begin(QuadratureDecoder::Config(channels, 2, 0, 1000)));
+  TEST_ASSERT_FALSE(decoder.begin(QuadratureDecoder::Config(channels, 2, 10, 0)));
+  const QuadratureDecoder::Channel repeated[] = {{2, 3}, {3, 5}};
+  TEST_ASSERT_FALSE(decoder.begin(QuadratureDecoder::Config(repeated, 2, 10, 1000)));
+  const QuadratureDecoder::Channel noPort[] = {{2, 64}};
+  TEST_ASSERT_FALSE(decoder.begin(QuadratureDecoder::Config(noPort, 1, 10, 1000)));
+  mockNullInputPort = 0;
+  TEST_ASSERT_FALSE(decoder.begin(QuadratureDecoder::Config(channels, 2, 10, 1000)));
+  mockNullInputPort = -1;
+  TEST_ASSERT_EQUAL_UINT8(0, decoder.getChannelCount());
+
+  // The levels present at begin() are the starting state, not a transition.
+  setQuadrature(2, 3, 2);
+  TEST_ASSERT_TRUE(decoder.begin(QuadratureDecoder::Config(channels, 2, 10, 1000, true)));
+  TEST_ASSERT_EQUAL_UINT8(2, decoder.getChannelCount());
+  TEST_ASSERT_EQUAL_UINT8(INPUT_PULLUP, mockPinModes[5]);
+  decoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(0, decoder.getPosition(0));
+  TEST_ASSERT_EQUAL_UINT32(0, decoder.getErrorCount(0));
+  TEST_ASSERT_EQUAL_INT32(0, decoder.getPosition(2));
+  TEST_ASSERT_EQUAL_UINT32(0, decoder.getErrorCount(2));
+}
+
+void test_quadrature_decoder_counts() {
+  QuadratureDecoder decoder;
+  const QuadratureDecoder::Channel channels[] = {{2, 3}, {4, 5}};
+  TEST_ASSERT_TRUE(decoder.begin(QuadratureDecoder::Config(channels, 2, 10, 1000)));
+
+  // Channel 0 forward one full cycle and a step, channel 1 backward two steps.
+  for (uint8_t i = 1; i <= 5; ++i) {
+    setQuadrature(2, 3, static_cast<uint8_t>(i & 3U));
+    if (i <= 2) setQuadrature(4, 5, static_cast<uint8_t>((4U - i) & 3U));
+    decoder.onTick();
+  }
+  TEST_ASSERT_EQUAL_INT32(5, decoder.getPosition(0));
+  TEST_ASSERT_EQUAL_INT32(-2, decoder.getPosition(1));
+
+  // Skipping a state changes both inputs: an error, and the position holds.
+  setQuadrature(2, 3, 3);
+  decoder.onPinChange();
+  TEST_ASSERT_EQUAL_INT32(5, decoder.getPosition(0));
+  TEST_ASSERT_EQUAL_UINT32(1, decoder.getErrorCount(0));
+  setQuadrature(2, 3, 2);
+  decoder.onPinChange();
+  TEST_ASSERT_EQUAL_INT32(4, decoder.getPosition(0));
+
+  // Pin-change samples do not advance the window: the tenth tick latches it.
+  TEST_ASSERT_FALSE(decoder.isWindowReady());
+  PortSnapshot ports;
+  for (uint8_t i = 0; i < 5; ++i) {
+    ports.capture();
+    decoder.onTick(ports);
+  }
+  TEST_ASSERT_TRUE(decoder.isWindowReady());
+  decoder.updateIfReady();
+  TEST_ASSERT_FALSE(decoder.isWindowReady());
+  TEST_ASSERT_EQUAL_INT32(4, decoder.getCountsPerWindow(0));
+  TEST_ASSERT_EQUAL_INT32(-2, decoder.getCountsPerWindow(1));
+  // Ten ticks at 1 kHz: 4 counts per 10 ms is 400 counts per second.
+  TEST_ASSERT_EQUAL_INT32(400, decoder.getCountsPerSecond(0));
+  TEST_ASSERT_EQUAL_INT32(-200, decoder.getCountsPerSecond(1));
+
+  QuadratureDecoder::Frame frame;
+  decoder.copyFrame(frame);
+  TEST_ASSERT_EQUAL_UINT8(2, frame.channelCount);
+  TEST_ASSERT_EQUAL_UINT32(1, frame.frameSequence);
+  TEST_ASSERT_FALSE(frame.stale);
+  TEST_ASSERT_EQUAL_INT32(4, frame.position[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, frame.errorCount[0]);
+  TEST_ASSERT_EQUAL_INT32(-200, frame.countsPerSecond[1]);
+
+  // An undrained window is replaced by the next one; counting continues throughout.
+  setQuadrature(2, 3, 3);
+  for (uint8_t i = 0; i < 20; ++i) decoder.onTick();
+  setQuadrature(2, 3, 0);
+  decoder.onTick();
+  TEST_ASSERT_EQUAL_UINT32(1, decoder.getOverrunCount());
+  decoder.updateIfReady();
+  decoder.copyFrame(frame);
+  TEST_ASSERT_TRUE(frame.stale);
+  TEST_ASSERT_EQUAL_UINT32(1, frame.overrunCount);
+  TEST_ASSERT_EQUAL_INT32(0, frame.countsPerWindow[0]);
+  TEST_ASSERT_EQUAL_INT32(6, decoder.getPosition(0));
+
+  decoder.reset();
+  TEST_ASSERT_EQUAL_INT32(0, decoder.getPosition(0));
+  TEST_ASSERT_EQUAL_UINT32(0, decoder.getErrorCount(0));
+  setQuadrature(2, 3, 1);
+  decoder.onTick();
+  TEST_ASSERT_EQUAL_INT32(1, decoder.getPosition(0));
+}
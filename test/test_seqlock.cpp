@@ -0,0 +1,46 @@
+#include <unity.h>
+
+#include "seqlock.h"
+#include "test_support.h"
+
+void test_seqlock_detects_concurrent_write() {
+  SeqLock lock;
+
+  uint8_t sequence = lock.readBegin();
+  TEST_ASSERT_FALSE(lock.readRetry(sequence));
+
+  // A write that completes between readBegin() and readRetry() invalidates the copy.
+  lock.writeBegin();
+  lock.writeEnd();
+  TEST_ASSERT_TRUE(lock.readRetry(sequence));
+
+  // A read that starts while a write is open must retry even if nothing else moves.
+  lock.writeBegin();
+  sequence = lock.readBegin();
+  TEST_ASSERT_TRUE(lock.readRetry(sequence));
+  lock.writeEnd();
+
+  sequence = lock.readBegin();
+  TEST_ASSERT_FALSE(lock.readRetry(sequence));
+}
+
+void test_seqlock_counter_wrap() {
+  SeqLock lock;
+
+  for (uint16_t i = 0; i < 127; ++i) {
+    lock.writeBegin();
+    lock.writeEnd();
+  }
+  uint8_t sequence = lock.readBegin();
+  TEST_ASSERT_EQUAL_UINT8(254, sequence);
+  TEST_ASSERT_FALSE(lock.readRetry(sequence));
+
+  lock.writeBegin();
+  TEST_ASSERT_TRUE(lock.readRetry(sequence));
+  lock.writeEnd();
+  TEST_ASSERT_TRUE(lock.readRetry(sequence));
+
+  sequence = lock.readBegin();
+  TEST_ASSERT_EQUAL_UINT8(0, sequence);
+  TEST_ASSERT_FALSE(lock.readRetry(sequence));
+}
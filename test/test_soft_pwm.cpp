@@ -0,0 +1,92 @@
+#include <unity.h>
+
+#include "soft_pwm.h"
+#include "test_support.h"
+
+void test_soft_pwm_config_edges() {
+  SoftPwm pwm;
+  TEST_ASSERT_EQUAL_UINT8(0, pwm.getChannelCount());
+  TEST_ASSERT_FALSE(pwm.setLevel(0, 1));
+  pwm.onTick();
+
+  const uint8_t pins[] = {2, 3, 9, 17};
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(nullptr, 1, 4)));
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(pins, 0, 4)));
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(pins, SoftPwm::MAX_CHANNELS + 1, 4)));
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(pins, 4, 1)));
+
+  const uint8_t repeated[] = {2, 3, 2};
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(repeated, 3, 4)));
+  const uint8_t fivePorts[] = {0, 8, 16, 24, 32};
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(fivePorts, 5, 4)));
+  const uint8_t noPort[] = {64};
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(noPort, 1, 4)));
+  mockZeroMaskPin = 3;
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(pins, 4, 4)));
+  mockZeroMaskPin = -1;
+  mockNullOutputPort = 2;
+  TEST_ASSERT_FALSE(pwm.begin(SoftPwm::Config(pins, 4, 4)));
+  mockNullOutputPort = -1;
+  TEST_ASSERT_EQUAL_UINT8(0, pwm.getChannelCount());
+
+  mockPortOut[0] = 0xFF;
+  TEST_ASSERT_TRUE(pwm.begin(SoftPwm::Config(pins, 4, 4)));
+  TEST_ASSERT_EQUAL_UINT8(4, pwm.getChannelCount());
+  TEST_ASSERT_EQUAL_UINT8(4, pwm.getSteps());
+  TEST_ASSERT_EQUAL_HEX8(0xF3, mockPortOut[0]);
+  TEST_ASSERT_EQUAL_UINT8(OUTPUT, mockPinModes[17]);
+  TEST_ASSERT_FALSE(pwm.isUpdatePending());
+
+  TEST_ASSERT_FALSE(pwm.setLevel(4, 1));
+  TEST_ASSERT_EQUAL_UINT8(0, pwm.getLevel(4));
+  TEST_ASSERT_TRUE(pwm.setLevel(0, 200));
+  TEST_ASSERT_EQUAL_UINT8(4, pwm.getLevel(0));
+  TEST_ASSERT_TRUE(pwm.setDutyPermille(1, 2000));
+  TEST_ASSERT_EQUAL_UINT8(4, pwm.getLevel(1));
+  TEST_ASSERT_TRUE(pwm.setDutyPermille(1, 374));
+  TEST_ASSERT_EQUAL_UINT8(1, pwm.getLevel(1));
+}
+
+void test_soft_pwm_schedule() {
+  SoftPwm pwm;
+  const uint8_t pins[] = {2, 3, 9, 17};
+  TEST_ASSERT_TRUE(pwm.begin(SoftPwm::Config(pins, 4, 4)));
+  mockPortOut[0] |= 0x01;  // an unrelated pin on a shared port is left alone
+
+  TEST_ASSERT_TRUE(pwm.setLevel(0, 2));
+  TEST_ASSERT_TRUE(pwm.setLevel(1, 2));
+  TEST_ASSERT_TRUE(pwm.setLevel(2, 4));
+  TEST_ASSERT_TRUE(pwm.setLevel(3, 1));
+  TEST_ASSERT_TRUE(pwm.isUpdatePending());
+
+  // Step 0 drives every non-zero channel HIGH; level 1 ends after one tick, level 2 after two.
+  const uint8_t expectedPort0[] = {0x0D, 0x0D, 0x01, 0x01};
+  const uint8_t expectedPort2[] = {0x02, 0x00, 0x00, 0x00};
+  for (uint8_t period = 0; period < 2; ++period) {
+    for (uint8_t step = 0; step < 4; ++step) {
+      pwm.onTick();
+      TEST_ASSERT_EQUAL_HEX8(expectedPort0[step], mockPortOut[0]);
+      TEST_ASSERT_EQUAL_HEX8(0x02, mockPortOut[1]);
+      TEST_ASSERT_EQUAL_HEX8(expectedPort2[step], mockPortOut[2]);
+    }
+  }
+  TEST_ASSERT_FALSE(pwm.isUpdatePending());
+
+  // A change made mid-period waits for the next boundary.
+  pwm.onTick();
+  TEST_ASSERT_TRUE(pwm.setLevel(0, 0));
+  TEST_ASSERT_TRUE(pwm.setLevel(2, 3));
+  pwm.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x0D, mockPortOut[0]);
+  pwm.onTick();
+  pwm.onTick();
+  TEST_ASSERT_EQUAL_HEX8(0x02, mockPortOut[1]);
+
+  const uint8_t expectedPort0After[] = {0x09, 0x09, 0x01, 0x01};
+  const uint8_t expectedPort1After[] = {0x02, 0x02, 0x02, 0x00};
+  for (uint8_t step = 0; step < 4; ++step) {
+    pwm.onTick();
+    TEST_ASSERT_EQUAL_HEX8(expectedPort0After[step], mockPortOut[0]);
+    TEST_ASSERT_EQUAL_HEX8(expectedPort1After[step], mockPortOut[1]);
+  }
+}
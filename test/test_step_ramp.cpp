@@ -0,0 +1,94 @@
+#include <unity.h>
+
+#include "step_ramp.h"
+#include "test_support.h"
+
+namespace {
+
+constexpr uint32_t kClockHz = 16000000UL;
+constexpr uint32_t kMinPeriod = 400;
+
+}  // namespace
+
+void test_step_ramp_config_edges() {
+  StepRamp ramp;
+  TEST_ASSERT_FALSE(ramp.hasNext());
+
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(0, 100, 1000, 1000), kClockHz, kMinPeriod));
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(10, 0, 1000, 1000), kClockHz, kMinPeriod));
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(10, 2000, 1000, 1000), kClockHz, kMinPeriod));
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(10, 100, 1000, 1000, 0), kClockHz, kMinPeriod));
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(10, 100, 1000, 1000), 0, kMinPeriod));
+  TEST_ASSERT_FALSE(ramp.hasNext());
+
+  // 40 kHz is exactly 400 clocks per step; anything faster is refused.
+  TEST_ASSERT_TRUE(ramp.begin(StepRamp::Config(10, 1000, 40000, 0), kClockHz, kMinPeriod));
+  TEST_ASSERT_EQUAL_UINT16(399, ramp.getCruiseTop());
+  TEST_ASSERT_EQUAL_UINT16(48, ramp.getPulseCounts());
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(10, 1000, 40100, 0), kClockHz, kMinPeriod));
+  // The pulse must leave the output low for part of every period.
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(10, 1000, 40000, 0, 25), kClockHz, kMinPeriod));
+
+  // Without acceleration the whole move runs at the cruise rate.
+  TEST_ASSERT_TRUE(ramp.begin(StepRamp::Config(3, 100, 2000, 0), kClockHz, kMinPeriod));
+  TEST_ASSERT_EQUAL_UINT32(0, ramp.getRampSteps());
+  TEST_ASSERT_EQUAL_UINT8(1, ramp.getClockSelect());
+  TEST_ASSERT_EQUAL_UINT16(7999, ramp.next());
+  TEST_ASSERT_EQUAL_UINT16(7999, ramp.next());
+  TEST_ASSERT_EQUAL_UINT16(7999, ramp.next());
+  TEST_ASSERT_FALSE(ramp.hasNext());
+
+  // 4 steps/s needs 4e6 clocks per step: clk/64 with TOP 62499 for the whole move. Slower
+  // starts would need clk/256, whose buffer load trails the overflow ISR, and are refused.
+  TEST_ASSERT_TRUE(ramp.begin(StepRamp::Config(4, 4, 8, 16), kClockHz, kMinPeriod));
+  TEST_ASSERT_EQUAL_UINT8(3, ramp.getClockSelect());
+  TEST_ASSERT_EQUAL_UINT16(62499, ramp.next());
+  TEST_ASSERT_EQUAL_UINT16(31249, ramp.getCruiseTop());
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(4, 3, 8, 16), kClockHz, kMinPeriod));
+  TEST_ASSERT_FALSE(ramp.begin(StepRamp::Config(4, 1, 3, 0), kClockHz, kMinPeriod));
+}
+
+void test_step_ramp_profile() {
+  StepRamp ramp;
+  // 1 kHz to 4 kHz at 1.5e6 steps/s2: the rate after n steps is sqrt(1e6 + 3e6 n), so 4 kHz
+  // is reached after 5 steps and each of them gets its own table entry.
+  TEST_ASSERT_TRUE(ramp.begin(StepRamp::Config(12, 1000, 4000, 1500000UL), kClockHz, kMinPeriod));
+  TEST_ASSERT_EQUAL_UINT32(5, ramp.getRampSteps());
+  TEST_ASSERT_EQUAL_UINT32(1, ramp.getStride());
+  const uint16_t expected[12] = {15999, 7999, 6046, 5059, 4437, 3999,
+                                 3999,  4437, 5059, 6046, 7999, 15999};
+  for (uint8_t i = 0; i < 12; ++i) {
+    TEST_ASSERT_TRUE(ramp.hasNext());
+    TEST_ASSERT_EQUAL_UINT16(expected[i], ramp.next());
+  }
+  TEST_ASSERT_FALSE(ramp.hasNext());
+  TEST_ASSERT_EQUAL_UINT32(12, ramp.getPlanned());
+
+  // Too short to cruise: five steps peak at the third and come back down.
+  TEST_ASSERT_TRUE(ramp.begin(StepRamp::Config(5, 1000, 4000, 1500000UL), kClockHz, kMinPeriod));
+  const uint16_t triangle[5] = {15999, 7999, 6046, 7999, 15999};
+  for (uint8_t i = 0; i < 5; ++i) TEST_ASSERT_EQUAL_UINT16(triangle[i], ramp.next());
+
+  // 100 Hz to 20 kHz at 10000 steps/s2 takes 20000 steps, so each table entry is held for 313
+  // steps at clk/8. The move is symmetric and lasts close to the ideal 2 * 1.99 s ramps plus
+  // 10000 cruise steps at 20 kHz.
+  TEST_ASSERT_TRUE(ramp.begin(StepRamp::Config(50000, 100, 20000, 10000), kClockHz, kMinPeriod));
+  TEST_ASSERT_EQUAL_UINT32(20000, ramp.getRampSteps());
+  TEST_ASSERT_EQUAL_UINT32(313, ramp.getStride());
+  TEST_ASSERT_EQUAL_UINT8(2, ramp.getClockSelect());
+  TEST_ASSERT_EQUAL_UINT16(99, ramp.getCruiseTop());
+  TEST_ASSERT_EQUAL_UINT16(6, ramp.getPulseCounts());
+  static uint16_t tops[50000];
+  uint64_t counts = 0;
+  for (uint32_t i = 0; i < 50000; ++i) {
+    tops[i] = ramp.next();
+    counts += tops[i] + 1U;
+  }
+  // The first entry is evaluated 156 steps into the ramp, at 1769 steps/s.
+  TEST_ASSERT_EQUAL_UINT16(1130, tops[0]);
+  TEST_ASSERT_EQUAL_UINT16(1130, tops[312]);
+  TEST_ASSERT_TRUE(tops[313] < tops[312]);
+  for (uint32_t i = 0; i < 25000; ++i) TEST_ASSERT_EQUAL_UINT16(tops[i], tops[49999 - i]);
+  for (uint32_t i = 20000; i < 30000; ++i) TEST_ASSERT_EQUAL_UINT16(99, tops[i]);
+  TEST_ASSERT_UINT32_WITHIN(3200000UL, 71680000UL, static_cast<uint32_t>(counts * 8U));
+}
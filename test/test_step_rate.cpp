@@ -0,0 +1,36 @@
+#include <unity.h>
+
+#include "step_rate.h"
+#include "test_support.h"
+
+void test_step_rate_conversion() {
+  uint32_t increment = 0;
+  bool fullRate = true;
+
+  // 1 kHz at a 10 kHz tick is a tenth of a turn per tick, rounded to nearest.
+  TEST_ASSERT_TRUE(stepIncrementForMilliHz(1000000UL, 10000000UL, increment, fullRate));
+  TEST_ASSERT_EQUAL_UINT32(429496730UL, increment);
+  TEST_ASSERT_FALSE(fullRate);
+  TEST_ASSERT_EQUAL_UINT32(1000000UL, stepRateMilliHz(increment, fullRate, 10000000UL));
+
+  // 1 mHz keeps moving even at the fastest representable tick; zero stops.
+  TEST_ASSERT_TRUE(stepIncrementForMilliHz(1, 10000000UL, increment, fullRate));
+  TEST_ASSERT_EQUAL_UINT32(429, increment);
+  TEST_ASSERT_TRUE(stepIncrementForMilliHz(1, 0xFFFFFFFFUL, increment, fullRate));
+  TEST_ASSERT_EQUAL_UINT32(1, increment);
+  TEST_ASSERT_TRUE(stepIncrementForMilliHz(0, 10000000UL, increment, fullRate));
+  TEST_ASSERT_EQUAL_UINT32(0, increment);
+  TEST_ASSERT_EQUAL_UINT32(0, stepRateMilliHz(increment, fullRate, 10000000UL));
+
+  // The tick rate itself steps every tick; faster rates and a missing tick are rejected.
+  TEST_ASSERT_TRUE(stepIncrementForMilliHz(10000000UL, 10000000UL, increment, fullRate));
+  TEST_ASSERT_TRUE(fullRate);
+  TEST_ASSERT_EQUAL_UINT32(10000000UL, stepRateMilliHz(increment, fullRate, 10000000UL));
+  TEST_ASSERT_FALSE(stepIncrementForMilliHz(10000001UL, 10000000UL, increment, fullRate));
+  TEST_ASSERT_FALSE(stepIncrementForMilliHz(1, 0, increment, fullRate));
+
+  TEST_ASSERT_EQUAL_INT32(6, saturatingStep(5, true));
+  TEST_ASSERT_EQUAL_INT32(4, saturatingStep(5, false));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, saturatingStep(INT32_MAX, true));
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, saturatingStep(INT32_MIN, false));
+}
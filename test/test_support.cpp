@@ -1,5 +1,7 @@
 #include "test_support.h"
 
+#include "frame_codec.h"
+
 #include <string>
 
 volatile uint8_t gTimerCallbackCountA = 0;
@@ -47,6 +49,7 @@ void clearPorts() {
 
 void resetTestState() {
   mockMillis = 0;
+  mockMicros = 0;
   for (int i = 0; i < 64; ++i) mockPinModes[i] = 0xFF;
   for (int i = 0; i < 16; ++i) mockAnalogValues[i] = 0;
   mockAnalogReadCount = 0;
@@ -61,10 +64,32 @@ void resetTestState() {
   clearPorts();
   Serial.clearOutput();
   Serial.setInput("");
+  Serial.setTxRoom(MockSerial::kUnlimitedTxRoom);
 }
 
 void runCmd(FirmwareCli& cli, const char* cmd) {
   Serial.clearOutput();
   Serial.setInput(std::string(cmd) + "\n");
   cli.processSerial();
-}
\ No newline at end of file
+}
+bool decodeFrame(const std::string& wire, std::string& record) {
+  record.clear();
+  if (wire.size() < 2 || wire.front() != '\0' || wire.back() != '\0') return false;
+  size_t pos = 1;
+  size_t end = wire.size() - 1;
+  while (pos < end) {
+    uint8_t code = static_cast<uint8_t>(wire[pos++]);
+    if (code == 0 || pos + code - 1 > end) return false;
+    record.append(wire, pos, code - 1U);
+    pos += code - 1U;
+    if (code != 0xFF && pos < end) record.push_back('\0');
+  }
+  if (record.size() < 4) return false;
+  size_t body = record.size() - 2;
+  uint16_t crc = FrameEncoder::crc16(0xFFFF, reinterpret_cast<const uint8_t*>(record.data()),
+                                     static_cast<uint8_t>(body));
+  uint16_t sent = static_cast<uint16_t>(static_cast<uint8_t>(record[body]) |
+                                        (static_cast<uint8_t>(record[body + 1]) << 8));
+  record.resize(body);
+  return crc == sent;
+}
@@ -11,6 +11,8 @@ extern volatile uint8_t gTimerCallbackCountB;
 extern volatile uint8_t gTimerCallbackCountC;
 extern volatile uint8_t gTimerCallbackCountD;
 extern volatile uint8_t gTimerCallbackCountE;
+// OCR1A/OCR1B values the native Timer1PWM double's overflow ISR last played from a waveform.
+extern uint16_t gWaveformCounts[2];
 
 void timerCallbackA();
 void timerCallbackB();
@@ -22,17 +24,77 @@ void setDigitalPin(uint8_t pin, bool high);
 void clearPorts();
 void resetTestState();
 void runCmd(FirmwareCli& cli, const char* cmd);
+// Decodes one zero-delimited COBS frame and checks its CRC; record gets type, sequence and
+// payload bytes.
+bool decodeFrame(const std::string& wire, std::string& record);
 
 void test_analog_sampler_branches();
 void test_analog_sampler_config_edges();
 void test_digital_input_monitor_branches();
 void test_digital_input_monitor_config_edges();
 void test_digital_input_monitor_copy_frame();
+void test_digital_input_monitor_port_snapshot();
+void test_digital_input_monitor_events();
 void test_encoder_generator_branches();
 void test_encoder_generator_config_edges();
 void test_encoder_generator_position_saturates();
+void test_encoder_generator_port_snapshot();
+void test_encoder_generator_events();
+void test_encoder_generator_step_rate();
+void test_encoder_generator_move_profile();
+void test_encoder_generator_index_pulse();
+void test_event_queue_fifo_and_drops();
+void test_event_queue_index_wrap();
+void test_seqlock_detects_concurrent_write();
+void test_seqlock_counter_wrap();
+void test_frame_codec_crc_and_cobs();
+void test_frame_codec_records();
+void test_idle_manager_config_edges();
+void test_idle_manager_idle_fraction();
+void test_duty_ramp_config_edges();
+void test_duty_ramp_slew_and_profile();
+void test_waveform_synth_config_edges();
+void test_waveform_synth_phase_and_scaling();
+void test_soft_pwm_config_edges();
+void test_soft_pwm_schedule();
+void test_multi_axis_encoder_config_edges();
+void test_multi_axis_encoder_steps();
+void test_step_rate_conversion();
+void test_quadrature_decoder_config_edges();
+void test_quadrature_decoder_counts();
+void test_output_sequencer_config_edges();
+void test_output_sequencer_playback();
+void test_output_sequencer_pulses();
+void test_frequency_sweep_config_edges();
+void test_frequency_sweep_steps();
+void test_step_ramp_config_edges();
+void test_step_ramp_profile();
+void test_timer1_pwm_timing_solver();
+void test_timer1_pwm_integer_setup();
+void test_timer1_pwm_accuracy_readback();
+void test_timer1_pwm_waveform_playback();
+void test_timer1_pwm_complementary();
+void test_timer1_pwm_square_wave();
+void test_timer1_staged_commit_boundary();
+void test_timer1_staged_commit_late();
 void test_firmware_cli_commands();
 void test_firmware_cli_edge_cases();
 void test_firmware_cli_internal_edges();
+void test_firmware_cli_load_governor();
+void test_firmware_cli_tick_events();
+void test_firmware_cli_idle_manager();
+void test_firmware_cli_duty_ramp();
+void test_firmware_cli_waveform();
+void test_firmware_cli_complementary();
+void test_firmware_cli_square_wave();
+void test_firmware_cli_encoder_rate();
+void test_firmware_cli_encoder_move();
+void test_firmware_cli_pwm_step();
+void test_firmware_cli_binary_format();
+void test_firmware_cli_streams();
+void test_firmware_cli_buffered_output();
+void test_firmware_cli_pwm_retune();
+void test_load_governor_config_edges();
+void test_load_governor_shed_and_restore();
 
 #endif
\ No newline at end of file
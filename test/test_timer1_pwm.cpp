@@ -0,0 +1,242 @@
+#include <unity.h>
+
+#include "avr_timer1_pwm.h"
+#include "test_support.h"
+
+namespace {
+
+// 100 Hz at 16 MHz: prescaler 1 would need TOP 159999, so prescaler 8 with TOP 19999 is used.
+constexpr Timer1PWM::Timing kTiming100Hz = Timer1PWM::timingForMilliHz(100000UL);
+static_assert(kTiming100Hz.isValid(), "100 Hz must resolve at compile time");
+static_assert(kTiming100Hz.top == 19999 && kTiming100Hz.clockSelect == 2,
+              "100 Hz resolves to TOP 19999 at clk/8");
+static_assert(kTiming100Hz.frequencyMilliHz() == 100000UL, "100 Hz is exact at clk/8");
+
+// 20 kHz complementary: the counter runs 400 counts up and 400 down at clk/1.
+constexpr Timer1PWM::Timing kComplementary20kHz =
+    Timer1PWM::complementaryTimingForMilliHz(20000000UL);
+static_assert(kComplementary20kHz.top == 400 && kComplementary20kHz.clockSelect == 1,
+              "20 kHz complementary resolves to TOP 400 at clk/1");
+static_assert(Timer1PWM::complementaryFrequencyMilliHz(kComplementary20kHz) == 20000000UL,
+              "20 kHz complementary is exact");
+
+// 1 kHz square wave: 8000 counts per half-period at clk/1.
+constexpr Timer1PWM::Timing kSquare1kHz = Timer1PWM::squareWaveTimingForMilliHz(1000000UL);
+static_assert(kSquare1kHz.top == 7999 && kSquare1kHz.clockSelect == 1,
+              "1 kHz square wave resolves to TOP 7999 at clk/1");
+static_assert(Timer1PWM::squareWaveFrequencyMilliHz(kSquare1kHz) == 1000000UL,
+              "1 kHz square wave is exact");
+
+}  // namespace
+
+void test_timer1_pwm_timing_solver() {
+  Timer1PWM::Timing timing = Timer1PWM::timingForMilliHz(1000000UL);
+  TEST_ASSERT_TRUE(timing.isValid());
+  TEST_ASSERT_EQUAL_UINT16(15999, timing.top);
+  TEST_ASSERT_EQUAL_UINT8(1, timing.clockSelect);
+
+  // 1 Hz first fits at clk/256: 16e6 / 256 = 62500 counts per period.
+  timing = Timer1PWM::timingForMilliHz(1000UL);
+  TEST_ASSERT_EQUAL_UINT16(62499, timing.top);
+  TEST_ASSERT_EQUAL_UINT8(4, timing.clockSelect);
+
+  // Millihertz resolution: 0.5 Hz needs clk/1024, and 1.5 Hz rounds 41666.67 counts up.
+  timing = Timer1PWM::timingForMilliHz(500UL);
+  TEST_ASSERT_EQUAL_UINT16(31249, timing.top);
+  TEST_ASSERT_EQUAL_UINT8(5, timing.clockSelect);
+  timing = Timer1PWM::timingForMilliHz(1500UL);
+  TEST_ASSERT_EQUAL_UINT16(41666, timing.top);
+
+  // 4 MHz (TOP 3) is near the top of the millihertz range; below 0.239 Hz nothing fits.
+  timing = Timer1PWM::timingForMilliHz(4000000000UL);
+  TEST_ASSERT_EQUAL_UINT16(3, timing.top);
+  TEST_ASSERT_EQUAL_UINT8(1, timing.clockSelect);
+  TEST_ASSERT_TRUE(Timer1PWM::timingForMilliHz(239UL).isValid());
+  TEST_ASSERT_FALSE(Timer1PWM::timingForMilliHz(0).isValid());
+  TEST_ASSERT_FALSE(Timer1PWM::timingForMilliHz(200UL).isValid());
+  TEST_ASSERT_FALSE(Timer1PWM::Timing().isValid());
+
+  TEST_ASSERT_EQUAL_UINT16(1, Timer1PWM::prescalerAt(0));
+  TEST_ASSERT_EQUAL_UINT16(1024, Timer1PWM::prescalerAt(Timer1PWM::PRESCALER_COUNT - 1));
+}
+
+void test_timer1_pwm_integer_setup() {
+  TEST_ASSERT_EQUAL_UINT32(65535UL * 65536UL / 1000UL, Timer1PWM::countsPerPermilleQ16(65535));
+  TEST_ASSERT_EQUAL_UINT32(0, Timer1PWM::countsPerPermilleQ16(0));
+
+  Timer1PWM pwm;
+  TEST_ASSERT_EQUAL_UINT16(0, pwm.getTop());
+  TEST_ASSERT_FALSE(pwm.begin(Timer1PWM::Timing()));
+  TEST_ASSERT_FALSE(pwm.beginMilliHz(0));
+  TEST_ASSERT_TRUE(pwm.begin(kTiming100Hz));
+  TEST_ASSERT_EQUAL_UINT16(19999, pwm.getTop());
+  TEST_ASSERT_TRUE(pwm.beginMilliHz(1000000UL));
+  TEST_ASSERT_EQUAL_UINT16(15999, pwm.getTop());
+  pwm.stop();
+  TEST_ASSERT_EQUAL_UINT16(0, pwm.getTop());
+}
+
+void test_timer1_pwm_accuracy_readback() {
+  // 28854.832 Hz needs 554.4998 clocks per period. Rounding the period gives 554 (+26034 mHz),
+  // but 555 lands closer in frequency (-26003 mHz), so the solver picks TOP 554.
+  Timer1PWM::Timing timing = Timer1PWM::timingForMilliHz(28854832UL);
+  TEST_ASSERT_EQUAL_UINT16(554, timing.top);
+  TEST_ASSERT_EQUAL_UINT8(1, timing.clockSelect);
+  TEST_ASSERT_EQUAL_UINT32(555, timing.periodClocks());
+  TEST_ASSERT_EQUAL_UINT32(28828829UL, timing.frequencyMilliHz());
+  TEST_ASSERT_EQUAL_UINT8(9, timing.resolutionBits());
+
+  timing = Timer1PWM::timingForMilliHz(1500UL, Timer1PWM::PREFER_RESOLUTION);
+  TEST_ASSERT_EQUAL_UINT16(41666, timing.top);
+  TEST_ASSERT_EQUAL_UINT8(4, timing.clockSelect);
+  TEST_ASSERT_EQUAL_UINT32(1500UL, timing.frequencyMilliHz());
+  TEST_ASSERT_EQUAL_UINT8(15, timing.resolutionBits());
+  TEST_ASSERT_FALSE(Timer1PWM::timingForMilliHz(200UL, Timer1PWM::PREFER_RESOLUTION).isValid());
+
+  TEST_ASSERT_EQUAL_UINT32(0, Timer1PWM::Timing().frequencyMilliHz());
+  TEST_ASSERT_EQUAL_UINT32(0, Timer1PWM::Timing(100, 6).periodClocks());
+  TEST_ASSERT_EQUAL_UINT8(16, Timer1PWM::Timing(65535, 1).resolutionBits());
+
+  Timer1PWM pwm;
+  TEST_ASSERT_FALSE(pwm.getTiming().isValid());
+  TEST_ASSERT_TRUE(pwm.beginMilliHz(100000UL, Timer1PWM::PREFER_RESOLUTION));
+  TEST_ASSERT_EQUAL_UINT32(100000UL, pwm.getTiming().frequencyMilliHz());
+  TEST_ASSERT_EQUAL_UINT8(14, pwm.getTiming().resolutionBits());
+}
+
+void test_timer1_pwm_waveform_playback() {
+  Timer1PWM pwm;
+  WaveformSynth::Config sine(WaveformSynth::sineTable(), WaveformSynth::SINE_TABLE_BITS, 50000,
+                             800, WaveformSynth::PHASE_QUARTER_TURN);
+  TEST_ASSERT_FALSE(pwm.startWaveform(sine));
+
+  // 62.5 kHz is a 256-clock period, too short for one synthesized sample per period.
+  TEST_ASSERT_TRUE(pwm.begin(Timer1PWM::Timing(255, 1)));
+  TEST_ASSERT_FALSE(pwm.startWaveform(sine));
+
+  TEST_ASSERT_TRUE(pwm.begin(Timer1PWM::Timing(511, 1)));
+  TEST_ASSERT_TRUE(pwm.startWaveform(sine));
+  TEST_ASSERT_TRUE(pwm.isWaveformActive());
+  TEST_ASSERT_EQUAL_UINT32(50000UL, pwm.getWaveformFrequencyMilliHz());
+  TEST_ASSERT_FALSE(pwm.stageTiming(Timer1PWM::Timing(1023, 1)));
+  TEST_ASSERT_FALSE(pwm.writeDutyPermilleFromIsr(0, 500));
+
+  sine.frequencyMilliHz = 15625000UL;
+  TEST_ASSERT_FALSE(pwm.startWaveform(sine));
+  TEST_ASSERT_FALSE(pwm.isWaveformActive());
+  TEST_ASSERT_EQUAL_UINT32(0, pwm.getWaveformFrequencyMilliHz());
+
+  sine.frequencyMilliHz = 50000;
+  TEST_ASSERT_TRUE(pwm.startWaveform(sine));
+  pwm.stopWaveform();
+  TEST_ASSERT_FALSE(pwm.isWaveformActive());
+  TEST_ASSERT_TRUE(pwm.stageTiming(Timer1PWM::Timing(1023, 1)));
+}
+
+void test_timer1_pwm_complementary() {
+  Timer1PWM::Timing oneHz = Timer1PWM::complementaryTimingForMilliHz(1000UL);
+  TEST_ASSERT_EQUAL_UINT16(31250, oneHz.top);
+  TEST_ASSERT_EQUAL_UINT8(4, oneHz.clockSelect);
+  TEST_ASSERT_EQUAL_UINT32(1000UL, Timer1PWM::complementaryFrequencyMilliHz(oneHz));
+  TEST_ASSERT_FALSE(Timer1PWM::complementaryTimingForMilliHz(0).isValid());
+  TEST_ASSERT_FALSE(Timer1PWM::complementaryTimingForMilliHz(0x80000000UL).isValid());
+  TEST_ASSERT_EQUAL_UINT32(0, Timer1PWM::complementaryFrequencyMilliHz(Timer1PWM::Timing()));
+
+  Timer1PWM pwm;
+  TEST_ASSERT_FALSE(pwm.beginComplementary(Timer1PWM::Timing(), 0));
+  TEST_ASSERT_FALSE(pwm.beginComplementary(kComplementary20kHz, 400));
+  TEST_ASSERT_FALSE(pwm.isComplementary());
+
+  TEST_ASSERT_TRUE(pwm.beginComplementary(kComplementary20kHz, 16));
+  TEST_ASSERT_TRUE(pwm.isComplementary());
+  TEST_ASSERT_EQUAL_UINT16(16, pwm.getDeadTimeCounts());
+  TEST_ASSERT_EQUAL_UINT16(400, pwm.getTop());
+  TEST_ASSERT_TRUE(pwm.writeDutyPermilleFromIsr(0, 500));
+  TEST_ASSERT_FALSE(pwm.writeDutyPermilleFromIsr(1, 500));
+  TEST_ASSERT_FALSE(pwm.stageTiming(Timer1PWM::complementaryTimingForMilliHz(10000000UL)));
+  WaveformSynth::Config sine(WaveformSynth::sineTable(), WaveformSynth::SINE_TABLE_BITS, 50000,
+                             1000, WaveformSynth::PHASE_QUARTER_TURN);
+  TEST_ASSERT_FALSE(pwm.startWaveform(sine));
+
+  // A TOP between the two stores loads one old and one new value. Rising duties store OCR1B
+  // first and falling ones OCR1A first, so that mixed pair still keeps the dead time.
+  const uint16_t duties[] = {0, 100, 300, 390, 384, 200, 10, 0};
+  Timer1PWM::ComplementaryCompare live = Timer1PWM::complementaryCompare(0, 400, 16, 0);
+  for (uint8_t i = 1; i < sizeof(duties) / sizeof(duties[0]); ++i) {
+    Timer1PWM::ComplementaryCompare next =
+        Timer1PWM::complementaryCompare(duties[i], 400, 16, live.highSide);
+    TEST_ASSERT_EQUAL_UINT16(next.highSide + 16U, next.lowSide);
+    TEST_ASSERT_TRUE(next.lowSide <= 400);
+    TEST_ASSERT_EQUAL(next.highSide > live.highSide, next.lowSideFirst);
+    uint16_t mixedHigh = next.lowSideFirst ? live.highSide : next.highSide;
+    uint16_t mixedLow = next.lowSideFirst ? next.lowSide : live.lowSide;
+    TEST_ASSERT_TRUE(mixedLow >= mixedHigh + 16U);
+    live = next;
+  }
+  TEST_ASSERT_EQUAL_UINT16(384, Timer1PWM::complementaryCompare(390, 400, 16, 0).highSide);
+
+  // Restarting in independent mode drops the pairing.
+  TEST_ASSERT_TRUE(pwm.begin(Timer1PWM::Timing(511, 1)));
+  TEST_ASSERT_FALSE(pwm.isComplementary());
+  TEST_ASSERT_EQUAL_UINT16(0, pwm.getDeadTimeCounts());
+
+  TEST_ASSERT_TRUE(pwm.beginComplementary(kComplementary20kHz, 0));
+  pwm.stop();
+  TEST_ASSERT_FALSE(pwm.isComplementary());
+  TEST_ASSERT_EQUAL_UINT16(0, pwm.getTop());
+}
+
+void test_timer1_pwm_square_wave() {
+  // 3 kHz needs 2666.67 counts per half-period; 2667 gives 2999.625 Hz, which is reported.
+  Timer1PWM::Timing timing = Timer1PWM::squareWaveTimingForMilliHz(3000000UL);
+  TEST_ASSERT_EQUAL_UINT16(2666, timing.top);
+  TEST_ASSERT_EQUAL_UINT32(2999625UL, Timer1PWM::squareWaveFrequencyMilliHz(timing));
+  timing = Timer1PWM::squareWaveTimingForMilliHz(500UL);
+  TEST_ASSERT_EQUAL_UINT16(62499, timing.top);
+  TEST_ASSERT_EQUAL_UINT8(4, timing.clockSelect);
+  TEST_ASSERT_EQUAL_UINT32(500UL, Timer1PWM::squareWaveFrequencyMilliHz(timing));
+  TEST_ASSERT_FALSE(Timer1PWM::squareWaveTimingForMilliHz(0).isValid());
+  TEST_ASSERT_FALSE(Timer1PWM::squareWaveTimingForMilliHz(0x80000000UL).isValid());
+  TEST_ASSERT_EQUAL_UINT32(0, Timer1PWM::squareWaveFrequencyMilliHz(Timer1PWM::Timing()));
+
+  Timer1PWM pwm;
+  TEST_ASSERT_FALSE(pwm.beginSquareWave(Timer1PWM::Timing()));
+  TEST_ASSERT_FALSE(pwm.isSquareWave());
+  TEST_ASSERT_EQUAL_UINT32(0, pwm.getSquareWaveFrequencyMilliHz());
+
+  TEST_ASSERT_TRUE(pwm.beginSquareWave(kSquare1kHz));
+  TEST_ASSERT_TRUE(pwm.isSquareWave());
+  TEST_ASSERT_FALSE(pwm.isSweepActive());
+  TEST_ASSERT_EQUAL_UINT32(1000000UL, pwm.getSquareWaveFrequencyMilliHz());
+  // PWM-only paths are refused while Timer1 toggles OC1A.
+  TEST_ASSERT_FALSE(pwm.writeDutyPermilleFromIsr(0, 500));
+  TEST_ASSERT_FALSE(pwm.stageTiming(kTiming100Hz));
+  WaveformSynth::Config sine(WaveformSynth::sineTable(), WaveformSynth::SINE_TABLE_BITS, 50000,
+                             1000, WaveformSynth::PHASE_QUARTER_TURN);
+  TEST_ASSERT_FALSE(pwm.startWaveform(sine));
+
+  // A sweep starts at its first step; one that reaches past 15.625 kHz is refused.
+  FrequencySweep::Config sweep(1000000UL, 2000000UL, 4, 100, FrequencySweep::LINEAR, false);
+  TEST_ASSERT_TRUE(pwm.startSweep(sweep));
+  TEST_ASSERT_TRUE(pwm.isSweepActive());
+  TEST_ASSERT_EQUAL_UINT16(7999, pwm.getTop());
+  TEST_ASSERT_EQUAL_UINT32(1000000UL, pwm.getSquareWaveFrequencyMilliHz());
+  pwm.stopSweep();
+  TEST_ASSERT_FALSE(pwm.isSweepActive());
+  TEST_ASSERT_TRUE(pwm.isSquareWave());
+  sweep.stopMilliHz = 20000000UL;
+  TEST_ASSERT_FALSE(pwm.startSweep(sweep));
+
+  TEST_ASSERT_TRUE(pwm.startSweep(FrequencySweep::Config(1000000UL, 2000000UL, 4, 100,
+                                                         FrequencySweep::LOGARITHMIC, true)));
+  TEST_ASSERT_TRUE(pwm.begin(kTiming100Hz));
+  TEST_ASSERT_FALSE(pwm.isSquareWave());
+  TEST_ASSERT_FALSE(pwm.isSweepActive());
+  TEST_ASSERT_EQUAL_UINT32(0, pwm.getSquareWaveFrequencyMilliHz());
+  TEST_ASSERT_TRUE(pwm.writeDutyPermilleFromIsr(0, 500));
+
+  TEST_ASSERT_TRUE(pwm.beginSquareWave(kSquare1kHz));
+  pwm.stop();
+  TEST_ASSERT_FALSE(pwm.isSquareWave());
+  TEST_ASSERT_EQUAL_UINT16(0, pwm.getTop());
+}
@@ -0,0 +1,147 @@
+#include <unity.h>
+
+#include "test_support.h"
+#include "timer1_staged_commit.h"
+
+namespace {
+
+// Timer1 in fast PWM mode 14 at the level stepStagedCommit() sees it: the counter runs 0..TOP,
+// TOV1 is raised at TOP, OCR1A/B load from their buffers one clock later at BOTTOM, and ICR1
+// applies at once. Each counter read takes one timer clock, as it does with a slow prescaler.
+class Timer1Model {
+ public:
+  struct Period {
+    uint16_t top;
+    uint16_t countsA;
+    uint16_t countsB;
+  };
+  static constexpr uint8_t MAX_PERIODS = 16;
+
+  Timer1Model(uint16_t top, uint16_t countsA, uint16_t countsB) : _top(top) {
+    _buffer[0] = _active[0] = countsA;
+    _buffer[1] = _active[1] = countsB;
+  }
+
+  uint16_t counter() {
+    uint16_t value = _count;
+    tick();
+    return value;
+  }
+  bool topPassed() const { return _topPassed; }
+  void clearTopPassed() { _topPassed = false; }
+  uint16_t compare(uint8_t channel) const { return _buffer[channel]; }
+  void setCompare(uint16_t countsA, uint16_t countsB) {
+    _buffer[0] = countsA;
+    _buffer[1] = countsB;
+  }
+  void setTop(uint16_t top) { _top = top; }
+
+  // Runs to the next TOP and enters the overflow ISR, which clears TOV1.
+  void runToOverflow() {
+    do {
+      tick();
+    } while (!_topPassed);
+    _topPassed = false;
+  }
+  void run(uint16_t clocks) {
+    for (uint16_t i = 0; i < clocks; ++i) tick();
+  }
+
+  uint8_t periodCount() const { return _periodCount; }
+  const Period& period(uint8_t index) const { return _periods[index]; }
+
+ private:
+  void tick() {
+    if (_count == _top || _count == 0xFFFFU) {
+      if (_periodCount < MAX_PERIODS) {
+        _periods[_periodCount++] = Period{_count, _active[0], _active[1]};
+      }
+      _count = 0;
+      _active[0] = _buffer[0];
+      _active[1] = _buffer[1];
+      return;
+    }
+    ++_count;
+    if (_count == _top) _topPassed = true;
+  }
+
+  uint16_t _top;
+  uint16_t _count = 0;
+  bool _topPassed = false;
+  uint16_t _buffer[2] = {0, 0};
+  uint16_t _active[2] = {0, 0};
+  Period _periods[MAX_PERIODS] = {};
+  uint8_t _periodCount = 0;
+};
+
+constexpr uint16_t kOldTop = 999;
+constexpr uint16_t kNewTop = 399;
+const uint16_t kNewCounts[2] = {200, 100};
+
+bool isOldPeriod(const Timer1Model::Period& period) {
+  return period.top == kOldTop && period.countsA == 500 && period.countsB == 250;
+}
+
+bool isNewPeriod(const Timer1Model::Period& period) {
+  return period.top == kNewTop && period.countsA == kNewCounts[0] &&
+         period.countsB == kNewCounts[1];
+}
+
+// Runs one overflow ISR pass after @p latency clocks and returns the next phase.
+uint8_t overflow(Timer1Model& timer, uint8_t phase, uint16_t activeTop, uint16_t latency,
+                 uint16_t* restore) {
+  timer.runToOverflow();
+  timer.run(latency);
+  return stepStagedCommit(timer, phase, activeTop, kNewTop, kNewCounts, restore);
+}
+
+}  // namespace
+
+void test_timer1_staged_commit_boundary() {
+  // The ISR reaches TOP before BOTTOM. Phase 1 must wait, or the new duties would load at that
+  // BOTTOM and play a whole period on the old TOP.
+  Timer1Model timer(kOldTop, 500, 250);
+  uint16_t restore[2] = {0, 0};
+  TEST_ASSERT_EQUAL_UINT8(2, overflow(timer, 1, kOldTop, 0, restore));
+  TEST_ASSERT_EQUAL_UINT16(500, restore[0]);
+  TEST_ASSERT_EQUAL_UINT16(250, restore[1]);
+  TEST_ASSERT_EQUAL_UINT8(0, overflow(timer, 2, kOldTop, 0, restore));
+  for (uint8_t i = 0; i < 3; ++i) timer.runToOverflow();
+
+  // Every finished period played either the old pair or the new pair, never a mix.
+  TEST_ASSERT_EQUAL_UINT8(4, timer.periodCount());
+  TEST_ASSERT_TRUE(isOldPeriod(timer.period(0)));
+  TEST_ASSERT_TRUE(isOldPeriod(timer.period(1)));
+  TEST_ASSERT_TRUE(isNewPeriod(timer.period(2)));
+  TEST_ASSERT_TRUE(isNewPeriod(timer.period(3)));
+}
+
+void test_timer1_staged_commit_late() {
+  // Phase 2 held off past the new TOP: ICR1 is left alone, the old duties go back into the
+  // buffers, and the update restarts. Only the late period plays new duties on the old TOP.
+  Timer1Model timer(kOldTop, 500, 250);
+  uint16_t restore[2] = {0, 0};
+  TEST_ASSERT_EQUAL_UINT8(2, overflow(timer, 1, kOldTop, 0, restore));
+  TEST_ASSERT_EQUAL_UINT8(1, overflow(timer, 2, kOldTop, kNewTop + 50U, restore));
+  TEST_ASSERT_EQUAL_UINT8(2, overflow(timer, 1, kOldTop, 0, restore));
+  TEST_ASSERT_EQUAL_UINT16(500, restore[0]);
+  TEST_ASSERT_EQUAL_UINT8(0, overflow(timer, 2, kOldTop, 0, restore));
+  for (uint8_t i = 0; i < 3; ++i) timer.runToOverflow();
+
+  TEST_ASSERT_EQUAL_UINT8(6, timer.periodCount());
+  TEST_ASSERT_TRUE(isOldPeriod(timer.period(0)));
+  TEST_ASSERT_TRUE(isOldPeriod(timer.period(1)));
+  TEST_ASSERT_EQUAL_UINT16(kOldTop, timer.period(2).top);
+  TEST_ASSERT_EQUAL_UINT16(kNewCounts[0], timer.period(2).countsA);
+  TEST_ASSERT_TRUE(isOldPeriod(timer.period(3)));
+  TEST_ASSERT_TRUE(isNewPeriod(timer.period(4)));
+  TEST_ASSERT_TRUE(isNewPeriod(timer.period(5)));
+
+  // Held off for more than a whole period: another TOP has passed, so it is late as well.
+  Timer1Model slow(kOldTop, 500, 250);
+  TEST_ASSERT_EQUAL_UINT8(2, overflow(slow, 1, kOldTop, 0, restore));
+  TEST_ASSERT_EQUAL_UINT8(1, overflow(slow, 2, kOldTop, kOldTop + 10U, restore));
+  TEST_ASSERT_EQUAL_UINT16(500, slow.compare(0));
+  TEST_ASSERT_EQUAL_UINT16(250, slow.compare(1));
+  TEST_ASSERT_FALSE(slow.topPassed());
+}
@@ -0,0 +1,71 @@
+#include <unity.h>
+
+#include "waveform_synth.h"
+#include "test_support.h"
+
+namespace {
+
+const uint8_t kStepTable[4] PROGMEM = {0, 255, 128, 64};
+
+}  // namespace
+
+void test_waveform_synth_config_edges() {
+  WaveformSynth synth;
+  TEST_ASSERT_EQUAL_UINT32(0, synth.getPhaseIncrement());
+  TEST_ASSERT_EQUAL_UINT32(0, synth.getFrequencyMilliHz());
+
+  const uint8_t* sine = WaveformSynth::sineTable();
+  TEST_ASSERT_FALSE(synth.begin(WaveformSynth::Config(nullptr, 8, 1000, 1000, 0), 511, 4000));
+  TEST_ASSERT_FALSE(synth.begin(WaveformSynth::Config(sine, 0, 1000, 1000, 0), 511, 4000));
+  TEST_ASSERT_FALSE(synth.begin(WaveformSynth::Config(sine, 17, 1000, 1000, 0), 511, 4000));
+  TEST_ASSERT_FALSE(synth.begin(WaveformSynth::Config(sine, 8, 1000, 1001, 0), 511, 4000));
+  TEST_ASSERT_FALSE(synth.begin(WaveformSynth::Config(sine, 8, 1000, 1000, 0), 0, 4000));
+  TEST_ASSERT_FALSE(synth.begin(WaveformSynth::Config(sine, 8, 1000, 1000, 0), 511, 0));
+  TEST_ASSERT_FALSE(synth.begin(WaveformSynth::Config(sine, 8, 0, 1000, 0), 511, 4000));
+  TEST_ASSERT_FALSE(synth.begin(WaveformSynth::Config(sine, 8, 2000, 1000, 0), 511, 4000));
+  TEST_ASSERT_TRUE(synth.begin(WaveformSynth::Config(sine, 8, 1999, 1000, 0), 511, 4000));
+
+  // The built-in table covers one full period around mid-scale.
+  TEST_ASSERT_EQUAL_UINT8(128, pgm_read_byte(sine));
+  TEST_ASSERT_EQUAL_UINT8(255, pgm_read_byte(sine + 64));
+  TEST_ASSERT_EQUAL_UINT8(128, pgm_read_byte(sine + 128));
+  TEST_ASSERT_EQUAL_UINT8(0, pgm_read_byte(sine + 192));
+}
+
+void test_waveform_synth_phase_and_scaling() {
+  WaveformSynth synth;
+  // 50 Hz from a 31.25 kHz update rate (TOP 511 at clk/1).
+  WaveformSynth::Config sine(WaveformSynth::sineTable(), WaveformSynth::SINE_TABLE_BITS, 50000,
+                             1000, WaveformSynth::PHASE_QUARTER_TURN);
+  TEST_ASSERT_TRUE(synth.begin(sine, 511, 31250000UL));
+  TEST_ASSERT_EQUAL_UINT32(6871948UL, synth.getPhaseIncrement());
+  TEST_ASSERT_EQUAL_UINT32(50000UL, synth.getFrequencyMilliHz());
+
+  // A quarter-turn increment walks a four-entry table one entry per step.
+  WaveformSynth::Config steps(kStepTable, 2, 1000, 1000, WaveformSynth::PHASE_QUARTER_TURN);
+  TEST_ASSERT_TRUE(synth.begin(steps, 1000, 4000));
+  TEST_ASSERT_EQUAL_UINT32(0x40000000UL, synth.getPhaseIncrement());
+  const uint16_t expectedA[] = {1000, 502, 251, 0, 1000};
+  const uint16_t expectedB[] = {502, 251, 0, 1000, 502};
+  for (uint8_t i = 0; i < 5; ++i) {
+    uint16_t countsA = 0;
+    uint16_t countsB = 0;
+    synth.step(countsA, countsB);
+    TEST_ASSERT_EQUAL_UINT16(expectedA[i], countsA);
+    TEST_ASSERT_EQUAL_UINT16(expectedB[i], countsB);
+  }
+
+  // Half amplitude keeps the swing centred on TOP / 2.
+  steps.amplitudePermille = 500;
+  steps.phaseOffsetB = 0;
+  TEST_ASSERT_TRUE(synth.begin(steps, 1000, 4000));
+  uint16_t countsA = 0;
+  uint16_t countsB = 0;
+  synth.step(countsA, countsB);
+  TEST_ASSERT_EQUAL_UINT16(750, countsA);
+  TEST_ASSERT_EQUAL_UINT16(750, countsB);
+  synth.step(countsA, countsB);
+  synth.step(countsA, countsB);
+  synth.step(countsA, countsB);
+  TEST_ASSERT_EQUAL_UINT16(250, countsA);
+}
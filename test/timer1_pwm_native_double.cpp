@@ -1,5 +1,8 @@
 #include "avr_timer1_pwm.h"
 
+Timer1PWM* volatile Timer1PWM::_activeInstance = nullptr;
+uint16_t gWaveformCounts[2] = {0, 0};
+
 Timer1PWM::Timer1PWM() {}
 
 bool Timer1PWM::begin(const Config& config) {
@@ -10,6 +13,216 @@ bool Timer1PWM::begin(float freqHz) {
   return freqHz > 0.0f && freqHz < 1000000.0f;
 }
 
+bool Timer1PWM::beginMilliHz(uint32_t freqMilliHz, Preference preference) {
+  if (freqMilliHz >= 1000000000UL) return false;
+  return begin(timingForMilliHz(freqMilliHz, preference));
+}
+
+bool Timer1PWM::begin(const Timing& timing) {
+  if (!timing.isValid()) return false;
+  _stagePhase = 0;
+  _stepping = false;
+  _stepMode = false;
+  _waveformActive = false;
+  _sweepActive = false;
+  _complementary = false;
+  _deadTimeCounts = 0;
+  _squareWave = false;
+  _top = timing.top;
+  _presBits = timing.clockSelect;
+  _configured = true;
+  return true;
+}
+
+bool Timer1PWM::beginComplementary(const Timing& timing, uint16_t deadTimeCounts) {
+  if (!timing.isValid() || deadTimeCounts >= timing.top) return false;
+  _stagePhase = 0;
+  _stepping = false;
+  _stepMode = false;
+  _waveformActive = false;
+  _sweepActive = false;
+  _squareWave = false;
+  _complementary = true;
+  _deadTimeCounts = deadTimeCounts;
+  _top = timing.top;
+  _presBits = timing.clockSelect;
+  _configured = true;
+  return true;
+}
+
+bool Timer1PWM::isComplementary() const {
+  return _complementary;
+}
+
+uint16_t Timer1PWM::getDeadTimeCounts() const {
+  return _deadTimeCounts;
+}
+
+bool Timer1PWM::beginSquareWave(const Timing& timing) {
+  if (!timing.isValid()) return false;
+  _stagePhase = 0;
+  _stepping = false;
+  _stepMode = false;
+  _waveformActive = false;
+  _sweepActive = false;
+  _complementary = false;
+  _deadTimeCounts = 0;
+  _squareWave = true;
+  _top = timing.top;
+  _presBits = timing.clockSelect;
+  _configured = true;
+  return true;
+}
+
+bool Timer1PWM::startSweep(const FrequencySweep::Config& config) {
+  _sweepActive = false;
+  if (!_sweep.begin(config, CLOCK_HZ, MIN_SWEEP_HALF_PERIOD_CLOCKS)) return false;
+  const FrequencySweep::Step& first = _sweep.current();
+  if (!beginSquareWave(Timing(first.top, first.clockSelect))) return false;
+  // No compare interrupt natively: the sweep holds its start frequency.
+  _sweepActive = true;
+  return true;
+}
+
+void Timer1PWM::stopSweep() {
+  _sweepActive = false;
+}
+
+bool Timer1PWM::isSweepActive() const {
+  return _sweepActive;
+}
+
+bool Timer1PWM::startSteps(const StepRamp::Config& config, bool) {
+  _stepping = false;
+  if (!_stepRamp.begin(config, CLOCK_HZ, MIN_STEP_PERIOD_CLOCKS)) return false;
+  _stagePhase = 0;
+  _waveformActive = false;
+  _sweepActive = false;
+  _complementary = false;
+  _deadTimeCounts = 0;
+  _squareWave = false;
+  _top = 0;
+  _presBits = 0;
+  _configured = false;
+  // No overflow interrupt natively: the move never completes a pulse.
+  _stepMode = true;
+  _stepsDone = 0;
+  _stepping = true;
+  return true;
+}
+
+void Timer1PWM::stopSteps() {
+  _stepping = false;
+}
+
+bool Timer1PWM::isStepping() const {
+  return _stepping;
+}
+
+uint32_t Timer1PWM::getStepsDone() const {
+  return _stepsDone;
+}
+
+bool Timer1PWM::isSquareWave() const {
+  return _squareWave;
+}
+
+uint32_t Timer1PWM::getSquareWaveFrequencyMilliHz() const {
+  return _squareWave ? squareWaveFrequencyMilliHz(getTiming()) : 0;
+}
+
 void Timer1PWM::setDuty(uint8_t, float) {}
 
-void Timer1PWM::stop() {}
\ No newline at end of file
+void Timer1PWM::setDutyPermille(uint8_t, uint16_t) {}
+
+void Timer1PWM::setDutyCounts(uint8_t, uint16_t) {}
+
+bool Timer1PWM::writeDutyPermilleFromIsr(uint8_t channel, uint16_t) {
+  return channel <= 1 && _configured && !_waveformActive && !_squareWave &&
+         !(_complementary && channel == 1);
+}
+
+uint16_t Timer1PWM::getTop() const {
+  return _top;
+}
+
+Timer1PWM::Timing Timer1PWM::getTiming() const {
+  if (!_configured) return Timing();
+  return Timing(_top, static_cast<uint8_t>(_presBits));
+}
+
+bool Timer1PWM::stageUpdate(const Timing& timing, uint16_t, uint16_t) {
+  return stageTiming(timing);
+}
+
+bool Timer1PWM::stageTiming(const Timing& timing) {
+  if (!_configured || _waveformActive || _complementary || _squareWave || !timing.isValid()) {
+    return false;
+  }
+  if (timing.periodClocks() < MIN_STAGED_PERIOD_CLOCKS) return false;
+  if (getTiming().periodClocks() < MIN_STAGED_PERIOD_CLOCKS) return false;
+  // Held until a test calls handleOverflow() twice, standing in for the two overflow ISR
+  // passes. The register sequence itself runs in test_timer1_staged_commit.cpp.
+  _stagedTop = timing.top;
+  _stagedClockSelect = timing.clockSelect;
+  _stagePhase = 1;
+  _activeInstance = this;
+  return true;
+}
+
+bool Timer1PWM::isUpdatePending() const {
+  return _stagePhase != 0;
+}
+
+void Timer1PWM::handleOverflow() {
+  Timer1PWM* pwm = _activeInstance;
+  if (pwm != nullptr && pwm->_waveformActive) {
+    pwm->_waveform.step(gWaveformCounts[0], gWaveformCounts[1]);
+    return;
+  }
+  if (pwm == nullptr || pwm->_stagePhase == 0) return;
+  if (pwm->_stagePhase == 1) {
+    pwm->_stagePhase = 2;
+    return;
+  }
+  pwm->_top = pwm->_stagedTop;
+  pwm->_presBits = pwm->_stagedClockSelect;
+  pwm->_stagePhase = 0;
+}
+
+bool Timer1PWM::startWaveform(const WaveformSynth::Config& config) {
+  Timing timing = getTiming();
+  if (_complementary || _squareWave || timing.periodClocks() < MIN_WAVEFORM_PERIOD_CLOCKS) {
+    return false;
+  }
+  _stagePhase = 0;
+  _waveformActive = _waveform.begin(config, timing.top, timing.frequencyMilliHz());
+  _activeInstance = this;
+  return _waveformActive;
+}
+
+void Timer1PWM::stopWaveform() {
+  _waveformActive = false;
+}
+
+bool Timer1PWM::isWaveformActive() const {
+  return _waveformActive;
+}
+
+uint32_t Timer1PWM::getWaveformFrequencyMilliHz() const {
+  return _waveformActive ? _waveform.getFrequencyMilliHz() : 0;
+}
+
+void Timer1PWM::stop() {
+  _stagePhase = 0;
+  _stepping = false;
+  _stepMode = false;
+  _waveformActive = false;
+  _sweepActive = false;
+  _squareWave = false;
+  _complementary = false;
+  _deadTimeCounts = 0;
+  _top = 0;
+  _presBits = 0;
+  _configured = false;
+}
@@ -2,11 +2,14 @@
 
 import argparse
 import json
+import struct
 import sys
 import time
 
 import serial
 
+RECORD_ALL = 4
+
 
 def parse_args() -> argparse.Namespace:
     parser = argparse.ArgumentParser(
@@ -34,6 +37,11 @@ def parse_args() -> argparse.Namespace:
         default=1.0,
         help="Serial read timeout in seconds (default: 1.0)",
     )
+    parser.add_argument(
+        "--binary",
+        action="store_true",
+        help="Switch the firmware to binary frames (format bin) and decode them.",
+    )
     parser.add_argument(
         "--pretty",
         action="store_true",
@@ -49,6 +57,81 @@ def read_response(ser: serial.Serial) -> str:
     return line.decode("utf-8", errors="replace").strip()
 
 
+def crc16(data: bytes) -> int:
+    """CRC-16/MCRF4XX, as computed by the firmware's FrameEncoder."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8408 if crc & 1 else crc >> 1
+    return crc
+
+
+def cobs_decode(data: bytes) -> bytes:
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        if code == 0 or pos + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[pos + 1 : pos + code]
+        pos += code
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def read_frame(ser: serial.Serial) -> bytes:
+    """Returns the next valid record (type, sequence, payload), or b"" on timeout.
+
+    Text lines (such as unsolicited events) arrive between frames, in chunks of their own, and
+    are skipped when they fail to decode or to match the CRC. A newline byte proves nothing:
+    COBS removes only zeros, so 0x0A can appear anywhere inside a valid frame.
+    """
+    while True:
+        chunk = ser.read_until(b"\x00")
+        if not chunk.endswith(b"\x00"):
+            return b""
+        chunk = chunk[:-1]
+        if not chunk:
+            continue
+        try:
+            record = cobs_decode(chunk)
+        except ValueError:
+            continue
+        if len(record) < 4:
+            continue
+        (sent_crc,) = struct.unpack_from("<H", record, len(record) - 2)
+        if crc16(record[:-2]) != sent_crc:
+            continue
+        return record[:-2]
+
+
+def decode_all_record(record: bytes) -> dict:
+    payload = record[2:]
+    analog_round, analog_count = struct.unpack_from("<IB", payload, 0)
+    millivolts = struct.unpack_from(f"<{analog_count}H", payload, 5)
+    pos = 5 + 2 * analog_count
+    digital_count, frame_seq, flags, overruns = struct.unpack_from("<BIBI", payload, pos)
+    pos += 10
+    digital = []
+    for _ in range(digital_count):
+        freq_mhz, duty_permille = struct.unpack_from("<IH", payload, pos)
+        digital.append({"freq": freq_mhz / 1000.0, "duty": duty_permille / 10.0})
+        pos += 6
+    direction, position = struct.unpack_from("<Bi", payload, pos)
+    return {
+        "seq": record[1],
+        "analogRound": analog_round,
+        "analog": [mv / 1000.0 for mv in millivolts],
+        "frameSeq": frame_seq,
+        "stale": bool(flags & 1),
+        "overrunTicks": overruns,
+        "digital": digital,
+        "encoder": {"direction": "UP" if direction & 1 else "DOWN", "position": position},
+    }
+
+
 def main() -> int:
     args = parse_args()
 
@@ -56,6 +139,10 @@ def main() -> int:
         with serial.Serial(args.port, args.baud, timeout=args.timeout) as ser:
             ser.reset_input_buffer()
             ser.reset_output_buffer()
+            if args.binary:
+                ser.write(b"format bin\n")
+                ser.flush()
+                read_response(ser)
 
             print(
                 f"Polling {args.port} at {args.baud} baud every {args.interval:.3f} s. Press Ctrl+C to stop.",
@@ -71,18 +158,25 @@ def main() -> int:
 
                 ser.write(b"all?\n")
                 ser.flush()
-                response = read_response(ser)
                 timestamp = time.strftime("%Y-%m-%d %H:%M:%S")
 
-                if not response:
-                    print(f"[{timestamp}] timeout waiting for response", flush=True)
-                    continue
-
-                try:
-                    payload = json.loads(response)
-                except json.JSONDecodeError:
-                    print(f"[{timestamp}] {response}", flush=True)
-                    continue
+                if args.binary:
+                    record = read_frame(ser)
+                    if not record or record[0] != RECORD_ALL:
+                        print(f"[{timestamp}] timeout waiting for frame", flush=True)
+                        continue
+                    payload = decode_all_record(record)
+                else:
+                    response = read_response(ser)
+                    if not response:
+                        print(f"[{timestamp}] timeout waiting for response", flush=True)
+                        continue
+
+                    try:
+                        payload = json.loads(response)
+                    except json.JSONDecodeError:
+                        print(f"[{timestamp}] {response}", flush=True)
+                        continue
 
                 if args.pretty:
                     print(f"[{timestamp}]", flush=True)